@@ -0,0 +1,139 @@
+// Email: nitzanwa@gmail.com
+
+#include "BenchHarness.hpp"
+
+#include <iomanip>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace coup {
+namespace bench {
+
+    std::uint64_t allocationCount() {
+        return AllocationTracker::current().allocations;
+    }
+
+    std::uint64_t allocatedBytes() {
+        return AllocationTracker::current().bytes;
+    }
+
+    long peakRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+#ifdef __linux__
+    InstructionCounter::InstructionCounter() : fd(-1) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    InstructionCounter::~InstructionCounter() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    std::uint64_t InstructionCounter::read() const {
+        std::uint64_t value = 0;
+        if (fd >= 0 && ::read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) {
+            value = 0;
+        }
+        return value;
+    }
+#else
+    InstructionCounter::InstructionCounter() : fd(-1) {}
+    InstructionCounter::~InstructionCounter() {}
+    std::uint64_t InstructionCounter::read() const { return 0; }
+#endif
+
+    BenchRunner::BenchRunner(long iterations, const std::string &filter)
+        : iterations(iterations), filter(filter), overheadNs(0), overheadInstructions(0) {
+        // Calibrate the cost of the measurement itself on an empty operation
+        BenchResult empty = measure("calibration", [] {}, [] {});
+        overheadNs = empty.nsPerOp;
+        overheadInstructions = empty.instructionsPerOp;
+    }
+
+    void BenchRunner::printTable(std::ostream &out) const {
+        out << std::left << std::setw(36) << "benchmark"
+            << std::right << std::setw(12) << "ns/op"
+            << std::setw(12) << "allocs/op"
+            << std::setw(12) << "bytes/op"
+            << std::setw(14) << "instr/op" << "\n";
+        out << std::fixed << std::setprecision(1);
+        for (const BenchResult &r : results) {
+            out << std::left << std::setw(36) << r.name
+                << std::right << std::setw(12) << r.nsPerOp;
+            if (r.hasAllocations) {
+                out << std::setw(12) << r.allocsPerOp << std::setw(12) << r.bytesPerOp;
+            } else {
+                out << std::setw(12) << "n/a" << std::setw(12) << "n/a";
+            }
+            if (r.hasInstructions) {
+                out << std::setw(14) << r.instructionsPerOp;
+            } else {
+                out << std::setw(14) << "n/a";
+            }
+            out << "\n";
+        }
+        out.unsetf(std::ios::floatfield);
+        out << std::flush;
+    }
+
+    void BenchRunner::writeJson(std::ostream &out) const {
+        out << "{\n  \"iterations\": " << iterations << ",\n  \"benchmarks\": [\n";
+        out << std::fixed << std::setprecision(2);
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const BenchResult &r = results[i];
+            out << "    {\"name\": \"" << r.name << "\""
+                << ", \"ns_per_op\": " << r.nsPerOp
+                << ", \"allocs_per_op\": ";
+            if (r.hasAllocations) {
+                out << r.allocsPerOp << ", \"bytes_per_op\": " << r.bytesPerOp;
+            } else {
+                out << "null, \"bytes_per_op\": null";
+            }
+            out << ", \"instructions_per_op\": ";
+            if (r.hasInstructions) {
+                out << r.instructionsPerOp;
+            } else {
+                out << "null";
+            }
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+}
+}
@@ -0,0 +1,160 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include "../GameLogic/AllocationTracker.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace coup {
+namespace bench {
+
+    /**
+     * @struct BenchResult
+     * @brief Per-operation cost of one microbenchmark
+     */
+    struct BenchResult {
+        std::string name;             ///< Benchmark name
+        long iterations;              ///< Number of measured operations
+        double nsPerOp;               ///< Mean wall time per operation
+        double allocsPerOp;           ///< Mean heap allocations per operation
+        double bytesPerOp;            ///< Mean bytes allocated per operation
+        double instructionsPerOp;     ///< Mean retired user instructions per operation
+        bool hasAllocations;          ///< Whether allocations were counted (TRACK_ALLOCS=1)
+        bool hasInstructions;         ///< Whether the instruction counter was available
+    };
+
+    /**
+     * @brief Heap allocations made by this thread so far (0 unless tracking is built in)
+     */
+    std::uint64_t allocationCount();
+
+    /**
+     * @brief Bytes requested from the heap by this thread so far
+     */
+    std::uint64_t allocatedBytes();
+
+    /**
+     * @brief Peak resident set size of this process
+     * @return Peak RSS in kilobytes, or 0 if unavailable
+     */
+    long peakRssKb();
+
+    /**
+     * @class InstructionCounter
+     * @brief Retired user-space instruction counter (Linux perf events)
+     *
+     * Silently unavailable when the platform or permissions do not allow it.
+     */
+    class InstructionCounter {
+    private:
+        int fd;  ///< perf event descriptor, or -1
+
+    public:
+        InstructionCounter();
+        ~InstructionCounter();
+        InstructionCounter(const InstructionCounter &other) = delete;
+        InstructionCounter &operator=(const InstructionCounter &other) = delete;
+
+        bool available() const { return fd >= 0; }
+        std::uint64_t read() const;
+    };
+
+    /**
+     * @class BenchRunner
+     * @brief Runs microbenchmarks and reports ns, allocations and instructions per op
+     *
+     * Each iteration calls setup() untimed, then measures a single op().
+     * Clock and counter overhead is calibrated once and subtracted.
+     */
+    class BenchRunner {
+    private:
+        long iterations;                  ///< Measured operations per benchmark
+        std::string filter;               ///< Only run names containing this
+        InstructionCounter instructions;  ///< Shared instruction counter
+        std::vector<BenchResult> results; ///< Collected results
+        double overheadNs;                ///< Calibrated timing overhead per op
+        double overheadInstructions;      ///< Calibrated counter overhead per op
+
+        template <typename Setup, typename Op>
+        BenchResult measure(const std::string &name, Setup &&setup, Op &&op) {
+            using Clock = std::chrono::steady_clock;
+            double totalNs = 0;
+            std::uint64_t totalInstructions = 0;
+            std::uint64_t allocs = 0;
+            std::uint64_t bytes = 0;
+
+            for (long i = 0; i < iterations; ++i) {
+                setup();
+                std::uint64_t allocsBefore = allocationCount();
+                std::uint64_t bytesBefore = allocatedBytes();
+                std::uint64_t instrBefore = instructions.read();
+                Clock::time_point start = Clock::now();
+                op();
+                Clock::time_point end = Clock::now();
+                std::uint64_t instrAfter = instructions.read();
+                allocs += allocationCount() - allocsBefore;
+                bytes += allocatedBytes() - bytesBefore;
+                totalInstructions += instrAfter - instrBefore;
+                totalNs += std::chrono::duration<double, std::nano>(end - start).count();
+            }
+
+            BenchResult result;
+            result.name = name;
+            result.iterations = iterations;
+            result.nsPerOp = totalNs / iterations - overheadNs;
+            result.allocsPerOp = static_cast<double>(allocs) / iterations;
+            result.bytesPerOp = static_cast<double>(bytes) / iterations;
+            result.hasAllocations = AllocationTracker::isEnabled();
+            result.hasInstructions = instructions.available();
+            result.instructionsPerOp = result.hasInstructions
+                ? static_cast<double>(totalInstructions) / iterations - overheadInstructions : 0;
+            return result;
+        }
+
+    public:
+        /**
+         * @brief Constructor
+         * @param iterations Measured operations per benchmark
+         * @param filter Substring a benchmark name must contain to run (empty = all)
+         */
+        BenchRunner(long iterations, const std::string &filter);
+
+        /**
+         * @brief Run one benchmark
+         * @param name Benchmark name
+         * @param setup Untimed per-iteration fixture preparation
+         * @param op Operation under test
+         */
+        template <typename Setup, typename Op>
+        void run(const std::string &name, Setup &&setup, Op &&op) {
+            if (!filter.empty() && name.find(filter) == std::string::npos) {
+                return;
+            }
+            results.push_back(measure(name, setup, op));
+        }
+
+        const std::vector<BenchResult> &getResults() const { return results; }
+
+        /**
+         * @brief Print a human-readable table
+         * @param out Destination stream
+         */
+        void printTable(std::ostream &out) const;
+
+        /**
+         * @brief Write results as JSON
+         * @param out Destination stream
+         */
+        void writeJson(std::ostream &out) const;
+    };
+
+}
+}
+
+#endif // BENCH_HARNESS_HPP
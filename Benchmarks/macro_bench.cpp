@@ -0,0 +1,177 @@
+// Email: nitzanwa@gmail.com
+
+#include "BenchHarness.hpp"
+#include "../GameLogic/Logger.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace coup;
+using namespace coup::bench;
+
+namespace {
+
+    /**
+     * Totals for one pass over the fixed game set
+     */
+    struct MacroResult {
+        long games = 0;
+        long finished = 0;
+        long turns = 0;
+        double seconds = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    /**
+     * Plays the fixed workload: per-game seeds derived from one seed, table
+     * sizes cycling 2-6 and the simulator's fixed seat style mix.
+     */
+    MacroResult runPass(long games, std::uint64_t seed) {
+        MacroResult result;
+        result.games = games;
+        std::uint64_t allocsBefore = allocationCount();
+        std::uint64_t bytesBefore = allocatedBytes();
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < games; ++i) {
+            std::size_t tableSize = 2 + static_cast<std::size_t>(i % 5);
+            GameResult game = Simulator::runGame(Rng::forStream(seed, static_cast<std::uint64_t>(i)).getSeed(), tableSize);
+            result.turns += game.turns;
+            if (game.finished) {
+                ++result.finished;
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.allocations = allocationCount() - allocsBefore;
+        result.bytes = allocatedBytes() - bytesBefore;
+        return result;
+    }
+
+    void writeJson(std::ostream &out, const MacroResult &r, std::uint64_t seed, long repeats) {
+        out << std::fixed << std::setprecision(2)
+            << "{\n"
+            << "  \"games\": " << r.games << ",\n"
+            << "  \"seed\": " << seed << ",\n"
+            << "  \"repeats\": " << repeats << ",\n"
+            << "  \"finished\": " << r.finished << ",\n"
+            << "  \"turns\": " << r.turns << ",\n"
+            << "  \"seconds\": " << r.seconds << ",\n"
+            << "  \"games_per_second\": " << r.games / r.seconds << ",\n"
+            << "  \"turns_per_second\": " << r.turns / r.seconds << ",\n"
+            << "  \"allocations\": ";
+        if (AllocationTracker::isEnabled()) {
+            out << r.allocations << ",\n"
+                << "  \"allocations_per_game\": " << static_cast<double>(r.allocations) / r.games << ",\n"
+                << "  \"bytes_allocated\": " << r.bytes << ",\n";
+        } else {
+            out << "null,\n  \"allocations_per_game\": null,\n  \"bytes_allocated\": null,\n";
+        }
+        out << "  \"peak_rss_kb\": " << peakRssKb() << "\n"
+            << "}\n";
+    }
+
+    /**
+     * Reads a numeric field from a results file written by writeJson
+     * @throws std::runtime_error if the file or the field is missing
+     */
+    double readJsonNumber(const std::string &path, const std::string &key) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot read baseline " + path);
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        std::string text = buffer.str();
+        std::string::size_type pos = text.find("\"" + key + "\":");
+        if (pos == std::string::npos) {
+            throw std::runtime_error("Baseline " + path + " has no " + key);
+        }
+        return std::strtod(text.c_str() + pos + key.size() + 3, nullptr);
+    }
+
+}
+
+// Usage: coup_macro_bench [--games N] [--seed S] [--repeats R] [--json PATH]
+//                         [--baseline PATH] [--threshold PERCENT]
+// Exit status 1 means games/s fell more than PERCENT below the baseline.
+int main(int argc, char *argv[]) {
+    long games = 5000;
+    std::uint64_t seed = 1;
+    long repeats = 3;
+    double threshold = 10.0;
+    std::string jsonPath;
+    std::string baselinePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            games = std::atol(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::atol(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else {
+            games = 0;
+            break;
+        }
+    }
+    if (games <= 0 || repeats <= 0 || threshold < 0) {
+        std::cerr << "Usage: " << argv[0] << " [--games N > 0] [--seed S] [--repeats R > 0] [--json PATH]"
+                  << " [--baseline PATH] [--threshold PERCENT]" << std::endl;
+        return 2;
+    }
+
+    Logger::setEnabled(false);
+
+    // Every pass plays the same games; keep the fastest to damp scheduler noise
+    MacroResult best;
+    for (long r = 0; r < repeats; ++r) {
+        MacroResult pass = runPass(games, seed);
+        if (r == 0 || pass.seconds < best.seconds) {
+            best = pass;
+        }
+    }
+
+    writeJson(std::cout, best, seed, repeats);
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << std::endl;
+            return 2;
+        }
+        writeJson(out, best, seed, repeats);
+        std::cout << "Results written to " << jsonPath << std::endl;
+    }
+
+    if (!baselinePath.empty()) {
+        double baseline;
+        try {
+            baseline = readJsonNumber(baselinePath, "games_per_second");
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+        double current = best.games / best.seconds;
+        double change = (current - baseline) / baseline * 100.0;
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Baseline " << baseline << " games/s, current " << current
+                  << " games/s (" << std::showpos << change << std::noshowpos << "%)" << std::endl;
+        if (-change > threshold) {
+            std::cerr << "Throughput regression beyond " << threshold << "% threshold" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
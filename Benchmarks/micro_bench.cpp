@@ -0,0 +1,246 @@
+// Email: nitzanwa@gmail.com
+
+#include "BenchHarness.hpp"
+#include "../GameLogic/Game.hpp"
+#include "../GameLogic/BankManager.hpp"
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/PlayerFactory.hpp"
+#include "../GameLogic/Replay.hpp"
+#include "../GameLogic/Snapshot.hpp"
+#include "../Players/DecisionPolicy.hpp"
+#include "../Players/Roles/Baron.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace coup;
+using namespace coup::bench;
+
+namespace {
+
+    const std::uint64_t BENCH_SEED = 42;
+    const std::uint64_t CAPPED_GAME_SEED = 488;  // a six-player game that runs into the 500-turn cap
+
+    struct AlwaysBlock {
+        bool shouldBribe(Player &) { return false; }
+        bool shouldBlock(Player &, ActionType, Player *, Player *) { return true; }
+    };
+
+    StaticPolicy<AlwaysBlock> alwaysBlock;
+
+    /**
+     * Fresh game per iteration; seat 0 holds the turn.
+     */
+    struct Table {
+        std::unique_ptr<Game> game;
+        Game::PlayerList seats;
+
+        void reset(const std::vector<Role> &roles) {
+            static const std::vector<std::string> NAMES = {"P1", "P2", "P3", "P4", "P5", "P6"};
+            game.reset();
+            game.reset(new Game(BENCH_SEED));
+            seats = game->setup(std::vector<std::string>(NAMES.begin(), NAMES.begin() + roles.size()), roles);
+            game->setConsoleMode(false);
+            game->setBankCoins(200);
+        }
+
+        Player &seat(std::size_t i) { return *seats[i]; }
+    };
+
+    void runActions(BenchRunner &runner, Table &t) {
+        runner.run("action/gather",
+            [&] { t.reset({Role::Spy, Role::Baron}); },
+            [&] { t.seat(0).gather(); });
+
+        runner.run("action/tax",
+            [&] { t.reset({Role::Spy, Role::Baron}); },
+            [&] { t.seat(0).tax(); });
+
+        runner.run("action/tax_governor_declines",
+            [&] { t.reset({Role::Spy, Role::Governor}); },
+            [&] { t.seat(0).tax(); });
+
+        runner.run("action/bribe",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).gather(); t.seat(0).setCoins(4); },
+            [&] { t.seat(0).bribe(); });
+
+        runner.run("action/arrest",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).setCoins(1); t.seat(1).setCoins(2); },
+            [&] { t.seat(0).arrest(t.seat(1)); });
+
+        runner.run("action/sanction",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).setCoins(3); },
+            [&] { t.seat(0).sanction(t.seat(1)); });
+
+        runner.run("action/coup",
+            [&] { t.reset({Role::Spy, Role::Baron, Role::Merchant}); t.seat(0).setCoins(7); },
+            [&] { t.seat(0).coup(t.seat(1)); });
+
+        runner.run("action/baron_invest",
+            [&] { t.reset({Role::Baron, Role::Spy}); t.seat(0).setCoins(3); },
+            [&] { static_cast<Baron &>(t.seat(0)).invest(); });
+    }
+
+    void runBlocking(BenchRunner &runner, Table &t) {
+        runner.run("block/check_no_blocker",
+            [&] { t.reset({Role::Spy, Role::Baron, Role::Merchant, Role::General}); },
+            [&] { t.game->checkForBlocking(&t.seat(0), ActionType::Tax); });
+
+        runner.run("block/check_governor_tax",
+            [&] { t.reset({Role::Spy, Role::Governor}); t.seat(0).setCoins(2); t.seat(1).setDecisionPolicy(&alwaysBlock); },
+            [&] { t.game->checkForBlocking(&t.seat(0), ActionType::Tax); });
+
+        runner.run("block/check_judge_bribe",
+            [&] { t.reset({Role::Spy, Role::Judge}); t.seat(1).setDecisionPolicy(&alwaysBlock); },
+            [&] { t.game->checkForBlocking(&t.seat(0), ActionType::Bribe); });
+
+        runner.run("block/check_general_coup",
+            [&] { t.reset({Role::Spy, Role::General, Role::Baron}); t.seat(1).setCoins(5); t.seat(1).setDecisionPolicy(&alwaysBlock); },
+            [&] { t.game->checkForBlocking(&t.seat(0), ActionType::Coup, &t.seat(2)); });
+
+        runner.run("block/execute_governor_tax",
+            [&] { t.reset({Role::Spy, Role::Governor}); t.seat(0).setCoins(2); },
+            [&] { t.game->executeBlock(&t.seat(1), ActionType::Tax, &t.seat(0), nullptr); });
+
+        runner.run("block/execute_judge_bribe",
+            [&] { t.reset({Role::Spy, Role::Judge}); },
+            [&] { t.game->executeBlock(&t.seat(1), ActionType::Bribe, &t.seat(0), nullptr); });
+
+        runner.run("block/execute_general_coup",
+            [&] { t.reset({Role::Spy, Role::General, Role::Baron}); t.seat(1).setCoins(5); },
+            [&] { t.game->executeBlock(&t.seat(1), ActionType::Coup, &t.seat(0), &t.seat(2)); });
+    }
+
+    void runTurns(BenchRunner &runner, Table &t) {
+        runner.run("turn/start",
+            [&] { t.reset({Role::Spy, Role::Baron}); },
+            [&] { t.seat(0).startTurn(); });
+
+        runner.run("turn/start_merchant_bonus",
+            [&] { t.reset({Role::Merchant, Role::Baron}); t.seat(0).setCoins(3); },
+            [&] { t.seat(0).startTurn(); });
+
+        runner.run("turn/end",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).gather(); },
+            [&] { t.seat(0).endTurn(); });
+    }
+
+    void runBank(BenchRunner &runner, Table &t) {
+        runner.run("bank/transfer_from_bank",
+            [&] { t.reset({Role::Spy, Role::Baron}); },
+            [&] { BankManager::transferFromBank(t.seat(0), *t.game, 1); });
+
+        runner.run("bank/transfer_to_bank",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).setCoins(1); },
+            [&] { BankManager::transferToBank(t.seat(0), *t.game, 1); });
+
+        runner.run("bank/transfer_coins",
+            [&] { t.reset({Role::Spy, Role::Baron}); t.seat(0).setCoins(1); },
+            [&] { BankManager::transferCoins(t.seat(0), t.seat(1), 1); });
+    }
+
+    void runSnapshots(BenchRunner &runner, Table &t) {
+        const std::vector<Role> six = {Role::Governor, Role::Spy, Role::Baron, Role::General, Role::Judge,
+                                       Role::Merchant};
+        GameSnapshot saved;
+        runner.run("snapshot/save",
+            [&] { t.reset(six); },
+            [&] { t.game->saveSnapshot(saved); });
+
+        runner.run("snapshot/load",
+            [&] { t.reset(six); t.game->saveSnapshot(saved); },
+            [&] { t.game->loadSnapshot(saved); });
+
+        // What a reader of a mapped file does per position: no parsing, no allocation
+        std::vector<GameSnapshot> positions(1000, saved);
+        volatile long total = 0;
+        runner.run("snapshot/scan_1000",
+            [&] { total = 0; },
+            [&] {
+                long coins = 0;
+                for (const GameSnapshot &position : positions) {
+                    for (std::size_t seat = 0; seat < position.playerCount; ++seat) {
+                        coins += position.players[seat].coins;
+                    }
+                }
+                total = coins;
+            });
+    }
+
+    void runReplay(BenchRunner &runner) {
+        GameRecording recording;
+        Simulator::runGame(CAPPED_GAME_SEED, 6, Simulator::DEFAULT_MAX_TURNS, nullptr, &recording);
+        ReplayEngine engine(recording);
+
+        // Dragging a timeline: every frame seeks somewhere else in the game
+        Rng rng(BENCH_SEED);
+        std::size_t target = 0;
+        runner.run("replay/seek_500_turns",
+            [&] { target = static_cast<std::size_t>(rng.uniform(engine.size() + 1)); },
+            [&] { engine.seek(target); });
+
+        runner.run("replay/step_forward",
+            [&] { engine.seek(static_cast<std::size_t>(rng.uniform(engine.size()))); },
+            [&] { engine.seek(engine.position() + 1); });
+    }
+
+}
+
+// Usage: coup_bench [--iterations N] [--filter SUBSTRING] [--json PATH]
+int main(int argc, char *argv[]) {
+    long iterations = 20000;
+    std::string filter;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::atol(argv[++i]);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            iterations = 0;
+            break;
+        }
+    }
+    if (iterations <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--iterations N > 0] [--filter SUBSTRING] [--json PATH]" << std::endl;
+        return 1;
+    }
+
+    Logger::setEnabled(false);
+
+    BenchRunner runner(iterations, filter);
+    Table table;
+    try {
+        runActions(runner, table);
+        runBlocking(runner, table);
+        runTurns(runner, table);
+        runBank(runner, table);
+        runSnapshots(runner, table);
+        runReplay(runner);
+    } catch (const std::exception &e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    runner.printTable(std::cout);
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonPath << std::endl;
+            return 1;
+        }
+        runner.writeJson(out);
+        std::cout << "Results written to " << jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Email: nitzanwa@gmail.com
+
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/OutcomeFile.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace coup;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::uint64_t fileSize(const std::string &path) {
+        struct stat info{};
+        return ::stat(path.c_str(), &info) == 0 ? static_cast<std::uint64_t>(info.st_size) : 0;
+    }
+
+    /**
+     * The same fields as one CSV line; list columns are ';'-separated
+     */
+    void writeCsvRow(std::ostream &out, const GameOutcome &outcome) {
+        out << outcome.seed << ',' << static_cast<int>(outcome.playerCount) << ',';
+        for (std::size_t seat = 0; seat < outcome.playerCount; ++seat) {
+            out << (seat ? ";" : "") << static_cast<int>(outcome.roles[seat]);
+        }
+        out << ',' << outcome.winnerSeat << ',' << outcome.turns << ',';
+        for (std::size_t i = 0; i < outcome.coins.size(); ++i) {
+            out << (i ? ";" : "") << outcome.coins[i];
+        }
+        out << ',';
+        for (std::size_t i = 0; i < outcome.playerCount * OUTCOME_ACTION_COUNT; ++i) {
+            out << (i ? ";" : "") << outcome.actions[i];
+        }
+        out << '\n';
+    }
+
+    bool sameOutcome(const GameOutcome &a, const GameOutcome &b) {
+        return a.seed == b.seed && a.playerCount == b.playerCount && a.roles == b.roles &&
+               a.winnerSeat == b.winnerSeat && a.turns == b.turns && a.coins == b.coins && a.actions == b.actions;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    long games = 20000;
+    std::uint64_t seed = 1;
+    long groupRows = static_cast<long>(OUTCOME_DEFAULT_GROUP_ROWS);
+    std::string path = "/tmp/coup_outcomes_" + std::to_string(::getpid());
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--games" && i + 1 < argc) {
+            games = std::atol(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--group-rows" && i + 1 < argc) {
+            groupRows = std::atol(argv[++i]);
+        } else {
+            games = 0;
+            break;
+        }
+    }
+    if (games <= 0 || groupRows <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--games G > 0] [--seed S] [--group-rows R > 0]" << std::endl;
+        return 2;
+    }
+
+    // Play the games first, so the timings below measure only the export
+    Logger::setEnabled(false);
+    std::vector<GameOutcome> outcomes(static_cast<std::size_t>(games));
+    for (long i = 0; i < games; ++i) {
+        Simulator::runGame(Rng::forStream(seed, static_cast<std::uint64_t>(i)).getSeed(),
+                           2 + static_cast<std::size_t>(i % 5), Simulator::DEFAULT_MAX_TURNS, nullptr, nullptr,
+                           nullptr, &outcomes[static_cast<std::size_t>(i)]);
+    }
+
+    std::string columnar = path + ".out";
+    std::string csv = path + ".csv";
+    Clock::time_point start = Clock::now();
+    {
+        OutcomeWriter writer(columnar, static_cast<std::size_t>(groupRows));
+        for (const GameOutcome &outcome : outcomes) {
+            writer.append(outcome);
+        }
+        writer.close();
+    }
+    double columnarWrite = secondsSince(start);
+
+    start = Clock::now();
+    {
+        std::ofstream out(csv);
+        out << "seed,player_count,roles,winner,turns,coins,actions\n";
+        for (const GameOutcome &outcome : outcomes) {
+            writeCsvRow(out, outcome);
+        }
+    }
+    double csvWrite = secondsSince(start);
+
+    // Full decode, checked against what was written
+    std::uint64_t mismatches = 0;
+    OutcomeFile file(columnar);
+    OutcomeBatch batch;
+    std::size_t next = 0;
+    start = Clock::now();
+    for (std::size_t g = 0; g < file.groupCount(); ++g) {
+        file.readGroup(g, batch);
+        for (std::size_t i = 0; i < batch.rows; ++i, ++next) {
+            mismatches += next >= outcomes.size() || !sameOutcome(batch.row(i), outcomes[next]);
+        }
+    }
+    double columnarRead = secondsSince(start);
+    mismatches += next != outcomes.size();
+
+    // Projection: wins by role needs two of the seven columns
+    std::uint64_t columnarWins[ROLE_COUNT] = {};
+    start = Clock::now();
+    for (std::size_t g = 0; g < file.groupCount(); ++g) {
+        file.readGroup(g, batch, outcomeColumnBit(OutcomeColumn::Roles) | outcomeColumnBit(OutcomeColumn::Winner));
+        for (std::size_t i = 0; i < batch.rows; ++i) {
+            if (batch.winners[i] >= 0) {
+                ++columnarWins[static_cast<int>(batch.roles[i * Game::MAX_PLAYERS + batch.winners[i]])];
+            }
+        }
+    }
+    double columnarProject = secondsSince(start);
+
+    // The same query over CSV has to read and split every line
+    std::uint64_t csvWins[ROLE_COUNT] = {};
+    start = Clock::now();
+    {
+        std::ifstream in(csv);
+        std::string line;
+        std::getline(in, line);
+        std::vector<std::string> fields;
+        while (std::getline(in, line)) {
+            fields.clear();
+            std::istringstream cells(line);
+            std::string cell;
+            while (std::getline(cells, cell, ',')) {
+                fields.push_back(cell);
+            }
+            int winner = std::atoi(fields[3].c_str());
+            if (winner >= 0) {
+                std::istringstream roles(fields[2]);
+                std::string role;
+                for (int seat = 0; seat <= winner; ++seat) {
+                    std::getline(roles, role, ';');
+                }
+                ++csvWins[std::atoi(role.c_str())];
+            }
+        }
+    }
+    double csvProject = secondsSince(start);
+    for (int r = 0; r < ROLE_COUNT; ++r) {
+        mismatches += columnarWins[r] != csvWins[r];
+    }
+
+    std::uint64_t columnarBytes = fileSize(columnar);
+    std::uint64_t csvBytes = fileSize(csv);
+    double perGame = static_cast<double>(games);
+    std::cout << std::fixed << std::setprecision(1)
+              << "{\n"
+              << "  \"games\": " << games << ",\n"
+              << "  \"row_groups\": " << file.groupCount() << ",\n"
+              << "  \"columnar_bytes_per_game\": " << columnarBytes / perGame << ",\n"
+              << "  \"csv_bytes_per_game\": " << csvBytes / perGame << ",\n"
+              << "  \"column_bytes_per_game\": {";
+    for (std::size_t c = 0; c < OUTCOME_COLUMN_COUNT; ++c) {
+        OutcomeColumn column = static_cast<OutcomeColumn>(c);
+        std::cout << (c ? ", " : "") << '"' << outcomeColumnName(column) << "\": " << file.columnBytes(column) / perGame;
+    }
+    std::cout << "},\n" << std::setprecision(0)
+              << "  \"columnar_write_games_per_second\": " << games / columnarWrite << ",\n"
+              << "  \"csv_write_games_per_second\": " << games / csvWrite << ",\n"
+              << "  \"columnar_read_games_per_second\": " << games / columnarRead << ",\n"
+              << "  \"columnar_wins_by_role_games_per_second\": " << games / columnarProject << ",\n"
+              << "  \"csv_wins_by_role_games_per_second\": " << games / csvProject << ",\n"
+              << "  \"mismatches\": " << mismatches << "\n"
+              << "}\n";
+
+    ::unlink(columnar.c_str());
+    ::unlink(csv.c_str());
+    if (mismatches > 0) {
+        std::cerr << "Outcome file does not read back what was written" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+// Email: nitzanwa@gmail.com
+
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/PositionStore.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace coup;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * What a reader thread saw while the writers were appending
+     */
+    struct ReaderReport {
+        std::uint64_t lookups = 0;
+        std::uint64_t chained = 0;    // records reached through lookup chains
+        std::uint64_t torn = 0;       // published records whose key does not match their position
+    };
+
+    void readWhileWriting(const PositionStore &store, std::uint64_t seed, const std::atomic<bool> &writing,
+                          ReaderReport &report) {
+        Rng rng(seed);
+        while (writing.load(std::memory_order_relaxed)) {
+            std::uint64_t size = store.size();
+            if (size == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::uint64_t index = rng.uniform(size);
+            if (!store.published(index)) {
+                continue;
+            }
+            const PositionRecord &record = store[index];
+            if (record.key != positionKey(record.position)) {
+                ++report.torn;
+            }
+            ++report.lookups;
+            for (std::uint64_t found = store.lookup(record.key); found != POSITION_NONE;
+                 found = store.nextWithKey(found)) {
+                ++report.chained;
+            }
+        }
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    long writers = 4;
+    long readers = 2;
+    long games = 4000;
+    std::uint64_t seed = 1;
+    std::string path = "/tmp/coup_positions_" + std::to_string(::getpid()) + ".db";
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--writers" && i + 1 < argc) {
+            writers = std::atol(argv[++i]);
+        } else if (arg == "--readers" && i + 1 < argc) {
+            readers = std::atol(argv[++i]);
+        } else if (arg == "--games" && i + 1 < argc) {
+            games = std::atol(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--store" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--keep") {
+            keep = true;
+        } else {
+            writers = 0;
+            break;
+        }
+    }
+    if (writers <= 0 || readers < 0 || games <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--writers W > 0] [--readers R >= 0] [--games G > 0] [--seed S]"
+                  << " [--store PATH] [--keep]" << std::endl;
+        return 2;
+    }
+
+    Logger::setEnabled(false);
+    std::uint64_t capacity = static_cast<std::uint64_t>(games) * (Simulator::DEFAULT_MAX_TURNS + 1);
+    PositionStore store = PositionStore::create(path, capacity);
+
+    // Writers play disjoint games and append each game's positions when it ends
+    std::atomic<bool> writing(true);
+    std::atomic<std::uint64_t> turns(0);
+    std::vector<ReaderReport> reports(static_cast<std::size_t>(readers));
+    std::vector<std::thread> readerThreads;
+    for (long r = 0; r < readers; ++r) {
+        readerThreads.emplace_back(readWhileWriting, std::cref(store), seed + static_cast<std::uint64_t>(r),
+                                   std::cref(writing), std::ref(reports[static_cast<std::size_t>(r)]));
+    }
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> writerThreads;
+    for (long w = 0; w < writers; ++w) {
+        writerThreads.emplace_back([&, w] {
+            for (long i = w; i < games; i += writers) {
+                std::size_t tableSize = 2 + static_cast<std::size_t>(i % 5);
+                GameResult result = Simulator::runGame(Rng::forStream(seed, static_cast<std::uint64_t>(i)).getSeed(),
+                                                       tableSize, Simulator::DEFAULT_MAX_TURNS, nullptr, nullptr,
+                                                       &store);
+                turns.fetch_add(static_cast<std::uint64_t>(result.turns), std::memory_order_relaxed);
+            }
+        });
+    }
+    for (std::thread &thread : writerThreads) {
+        thread.join();
+    }
+    double writeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    writing.store(false);
+    for (std::thread &thread : readerThreads) {
+        thread.join();
+    }
+    store.sync();
+
+    // Analysis pass over a fresh read-only mapping: wins by role of the player to move
+    PositionStore reader = PositionStore::open(path);
+    std::uint64_t size = reader.size();
+    std::uint64_t unpublished = 0;
+    std::uint64_t moverWins[ROLE_COUNT] = {};
+    Clock::time_point scanStart = Clock::now();
+    for (std::uint64_t i = 0; i < size; ++i) {
+        if (!reader.published(i)) {
+            ++unpublished;
+            continue;
+        }
+        const PositionRecord &record = reader[i];
+        if (record.winnerSeat == record.position.currentSeat) {
+            ++moverWins[record.position.players[record.position.currentSeat].role];
+        }
+    }
+    double scanSeconds = std::chrono::duration<double>(Clock::now() - scanStart).count();
+
+    // Every sampled position loads straight back into a Game
+    std::uint64_t loadMismatches = 0;
+    std::uint64_t samples = size < 1000 ? size : 1000;
+    Game game;
+    game.setConsoleMode(false);
+    Clock::time_point loadStart = Clock::now();
+    for (std::uint64_t s = 0; s < samples; ++s) {
+        const GameSnapshot &position = reader[s * size / samples].position;
+        game.loadSnapshot(position);
+        GameSnapshot again;
+        game.saveSnapshot(again);
+        if (std::memcmp(&again, &position, sizeof(GameSnapshot)) != 0) {
+            ++loadMismatches;
+        }
+    }
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - loadStart).count();
+
+    ReaderReport total;
+    for (const ReaderReport &report : reports) {
+        total.lookups += report.lookups;
+        total.chained += report.chained;
+        total.torn += report.torn;
+    }
+    std::uint64_t played = turns.load() + static_cast<std::uint64_t>(games);  // one start position per game
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "{\n"
+              << "  \"writers\": " << writers << ",\n"
+              << "  \"readers\": " << readers << ",\n"
+              << "  \"games\": " << games << ",\n"
+              << "  \"positions\": " << size << ",\n"
+              << "  \"bytes_per_position\": " << sizeof(PositionRecord) << ",\n"
+              << "  \"positions_written_per_second\": " << size / writeSeconds << ",\n"
+              << "  \"concurrent_lookups\": " << total.lookups << ",\n"
+              << "  \"concurrent_lookups_per_second\": " << total.lookups / writeSeconds << ",\n"
+              << "  \"records_per_key\": " << (total.lookups ? static_cast<double>(total.chained) / total.lookups : 0.0)
+              << ",\n"
+              << "  \"torn_reads\": " << total.torn << ",\n"
+              << "  \"scan_positions_per_second\": " << std::setprecision(0) << size / scanSeconds << ",\n"
+              << "  \"mover_wins\": [" << moverWins[0] << ", " << moverWins[1] << ", " << moverWins[2] << ", "
+              << moverWins[3] << ", " << moverWins[4] << ", " << moverWins[5] << "],\n"
+              << "  \"loads_per_second\": " << samples / loadSeconds << ",\n"
+              << "  \"load_mismatches\": " << loadMismatches << "\n"
+              << "}\n";
+
+    if (!keep) {
+        ::unlink(path.c_str());
+    }
+    if (size != played || unpublished > 0 || total.torn > 0 || loadMismatches > 0) {
+        std::cerr << "Position store is inconsistent" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,368 @@
+// Email: nitzanwa@gmail.com
+
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/Spectator.hpp"
+#include "../GameLogic/SpectatorServer.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace coup;
+
+namespace {
+
+    /**
+     * What the spectator process saw, sent back to the broadcasting process
+     */
+    struct ViewerReport {
+        std::uint64_t bytes;       // bytes received by all spectators
+        std::uint64_t frames;      // frames applied by all spectators
+        std::uint64_t gaps;        // deltas skipped while waiting for a keyframe
+        std::uint64_t connected;   // spectators that connected
+        std::uint64_t unsynced;    // spectators that never reached the final frame
+        std::uint64_t mismatched;  // spectators whose final table differs
+    };
+
+    struct Viewer {
+        int fd;
+        std::vector<std::uint8_t> buffer;
+        std::size_t used;
+        SpectatorState state;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    void raiseDescriptorLimit() {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            ::setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    bool readAll(int fd, void *data, std::size_t size) {
+        auto *out = static_cast<char *>(data);
+        while (size > 0) {
+            ssize_t n = ::read(fd, out, size);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            out += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const void *data, std::size_t size) {
+        const auto *in = static_cast<const char *>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, in, size);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            in += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    int connectViewer(const std::string &path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        for (int attempt = 0; attempt < 10000; ++attempt) {
+            int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return -1;
+            }
+            if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+                return fd;
+            }
+            ::close(fd);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));  // not listening yet, or backlog full
+        }
+        return -1;
+    }
+
+    /**
+     * Reads whatever a spectator has received and applies the complete frames
+     * @return false when the connection closed or sent garbage
+     */
+    bool drain(Viewer &viewer, ViewerReport &report) {
+        while (true) {
+            if (viewer.buffer.size() - viewer.used < 1024) {
+                viewer.buffer.resize(viewer.buffer.size() * 2);
+            }
+            ssize_t n = ::recv(viewer.fd, viewer.buffer.data() + viewer.used, viewer.buffer.size() - viewer.used,
+                               MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            if (n == 0) {
+                return false;
+            }
+            viewer.used += static_cast<std::size_t>(n);
+            report.bytes += static_cast<std::uint64_t>(n);
+
+            std::size_t consumed = 0;
+            try {
+                while (true) {
+                    std::size_t size = SpectatorState::frameSize(viewer.buffer.data() + consumed, viewer.used - consumed);
+                    if (size == 0) {
+                        break;
+                    }
+                    if (viewer.state.apply(viewer.buffer.data() + consumed, size)) {
+                        ++report.frames;
+                    } else {
+                        ++report.gaps;
+                    }
+                    consumed += size;
+                }
+            } catch (const std::exception &) {
+                return false;
+            }
+            std::memmove(viewer.buffer.data(), viewer.buffer.data() + consumed, viewer.used - consumed);
+            viewer.used -= consumed;
+        }
+    }
+
+    /**
+     * Spectator process: connects every spectator, follows the stream and,
+     * once told the final frame, checks each reconstructed table against it
+     */
+    ViewerReport runViewers(const std::string &path, std::size_t count, int controlFd) {
+        ViewerReport report{};
+        std::vector<Viewer> viewers(count);
+        for (Viewer &viewer : viewers) {
+            viewer.fd = connectViewer(path);
+            viewer.buffer.resize(4096);
+            viewer.used = 0;
+            if (viewer.fd >= 0) {
+                ++report.connected;
+            }
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<std::uint8_t> finalFrame;
+        std::uint32_t finalSequence = 0;
+        bool haveFinal = false;
+        Clock::time_point deadline = Clock::time_point::max();
+
+        while (Clock::now() < deadline) {
+            fds.clear();
+            fds.push_back(pollfd{controlFd, static_cast<short>(haveFinal ? 0 : POLLIN), 0});
+            for (const Viewer &viewer : viewers) {
+                fds.push_back(pollfd{viewer.fd, POLLIN, 0});
+            }
+            if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+                break;
+            }
+            if (fds[0].revents & POLLIN) {
+                std::uint32_t size = 0;
+                if (!readAll(controlFd, &finalSequence, sizeof(finalSequence)) ||
+                    !readAll(controlFd, &size, sizeof(size))) {
+                    break;
+                }
+                finalFrame.resize(size);
+                if (!readAll(controlFd, finalFrame.data(), size)) {
+                    break;
+                }
+                haveFinal = true;
+                deadline = Clock::now() + std::chrono::seconds(60);
+            }
+            for (std::size_t i = 0; i < viewers.size(); ++i) {
+                if (viewers[i].fd >= 0 && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) &&
+                    !drain(viewers[i], report)) {
+                    ::close(viewers[i].fd);
+                    viewers[i].fd = -1;
+                }
+            }
+            if (haveFinal) {
+                bool allThere = true;
+                for (const Viewer &viewer : viewers) {
+                    allThere = allThere && (viewer.fd < 0 || viewer.state.sequence == finalSequence);
+                }
+                if (allThere) {
+                    break;
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> encoded;
+        for (Viewer &viewer : viewers) {
+            if (!viewer.state.synced || viewer.state.sequence != finalSequence) {
+                ++report.unsynced;
+            } else {
+                encoded.clear();
+                viewer.state.writeKeyframe(encoded, finalSequence);
+                report.mismatched += encoded != finalFrame ? 1 : 0;
+            }
+            if (viewer.fd >= 0) {
+                ::close(viewer.fd);
+            }
+        }
+        return report;
+    }
+
+}
+
+// Usage: coup_spectator_bench [--spectators N] [--games G] [--seed S]
+//                             [--keyframe-interval K] [--socket PATH]
+// Plays G simulated games while N spectators on local sockets (in a child
+// process) follow them. Exit status 1 means a spectator ended out of sync.
+int main(int argc, char *argv[]) {
+    long spectators = 10000;
+    long games = 200;
+    std::uint64_t seed = 1;
+    long keyframeInterval = 32;
+    std::string socketPath = "/tmp/coup_spectators_" + std::to_string(::getpid()) + ".sock";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--spectators" && i + 1 < argc) {
+            spectators = std::atol(argv[++i]);
+        } else if (arg == "--games" && i + 1 < argc) {
+            games = std::atol(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--keyframe-interval" && i + 1 < argc) {
+            keyframeInterval = std::atol(argv[++i]);
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            games = 0;
+            break;
+        }
+    }
+    if (spectators <= 0 || games <= 0 || keyframeInterval <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--spectators N > 0] [--games G > 0] [--seed S]"
+                  << " [--keyframe-interval K > 0] [--socket PATH]" << std::endl;
+        return 2;
+    }
+
+    Logger::setEnabled(false);
+    raiseDescriptorLimit();
+
+    int control[2];
+    int results[2];
+    if (::pipe(control) < 0 || ::pipe(results) < 0) {
+        std::cerr << "Cannot create pipes: " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    pid_t child = ::fork();
+    if (child < 0) {
+        std::cerr << "Cannot fork: " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    if (child == 0) {
+        ::close(control[1]);
+        ::close(results[0]);
+        ViewerReport report = runViewers(socketPath, static_cast<std::size_t>(spectators), control[0]);
+        writeAll(results[1], &report, sizeof(report));
+        ::_exit(0);
+    }
+    ::close(control[0]);
+    ::close(results[1]);
+
+    // Started after fork() so the spectator process is single-threaded
+    SpectatorServer server;
+    try {
+        server.listen(socketPath);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        ::kill(child, SIGKILL);
+        ::waitpid(child, nullptr, 0);
+        return 2;
+    }
+
+    Clock::time_point connectDeadline = Clock::now() + std::chrono::seconds(60);
+    while (server.spectatorCount() < static_cast<std::size_t>(spectators) && Clock::now() < connectDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::size_t connected = server.spectatorCount();
+
+    // Broadcast: every frame is encoded once and shared by all spectators
+    SpectatorBroadcaster broadcaster(static_cast<unsigned>(keyframeInterval));
+    broadcaster.addSink(&server);
+    Clock::time_point start = Clock::now();
+    long turns = 0;
+    for (long i = 0; i < games; ++i) {
+        broadcaster.reset();
+        std::size_t tableSize = 2 + static_cast<std::size_t>(i % 5);
+        GameResult game = Simulator::runGame(Rng::forStream(seed, static_cast<std::uint64_t>(i)).getSeed(), tableSize,
+                                             Simulator::DEFAULT_MAX_TURNS, &broadcaster);
+        turns += game.turns;
+    }
+    broadcaster.sendKeyframe();  // spectators that fell behind converge on the final table
+    double playSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::uint8_t> finalFrame;
+    broadcaster.state().writeKeyframe(finalFrame, broadcaster.getSequence());
+    std::uint32_t finalSequence = broadcaster.getSequence();
+    std::uint32_t finalSize = static_cast<std::uint32_t>(finalFrame.size());
+    writeAll(control[1], &finalSequence, sizeof(finalSequence));
+    writeAll(control[1], &finalSize, sizeof(finalSize));
+    writeAll(control[1], finalFrame.data(), finalFrame.size());
+
+    ViewerReport report{};
+    bool reported = readAll(results[0], &report, sizeof(report));
+    double syncSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ::waitpid(child, nullptr, 0);
+    server.stop();
+
+    double frames = static_cast<double>(broadcaster.getFramesSent());
+    std::cout << std::fixed << std::setprecision(2)
+              << "{\n"
+              << "  \"spectators\": " << spectators << ",\n"
+              << "  \"connected\": " << connected << ",\n"
+              << "  \"games\": " << games << ",\n"
+              << "  \"turns\": " << turns << ",\n"
+              << "  \"frames\": " << broadcaster.getFramesSent() << ",\n"
+              << "  \"keyframes\": " << broadcaster.getKeyframesSent() << ",\n"
+              << "  \"bytes_encoded\": " << broadcaster.getBytesEncoded() << ",\n"
+              << "  \"bytes_per_frame\": " << broadcaster.getBytesEncoded() / frames << ",\n"
+              << "  \"bytes_sent\": " << server.getBytesSent() << ",\n"
+              << "  \"bytes_received\": " << report.bytes << ",\n"
+              << "  \"frames_applied\": " << report.frames << ",\n"
+              << "  \"resyncs\": " << server.getResyncs() << ",\n"
+              << "  \"gaps\": " << report.gaps << ",\n"
+              << "  \"play_seconds\": " << playSeconds << ",\n"
+              << "  \"all_synced_seconds\": " << syncSeconds << ",\n"
+              << "  \"frame_deliveries_per_second\": " << report.frames / syncSeconds << ",\n"
+              << "  \"delivered_mb_per_second\": " << report.bytes / syncSeconds / 1e6 << ",\n"
+              << "  \"unsynced\": " << report.unsynced << ",\n"
+              << "  \"mismatched\": " << report.mismatched << "\n"
+              << "}\n";
+
+    if (!reported || report.connected != static_cast<std::uint64_t>(spectators) || report.unsynced > 0 ||
+        report.mismatched > 0) {
+        std::cerr << "Spectators did not all reach the final table" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,244 @@
+// Email: nitzanwa@gmail.com
+
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/WriteAheadLog.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace coup;
+
+namespace {
+
+    /**
+     * Progress of the writer process, kept in memory shared with the parent
+     * so it survives the SIGKILL
+     */
+    struct Progress {
+        std::atomic<std::uint64_t> durableTurns;  // turns whose records were committed
+        std::atomic<std::uint64_t> gamesStarted;
+        std::atomic<std::uint64_t> gamesEnded;
+        std::atomic<std::uint64_t> records;
+        std::atomic<std::uint64_t> logicalBytes;
+        std::atomic<std::uint64_t> logBytes;
+        std::atomic<std::uint64_t> pageBytes;
+        std::atomic<std::uint64_t> commits;
+        std::atomic<bool> writing;                // set after the first committed round
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    struct LiveGame {
+        std::unique_ptr<WalGameWriter> writer;
+        std::unique_ptr<SimulatedGame> game;
+    };
+
+    void startGame(LiveGame &live, WriteAheadLog &log, std::uint64_t seed, std::uint64_t stream, Progress &progress) {
+        live.game.reset();
+        live.writer = std::make_unique<WalGameWriter>(log);
+        std::size_t tableSize = 2 + static_cast<std::size_t>(stream % 5);
+        live.game = std::make_unique<SimulatedGame>(Rng::forStream(seed, stream).getSeed(), tableSize,
+                                                    Simulator::DEFAULT_MAX_TURNS, nullptr, live.writer.get());
+        progress.gamesStarted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * One writer thread: plays its games a turn each per round, then waits
+     * for the round's records to be durable before counting its turns
+     */
+    void playGames(WriteAheadLog &log, std::size_t thread, std::size_t games, std::uint64_t seed, Progress &progress) {
+        std::uint64_t nextStream = static_cast<std::uint64_t>(thread) << 32;
+        std::vector<LiveGame> live(games);
+        for (LiveGame &g : live) {
+            startGame(g, log, seed, nextStream++, progress);
+        }
+        while (true) {
+            std::uint64_t turns = 0;
+            std::uint64_t lsn = 0;
+            for (LiveGame &g : live) {
+                if (g.game->step()) {
+                    ++turns;
+                } else {
+                    g.game->finish();
+                    progress.gamesEnded.fetch_add(1, std::memory_order_relaxed);
+                    startGame(g, log, seed, nextStream++, progress);
+                }
+                lsn = std::max(lsn, g.writer->getLastLsn());
+            }
+            log.waitDurable(lsn);
+            progress.durableTurns.fetch_add(turns, std::memory_order_relaxed);
+
+            if (thread == 0) {
+                WalStats stats = log.getStats();
+                progress.records.store(stats.records, std::memory_order_relaxed);
+                progress.logicalBytes.store(stats.logicalBytes, std::memory_order_relaxed);
+                progress.logBytes.store(stats.logBytes, std::memory_order_relaxed);
+                progress.pageBytes.store(stats.pageBytes, std::memory_order_relaxed);
+                progress.commits.store(stats.commits, std::memory_order_relaxed);
+                progress.writing.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[noreturn]] void runWriter(const std::string &path, std::size_t threads, std::size_t games, std::uint64_t seed,
+                                int commitDelayMicros, Progress &progress) {
+        try {
+            WriteAheadLog log(path, 1, commitDelayMicros);
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back(playGames, std::ref(log), t, games, seed, std::ref(progress));
+            }
+            for (std::thread &worker : workers) {
+                worker.join();  // never returns: the parent kills the process
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Writer failed: " << e.what() << std::endl;
+        }
+        ::_exit(1);
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    long threads = 4;
+    long games = 64;
+    double seconds = 3.0;
+    std::uint64_t seed = 1;
+    long commitDelay = WriteAheadLog::DEFAULT_COMMIT_DELAY_MICROS;
+    std::string path = "/tmp/coup_wal_" + std::to_string(::getpid()) + ".log";
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atol(argv[++i]);
+        } else if (arg == "--games" && i + 1 < argc) {
+            games = std::atol(argv[++i]);
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--commit-delay-us" && i + 1 < argc) {
+            commitDelay = std::atol(argv[++i]);
+        } else if (arg == "--log" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--keep") {
+            keep = true;
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if (threads <= 0 || games <= 0 || seconds <= 0 || commitDelay < 0) {
+        std::cerr << "Usage: " << argv[0] << " [--threads T > 0] [--games G > 0 per thread] [--seconds S > 0]"
+                  << " [--seed S] [--commit-delay-us D >= 0] [--log PATH] [--keep]" << std::endl;
+        return 2;
+    }
+
+    Logger::setEnabled(false);
+    ::unlink(path.c_str());
+
+    void *shared = ::mmap(nullptr, sizeof(Progress), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        std::cerr << "Cannot map shared memory: " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    Progress &progress = *new (shared) Progress{};
+
+    pid_t child = ::fork();
+    if (child < 0) {
+        std::cerr << "Cannot fork: " << std::strerror(errno) << std::endl;
+        return 2;
+    }
+    if (child == 0) {
+        runWriter(path, static_cast<std::size_t>(threads), static_cast<std::size_t>(games), seed,
+                  static_cast<int>(commitDelay), progress);
+    }
+
+    // Let the writer reach a steady state, then crash it mid-games
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(30);
+    while (!progress.writing.load() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::uint64_t turnsBefore = progress.durableTurns.load();
+    Clock::time_point start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    std::uint64_t turnsDuring = progress.durableTurns.load() - turnsBefore;
+    double writeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    ::kill(child, SIGKILL);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    bool killed = WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL;
+
+    std::uint64_t inFlight = progress.gamesStarted.load() - progress.gamesEnded.load();
+    Clock::time_point recoverStart = Clock::now();
+    WalRecovery recovery;
+    try {
+        recovery = WriteAheadLog::recover(path);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    double recoverSeconds = std::chrono::duration<double>(Clock::now() - recoverStart).count();
+
+    std::uint64_t replayed = 0;
+    for (const RecoveredGame &game : recovery.games) {
+        replayed += game.replayed;
+    }
+    double logical = static_cast<double>(std::max<std::uint64_t>(progress.logicalBytes.load(), 1));
+    double commits = static_cast<double>(std::max<std::uint64_t>(progress.commits.load(), 1));
+    std::cout << std::fixed << std::setprecision(2)
+              << "{\n"
+              << "  \"threads\": " << threads << ",\n"
+              << "  \"games_per_thread\": " << games << ",\n"
+              << "  \"commit_delay_us\": " << commitDelay << ",\n"
+              << "  \"durable_turns_per_second\": " << turnsDuring / writeSeconds << ",\n"
+              << "  \"games_started\": " << progress.gamesStarted.load() << ",\n"
+              << "  \"games_ended\": " << progress.gamesEnded.load() << ",\n"
+              << "  \"in_flight_at_kill\": " << inFlight << ",\n"
+              << "  \"records\": " << progress.records.load() << ",\n"
+              << "  \"commits\": " << progress.commits.load() << ",\n"
+              << "  \"records_per_commit\": " << progress.records.load() / commits << ",\n"
+              << "  \"bytes_per_commit\": " << progress.logBytes.load() / commits << ",\n"
+              << "  \"logical_bytes\": " << progress.logicalBytes.load() << ",\n"
+              << "  \"log_bytes\": " << progress.logBytes.load() << ",\n"
+              << "  \"framing_amplification\": " << progress.logBytes.load() / logical << ",\n"
+              << "  \"page_write_amplification\": " << progress.pageBytes.load() / logical << ",\n"
+              << "  \"log_file_bytes\": " << recovery.validBytes + recovery.tornBytes << ",\n"
+              << "  \"torn_bytes\": " << recovery.tornBytes << ",\n"
+              << "  \"recovered_games\": " << recovery.games.size() << ",\n"
+              << "  \"ended_games_skipped\": " << recovery.endedGames << ",\n"
+              << "  \"failed_games\": " << recovery.failedGames << ",\n"
+              << "  \"entries_replayed\": " << replayed << ",\n"
+              << "  \"recovery_seconds\": " << std::setprecision(4) << recoverSeconds << ",\n"
+              << "  \"entries_replayed_per_second\": " << std::setprecision(0) << replayed / recoverSeconds << "\n"
+              << "}\n";
+
+    if (!keep) {
+        ::unlink(path.c_str());
+    }
+    // A thread killed between logging a Begin and counting the game adds one
+    if (!killed || recovery.failedGames > 0 || recovery.games.empty() ||
+        recovery.games.size() > inFlight + static_cast<std::uint64_t>(threads)) {
+        std::cerr << "Recovery did not rebuild the in-flight games" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+// Email: nitzanwa@gmail.com
+
+#include "AssetLoader.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    const char* const FONT_PATHS[] = {
+        "GUI/fonts/ARIAL.TTF",
+        "./GUI/fonts/ARIAL.TTF",
+        "Arial.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+        "C:\\Windows\\Fonts\\arial.ttf"
+    };
+    const std::uint32_t FONT_PATH_COUNT = sizeof(FONT_PATHS) / sizeof(FONT_PATHS[0]);
+
+    const char* const MENU_PATH = "GUI/images/background_menu.png";
+    const char* const GAME_PATH = "GUI/images/game_background.png";
+    const char* const WINNER_PATH = "GUI/images/winner_bg.png";
+
+    const char BUNDLE_MAGIC[8] = {'C', 'O', 'U', 'P', 'A', 'S', 'T', '2'};
+
+    // Presence, size and modification time identify a source file's version
+    struct SourceStamp {
+        std::uint8_t present = 0;
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+    };
+
+    bool stampOf(const std::string& path, SourceStamp& stamp) {
+        stamp = SourceStamp();
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return false;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        stamp.present = 1;
+        stamp.size = size;
+        stamp.mtime = static_cast<std::int64_t>(time.time_since_epoch().count());
+        return true;
+    }
+
+    // Whether the font search would now stop at an earlier candidate than it did
+    bool betterFontAppeared(std::uint32_t fontIndex) {
+        for (std::uint32_t i = 0; i < fontIndex && i < FONT_PATH_COUNT; ++i) {
+            SourceStamp stamp;
+            if (stampOf(FONT_PATHS[i], stamp) && stamp.size > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readFile(const std::string& path, std::vector<char>& data) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return !data.empty();
+    }
+
+    template <typename T>
+    void writePod(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool readPod(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    void writeString(std::ostream& out, const std::string& s) {
+        writePod(out, static_cast<std::uint32_t>(s.size()));
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    bool readString(std::istream& in, std::string& s) {
+        std::uint32_t size = 0;
+        if (!readPod(in, size) || size > 4096) return false;
+        s.resize(size);
+        return static_cast<bool>(in.read(&s[0], size));
+    }
+
+    void writeImage(std::ostream& out, const sf::Image& image) {
+        sf::Vector2u size = image.getSize();
+        writePod(out, static_cast<std::uint32_t>(size.x));
+        writePod(out, static_cast<std::uint32_t>(size.y));
+        out.write(reinterpret_cast<const char*>(image.getPixelsPtr()),
+                  static_cast<std::streamsize>(size.x) * size.y * 4);
+    }
+
+    bool readImage(std::istream& in, sf::Image& image) {
+        std::uint32_t width = 0, height = 0;
+        if (!readPod(in, width) || !readPod(in, height) || width == 0 || height == 0 ||
+            width > 16384 || height > 16384) {
+            return false;
+        }
+        std::vector<sf::Uint8> pixels(static_cast<std::size_t>(width) * height * 4);
+        if (!in.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()))) {
+            return false;
+        }
+        image.create(width, height, pixels.data());
+        return true;
+    }
+
+    // Bundle layout (native byte order, it is a local cache):
+    //   magic[8], winning font candidate (FONT_PATH_COUNT if none),
+    //   source count, per source {path, present, size, mtime}, font bytes,
+    //   then menu, game and winner images as {width, height, RGBA pixels}
+    std::vector<std::string> bundleSources(std::uint32_t fontIndex) {
+        std::vector<std::string> sources = {MENU_PATH, GAME_PATH, WINNER_PATH};
+        if (fontIndex < FONT_PATH_COUNT) {
+            sources.push_back(FONT_PATHS[fontIndex]);
+        }
+        return sources;
+    }
+
+    bool readBundle(const std::string& cachePath, AssetBundle& bundle) {
+        std::ifstream in(cachePath, std::ios::binary);
+        if (!in) return false;
+        char magic[sizeof(BUNDLE_MAGIC)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, BUNDLE_MAGIC, sizeof(magic)) != 0) {
+            return false;
+        }
+        std::uint32_t fontIndex = 0;
+        if (!readPod(in, fontIndex) || fontIndex > FONT_PATH_COUNT || betterFontAppeared(fontIndex)) {
+            return false;
+        }
+        std::uint32_t sources = 0;
+        if (!readPod(in, sources) || sources > 16) return false;
+        for (std::uint32_t i = 0; i < sources; ++i) {
+            std::string path;
+            SourceStamp recorded, actual;
+            if (!readString(in, path) || !readPod(in, recorded.present) || !readPod(in, recorded.size) ||
+                !readPod(in, recorded.mtime)) {
+                return false;
+            }
+            // A source that appeared, disappeared or changed makes the cache stale
+            stampOf(path, actual);
+            if (actual.present != recorded.present || actual.size != recorded.size ||
+                actual.mtime != recorded.mtime) {
+                return false;
+            }
+        }
+        std::uint64_t fontSize = 0;
+        if (!readPod(in, fontSize) || fontSize > (64u << 20)) return false;
+        bundle.fontData.resize(static_cast<std::size_t>(fontSize));
+        if (fontSize && !in.read(bundle.fontData.data(), static_cast<std::streamsize>(fontSize))) {
+            return false;
+        }
+        return readImage(in, bundle.menuBackground) && readImage(in, bundle.gameBackground) &&
+               readImage(in, bundle.winnerBackground);
+    }
+
+    void writeBundle(const std::string& cachePath, const AssetBundle& bundle, std::uint32_t fontIndex) {
+        std::string tmp = cachePath + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                std::cerr << "Cannot write asset cache " << tmp << std::endl;
+                return;
+            }
+            out.write(BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+            writePod(out, fontIndex);
+            std::vector<std::string> sources = bundleSources(fontIndex);
+            writePod(out, static_cast<std::uint32_t>(sources.size()));
+            for (const std::string& path : sources) {
+                SourceStamp stamp;
+                stampOf(path, stamp);
+                writeString(out, path);
+                writePod(out, stamp.present);
+                writePod(out, stamp.size);
+                writePod(out, stamp.mtime);
+            }
+            writePod(out, static_cast<std::uint64_t>(bundle.fontData.size()));
+            out.write(bundle.fontData.data(), static_cast<std::streamsize>(bundle.fontData.size()));
+            writeImage(out, bundle.menuBackground);
+            writeImage(out, bundle.gameBackground);
+            writeImage(out, bundle.winnerBackground);
+            if (!out) {
+                std::cerr << "Failed writing asset cache " << tmp << std::endl;
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, cachePath, ec);
+    }
+
+    void loadImage(sf::Image& image, const char* path, const sf::Color& fallback) {
+        if (!image.loadFromFile(path)) {
+            std::cerr << "Failed to load " << path << "! Using fallback.\n";
+            image.create(1280, 720, fallback);
+        }
+    }
+}
+
+const char* const AssetLoader::CACHE_PATH = "GUI/assets.cache";
+
+AssetLoader::AssetLoader() : ready(false) {}
+
+AssetLoader::~AssetLoader() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AssetLoader::start() {
+    if (worker.joinable() || isReady()) {
+        return;
+    }
+    worker = std::thread([this]() {
+        bundle = load(CACHE_PATH);
+        ready.store(true, std::memory_order_release);
+    });
+}
+
+AssetBundle AssetLoader::load(const std::string& cachePath) {
+    AssetBundle bundle;
+    if (readBundle(cachePath, bundle)) {
+        bundle.fromCache = true;
+        return bundle;
+    }
+    bundle = AssetBundle();
+
+    std::uint32_t fontIndex = 0;
+    while (fontIndex < FONT_PATH_COUNT && !readFile(FONT_PATHS[fontIndex], bundle.fontData)) {
+        ++fontIndex;
+    }
+    if (fontIndex == FONT_PATH_COUNT) {
+        std::cerr << "Could not load any font, using default\n";
+    }
+
+    loadImage(bundle.menuBackground, MENU_PATH, sf::Color(30, 30, 50));
+    loadImage(bundle.gameBackground, GAME_PATH, sf::Color(20, 40, 40));
+    if (!bundle.winnerBackground.loadFromFile(WINNER_PATH)) {
+        std::cerr << "Failed to load winner background! Using fallback.\n";
+        bundle.winnerBackground = bundle.gameBackground;
+    }
+
+    writeBundle(cachePath, bundle, fontIndex);
+    return bundle;
+}
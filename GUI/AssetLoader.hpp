@@ -0,0 +1,50 @@
+// Email: nitzanwa@gmail.com
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decoded GUI assets, ready to be turned into an sf::Font and textures
+struct AssetBundle {
+    std::vector<char> fontData;   // raw font file (sf::Font reads from it, so keep it alive)
+    sf::Image menuBackground;
+    sf::Image gameBackground;
+    sf::Image winnerBackground;
+    bool fromCache = false;       // true if the pre-decoded bundle was used
+};
+
+// Loads GUI assets on a background thread.
+//
+// The first start decodes the PNGs and writes a pre-decoded bundle
+// (raw RGBA pixels plus the font bytes) next to them; later starts read the
+// bundle instead of decoding, as long as every source file is still present
+// (or still missing) with the size and modification time recorded in it, and
+// no font candidate ahead of the one that was used has appeared since. Only
+// CPU-side data is produced here - textures must be created on the render thread.
+class AssetLoader {
+public:
+    static const char* const CACHE_PATH;
+
+    AssetLoader();
+    ~AssetLoader();
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    void start();
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+
+    // The loaded assets; only valid once isReady() is true
+    AssetBundle& result() { return bundle; }
+
+    // Synchronous load, used by start()'s thread
+    static AssetBundle load(const std::string& cachePath);
+
+private:
+    std::thread worker;
+    std::atomic<bool> ready;
+    AssetBundle bundle;
+};
@@ -0,0 +1,148 @@
+// Email: nitzanwa@gmail.com
+
+#include "FrameProfiler.hpp"
+#include "../GameLogic/ActionMetrics.hpp"
+#include "../GameLogic/AllocationTracker.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace {
+    const char* const PHASE_NAMES[FRAME_PHASE_COUNT] = {
+        "Events", "Update", " Cards", " Layout", "Render", "Display"
+    };
+
+    std::string formatMs(std::uint64_t ns) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%6.2f ms", ns / 1e6);
+        return buffer;
+    }
+
+    const float OVERLAY_X = 900.f;
+    const float OVERLAY_Y = 10.f;
+    const float OVERLAY_WIDTH = 370.f;
+    const float GRAPH_HEIGHT = 60.f;
+    const float GRAPH_SCALE_MS = 33.3f;   // top of the graph
+}
+
+FrameProfiler::FrameProfiler()
+    : next(0), count(0), frameStartNs(0), frameAllocationsStart(0), visible(false) {}
+
+void FrameProfiler::beginFrame() {
+    current = Frame();
+    frameStartNs = coup::metricsClockNs();
+    frameAllocationsStart = coup::AllocationTracker::current().allocations;
+}
+
+void FrameProfiler::endFrame() {
+    current.allocations = coup::AllocationTracker::current().allocations - frameAllocationsStart;
+    current.frameNs = coup::metricsClockNs() - frameStartNs;
+    history[next] = current;
+    next = (next + 1) % HISTORY;
+    count = std::min(count + 1, HISTORY);
+}
+
+void FrameProfiler::addPhase(FramePhase phase, std::uint64_t ns) {
+    current.phaseNs[static_cast<int>(phase)] += ns;
+}
+
+FrameProfiler::Frame FrameProfiler::average() const {
+    Frame sum;
+    if (count == 0) {
+        return sum;
+    }
+    std::uint64_t draws = 0;
+    for (int i = 0; i < count; ++i) {
+        const Frame& f = history[i];
+        sum.frameNs += f.frameNs;
+        for (int p = 0; p < FRAME_PHASE_COUNT; ++p) {
+            sum.phaseNs[p] += f.phaseNs[p];
+        }
+        draws += f.drawCalls;
+        sum.allocations += f.allocations;
+    }
+    sum.frameNs /= count;
+    for (auto& ns : sum.phaseNs) {
+        ns /= count;
+    }
+    sum.drawCalls = static_cast<unsigned int>(draws / count);
+    sum.allocations /= count;
+    return sum;
+}
+
+const FrameProfiler::Frame& FrameProfiler::latest() const {
+    return history[(next + HISTORY - 1) % HISTORY];
+}
+
+std::uint64_t FrameProfiler::worstFrameNs() const {
+    std::uint64_t worst = 0;
+    for (int i = 0; i < count; ++i) {
+        worst = std::max(worst, history[i].frameNs);
+    }
+    return worst;
+}
+
+void FrameProfiler::draw(ProfiledWindow& window, const sf::Font& font) const {
+    if (!visible) {
+        return;
+    }
+    Frame avg = average();
+
+    std::string lines;
+    char header[96];
+    std::snprintf(header, sizeof(header), "Frame %s  (%.0f FPS, worst %s)\n",
+                  formatMs(avg.frameNs).c_str(), avg.frameNs ? 1e9 / avg.frameNs : 0.0,
+                  formatMs(worstFrameNs()).c_str());
+    lines += header;
+    for (int p = 0; p < FRAME_PHASE_COUNT; ++p) {
+        lines += std::string(PHASE_NAMES[p]) + ": " + formatMs(avg.phaseNs[p]) + "\n";
+    }
+    lines += "Draw calls: " + std::to_string(avg.drawCalls) + "\n";
+    lines += "Allocations/frame: " + (coup::AllocationTracker::isEnabled()
+                                          ? std::to_string(avg.allocations)
+                                          : std::string("n/a (build with TRACK_ALLOCS=1)"));
+
+    sf::Text text(lines, font, 13);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(OVERLAY_X + 8.f, OVERLAY_Y + 6.f);
+    float textHeight = text.getLocalBounds().height + text.getLocalBounds().top;
+
+    float graphTop = OVERLAY_Y + textHeight + 16.f;
+    sf::RectangleShape background({OVERLAY_WIDTH, graphTop - OVERLAY_Y + GRAPH_HEIGHT + 8.f});
+    background.setPosition(OVERLAY_X, OVERLAY_Y);
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+    background.setOutlineThickness(1);
+    background.setOutlineColor(sf::Color(120, 120, 120));
+    window.draw(background);
+    window.draw(text);
+
+    // Rolling graph: one bar per frame (oldest on the left), plus the 60 FPS line
+    sf::VertexArray graph(sf::Lines);
+    float graphLeft = OVERLAY_X + 8.f;
+    float barWidth = (OVERLAY_WIDTH - 16.f) / HISTORY;
+    float graphBottom = graphTop + GRAPH_HEIGHT;
+    for (int i = 0; i < count; ++i) {
+        const Frame& f = history[(next - count + i + HISTORY) % HISTORY];
+        float ms = static_cast<float>(f.frameNs / 1e6);
+        float height = std::min(ms / GRAPH_SCALE_MS, 1.f) * GRAPH_HEIGHT;
+        sf::Color color = ms <= 16.7f ? sf::Color::Green : ms <= 33.3f ? sf::Color::Yellow : sf::Color::Red;
+        float x = graphLeft + i * barWidth;
+        graph.append(sf::Vertex(sf::Vector2f(x, graphBottom), color));
+        graph.append(sf::Vertex(sf::Vector2f(x, graphBottom - height), color));
+    }
+    float budgetY = graphBottom - 16.7f / GRAPH_SCALE_MS * GRAPH_HEIGHT;
+    graph.append(sf::Vertex(sf::Vector2f(graphLeft, budgetY), sf::Color(255, 255, 255, 120)));
+    graph.append(sf::Vertex(sf::Vector2f(graphLeft + HISTORY * barWidth, budgetY), sf::Color(255, 255, 255, 120)));
+    window.draw(graph);
+}
+
+PhaseTimer::PhaseTimer(FrameProfiler& profiler, FramePhase phase)
+    : profiler(profiler), phase(phase), startNs(coup::metricsClockNs()), running(true) {}
+
+void PhaseTimer::stop() {
+    if (running) {
+        profiler.addPhase(phase, coup::metricsClockNs() - startNs);
+        running = false;
+    }
+}
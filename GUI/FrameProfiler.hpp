@@ -0,0 +1,95 @@
+// Email: nitzanwa@gmail.com
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+
+// Render window that counts draw calls between resets
+class ProfiledWindow : public sf::RenderWindow {
+public:
+    using sf::RenderWindow::RenderWindow;
+
+    void draw(const sf::Drawable& drawable, const sf::RenderStates& states = sf::RenderStates::Default) {
+        ++drawCalls;
+        sf::RenderWindow::draw(drawable, states);
+    }
+
+    void draw(const sf::Vertex* vertices, std::size_t count, sf::PrimitiveType type,
+              const sf::RenderStates& states = sf::RenderStates::Default) {
+        ++drawCalls;
+        sf::RenderWindow::draw(vertices, count, type, states);
+    }
+
+    unsigned int getDrawCalls() const { return drawCalls; }
+    void resetDrawCalls() { drawCalls = 0; }
+
+private:
+    unsigned int drawCalls = 0;
+};
+
+// Parts of a GUI frame that are timed separately.
+// Cards and Layout run inside Update; Display includes the frame limiter wait.
+enum class FramePhase { Events, Update, Cards, Layout, Render, Display };
+constexpr int FRAME_PHASE_COUNT = 6;
+
+// Per-frame timings for the in-window overlay (toggled with F3)
+class FrameProfiler {
+public:
+    static constexpr int HISTORY = 120;   // frames kept for the graph and averages
+
+    struct Frame {
+        std::uint64_t frameNs = 0;                           // beginFrame to endFrame (incl. display wait)
+        std::array<std::uint64_t, FRAME_PHASE_COUNT> phaseNs{};
+        unsigned int drawCalls = 0;
+        std::uint64_t allocations = 0;
+    };
+
+    FrameProfiler();
+
+    // Frame boundaries; endFrame stores the frame in the history
+    void beginFrame();
+    void endFrame();
+
+    void addPhase(FramePhase phase, std::uint64_t ns);
+    void setDrawCalls(unsigned int drawCalls) { current.drawCalls = drawCalls; }
+
+    // Average over the frames in the history
+    Frame average() const;
+    const Frame& latest() const;
+    std::uint64_t worstFrameNs() const;
+    int frameCount() const { return count; }
+
+    void setVisible(bool visible) { this->visible = visible; }
+    bool isVisible() const { return visible; }
+
+    // Draws the text breakdown and the rolling frame-time graph
+    void draw(ProfiledWindow& window, const sf::Font& font) const;
+
+private:
+    std::array<Frame, HISTORY> history;
+    int next;
+    int count;
+    Frame current;
+    std::uint64_t frameStartNs;
+    std::uint64_t frameAllocationsStart;
+    bool visible;
+};
+
+// Adds the time until stop() (or destruction) to one phase of the current frame
+class PhaseTimer {
+public:
+    PhaseTimer(FrameProfiler& profiler, FramePhase phase);
+    ~PhaseTimer() { stop(); }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    void stop();
+
+private:
+    FrameProfiler& profiler;
+    FramePhase phase;
+    std::uint64_t startNs;
+    bool running;
+};
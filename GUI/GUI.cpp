@@ -8,17 +8,15 @@
 #include "../Players/Roles/Merchant.hpp"
 #include "../Players/Roles/Spy.hpp"
 #include "../GameLogic/Logger.hpp"
+#include "../GameLogic/Tracer.hpp"
+#include "../Simulation/Simulator.hpp"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 #include <random>
 #include <codecvt>
 #include <locale>
 
-// הפונקציה שמחזירה שחקן רנדומלי
-namespace coup {
-    extern Player* randomPlayer(Game& game, const std::string& name);
-}
-
 // Button implementation
 Button::Button(float x, float y, float width, float height,
                const sf::Font& font, const std::string& label,
@@ -40,9 +38,9 @@ Button::Button(float x, float y, float width, float height,
                      y + (height - textBounds.height) / 2 - textBounds.top);
 }
 
-void Button::draw(sf::RenderWindow& window) {
-    window.draw(shape);
-    window.draw(text);
+void Button::draw(UiBatch& batch) {
+    batch.add(shape);
+    batch.add(text);
 }
 
 bool Button::isClicked(sf::Vector2i mousePos) {
@@ -92,7 +90,8 @@ void Button::setLabel(const std::string& newLabel) {
 
 // PlayerCard implementation
 PlayerCard::PlayerCard(coup::Player* player, const sf::Font& font)
-: player(player) {
+: player(player), initialized(false), shownCoins(0), shownSanctioned(false),
+  shownArrestStatus(coup::ArrestStatus::Available), shownArrestBlocked(false) {
     background.setSize({250.f, 120.f});
     background.setFillColor(sf::Color(60, 60, 60, 200));
     background.setOutlineThickness(2);
@@ -117,38 +116,63 @@ PlayerCard::PlayerCard(coup::Player* player, const sf::Font& font)
     update();
 }
 
-void PlayerCard::update() {
-    if (!player) return;
+bool PlayerCard::update() {
+    if (!player) return false;
 
-    nameText.setString(player->getName());
-    roleText.setString("Role: " + player->getRoleName());
-    coinsText.setString("Coins: " + std::to_string(player->getCoins()));
+    int coins = player->getCoins();
+    bool sanctioned = player->isSanctioned();
+    coup::ArrestStatus arrestStatus = player->getArrestStatus();
+    bool arrestBlocked = player->isArrestBlocked();
 
-    std::string status;
-    if (player->isSanctioned()) {
-        status += "[SANCTIONED]";
+    bool coinsDirty = !initialized || coins != shownCoins;
+    bool statusDirty = !initialized || sanctioned != shownSanctioned ||
+                       arrestStatus != shownArrestStatus || arrestBlocked != shownArrestBlocked;
+    if (!coinsDirty && !statusDirty) {
+        return false;
     }
 
-    // Add arrest status
-    coup::ArrestStatus arrestStatus = player->getArrestStatus();
-    if (arrestStatus == coup::ArrestStatus::ArrestedNow) {
-        if (!status.empty()) status += " ";
-        status += "[ARRESTED]";
-    } else if (arrestStatus == coup::ArrestStatus::Cooldown) {
-        if (!status.empty()) status += " ";
-        status += "[COOLDOWN]";
+    if (!initialized) {
+        // Name and role never change for a card's player
+        nameText.setString(player->getName());
+        roleText.setString("Role: " + player->getRoleName());
+    }
+    if (coinsDirty) {
+        coinsText.setString("Coins: " + std::to_string(coins));
     }
 
-    // Add arrest blocked status
-    if (player->isArrestBlocked()) {
-        if (!status.empty()) status += " ";
-        status += "[ARREST BLOCKED]";
+    if (statusDirty) {
+        std::string status;
+        if (sanctioned) {
+            status += "[SANCTIONED]";
+        }
+
+        // Add arrest status
+        if (arrestStatus == coup::ArrestStatus::ArrestedNow) {
+            if (!status.empty()) status += " ";
+            status += "[ARRESTED]";
+        } else if (arrestStatus == coup::ArrestStatus::Cooldown) {
+            if (!status.empty()) status += " ";
+            status += "[COOLDOWN]";
+        }
+
+        // Add arrest blocked status
+        if (arrestBlocked) {
+            if (!status.empty()) status += " ";
+            status += "[ARREST BLOCKED]";
+        }
+
+        statusText.setString(status);
     }
 
-    statusText.setString(status);
+    initialized = true;
+    shownCoins = coins;
+    shownSanctioned = sanctioned;
+    shownArrestStatus = arrestStatus;
+    shownArrestBlocked = arrestBlocked;
+    return true;
 }
 
-void PlayerCard::draw(sf::RenderWindow& window, bool isCurrentPlayer) {
+void PlayerCard::draw(UiBatch& batch, bool isCurrentPlayer) {
     if (isCurrentPlayer) {
         background.setFillColor(sf::Color(90, 90, 120, 220));
         background.setOutlineColor(sf::Color::Yellow);
@@ -157,12 +181,12 @@ void PlayerCard::draw(sf::RenderWindow& window, bool isCurrentPlayer) {
         background.setOutlineColor(sf::Color::White);
     }
 
-    window.draw(background);
-    window.draw(nameText);
-    window.draw(roleText);
-    window.draw(coinsText);
+    batch.add(background);
+    batch.add(nameText);
+    batch.add(roleText);
+    batch.add(coinsText);
     if (!statusText.getString().isEmpty()) {
-        window.draw(statusText);
+        batch.add(statusText);
     }
 }
 
@@ -223,11 +247,12 @@ void PopupMessage::update(float dt) {
     }
 }
 
-void PopupMessage::draw(sf::RenderWindow& window) {
+void PopupMessage::draw(UiBatch& batch) {
     if (!isActive) return;
+    batch.beginLayer();  // cover everything drawn so far
 
     // Center the popup on the screen
-    sf::Vector2f center = sf::Vector2f(window.getSize()) / 2.0f;
+    sf::Vector2f center = sf::Vector2f(batch.getTargetSize()) / 2.0f;
     background.setPosition(center.x - 300.f, center.y - 75.f);
 
     sf::Vector2f bgPos = background.getPosition();
@@ -238,9 +263,9 @@ void PopupMessage::draw(sf::RenderWindow& window) {
 
     okButton->setPosition(bgPos.x + 260.f, bgPos.y + 90.f);
 
-    window.draw(background);
-    window.draw(messageText);
-    okButton->draw(window);
+    batch.add(background);
+    batch.add(messageText);
+    okButton->draw(batch);
 }
 
 bool PopupMessage::handleClick(sf::Vector2i mousePos) {
@@ -311,25 +336,26 @@ void BlockActionPopup::show(coup::Player* blocker, coup::Player* actor,
     messageText.setString(msg);
 
     yesButton->onClick = [this]() {
+        this->isActive = false;
         if (this->callback) {
             this->callback(true);
         }
-        this->isActive = false;
     };
 
     noButton->onClick = [this]() {
+        this->isActive = false;
         if (this->callback) {
             this->callback(false);
         }
-        this->isActive = false;
     };
 }
 
-void BlockActionPopup::draw(sf::RenderWindow& window) {
+void BlockActionPopup::draw(UiBatch& batch) {
     if (!isActive) return;
+    batch.beginLayer();  // cover everything drawn so far
 
     // Center the popup on the screen
-    sf::Vector2f center = sf::Vector2f(window.getSize()) / 2.0f;
+    sf::Vector2f center = sf::Vector2f(batch.getTargetSize()) / 2.0f;
     background.setPosition(center.x - 350.f, center.y - 100.f);
 
     sf::Vector2f bgPos = background.getPosition();
@@ -347,11 +373,11 @@ void BlockActionPopup::draw(sf::RenderWindow& window) {
     yesButton->setPosition(bgPos.x + 200.f, bgPos.y + 130.f);
     noButton->setPosition(bgPos.x + 380.f, bgPos.y + 130.f);
 
-    window.draw(background);
-    window.draw(titleText);
-    window.draw(messageText);
-    yesButton->draw(window);
-    noButton->draw(window);
+    batch.add(background);
+    batch.add(titleText);
+    batch.add(messageText);
+    yesButton->draw(batch);
+    noButton->draw(batch);
 }
 
 bool BlockActionPopup::handleClick(sf::Vector2i mousePos) {
@@ -418,14 +444,14 @@ void SpyAbilitiesPanel::setPosition(float x, float y) {
     closeButton->setPosition(x + 10.f, y + 140.f);
 }
 
-void SpyAbilitiesPanel::draw(sf::RenderWindow& window) {
+void SpyAbilitiesPanel::draw(UiBatch& batch) {
     if (!isVisible) return;
 
-    window.draw(background);
-    window.draw(titleText);
-    viewCoinsButton->draw(window);
-    blockArrestButton->draw(window);
-    closeButton->draw(window);
+    batch.add(background);
+    batch.add(titleText);
+    viewCoinsButton->draw(batch);
+    blockArrestButton->draw(batch);
+    closeButton->draw(batch);
 }
 
 bool SpyAbilitiesPanel::handleClick(sf::Vector2i mousePos) {
@@ -451,22 +477,40 @@ bool SpyAbilitiesPanel::handleClick(sf::Vector2i mousePos) {
 
 // GUI implementation
 GUI::GUI()
-: currentState(State::MainMenu),
+: currentState(State::Loading),
   actionState(ActionState::None),
   pendingAction(coup::ActionType::None),
   startedCurrentTurn(false),
   lastPlayerName(""),
+  playerCardsDirty(false),
+  turnDirty(false),
+  needsRedraw(true),
   window(sf::VideoMode(1280, 720), "Coup Game"),
+  batch(window),
+  splashTime(0.0f),
   game(nullptr),
   playerCount(0),
   currentNameIndex(0),
   inputFocus(true),
   hasPerformedAction(false),
   messageTimer(0.0f),
+  replaySeed(0),
+  replayDragging(false),
+  replayPlaying(false),
+  replayClock(0.0f),
+  replayLogging(true),
+  lastSeekMicros(0),
   cachedWinnerName("") {  // הוספת האיתחול החדש
     window.setFramerateLimit(60);
     playerNames.clear();
-    loadAssets();
+
+    // Fonts and backgrounds are decoded off the render thread; the splash
+    // screen runs until finishLoading() uploads them
+    assetLoader.start();
+}
+
+void GUI::finishLoading() {
+    loadAssets(assetLoader.result());
     setupMainMenu();
 
     popup = std::make_unique<PopupMessage>(font);
@@ -475,6 +519,17 @@ GUI::GUI()
 
     // Position the spy panel
     spyPanel->setPosition(1050.f, 200.f);
+
+    currentState = State::MainMenu;
+    needsRedraw = true;
+
+    if (!replayPath.empty()) {
+        try {
+            openReplay(coup::GameRecording::load(replayPath));
+        } catch (const std::exception& e) {
+            showErrorPopup(e.what());
+        }
+    }
 }
 
 GUI::~GUI() {
@@ -495,6 +550,27 @@ GUI::~GUI() {
     }
 }
 
+void GUI::onGameEvent(coup::Game& /* changed */, const coup::GameEvent& event) {
+    needsRedraw = true;
+    switch (event.type) {
+        case coup::GameEventType::TurnAdvanced:
+        case coup::GameEventType::GameOver:
+            turnDirty = true;
+            break;
+        case coup::GameEventType::PlayerEliminated:
+            turnDirty = true;
+            playerCardsDirty = true;
+            break;
+        case coup::GameEventType::PendingActionSet:
+        case coup::GameEventType::PendingActionResolved:
+            break;
+        default:
+            // Joins, coins, sanctions and arrest flags are all shown on the cards
+            playerCardsDirty = true;
+            break;
+    }
+}
+
 void GUI::showMessage(const std::string& msg) {
     messageText.setFillColor(sf::Color::White);
     messageText.setString(msg);
@@ -513,181 +589,99 @@ bool GUI::hasUsedBribe(coup::Player* player) const {
     return player && player->getLastAction() == coup::ActionType::Bribe;
 }
 
+// F9 starts a fresh trace; pressing it again writes it (COUP_TRACE or coup_trace.json)
+void GUI::toggleTracing() {
+    if (!coup::Tracer::isEnabled()) {
+        coup::Tracer::clear();
+        coup::Tracer::setEnabled(true);
+        showMessage("Tracing started (F9 to save)");
+        return;
+    }
+    coup::Tracer::setEnabled(false);
+    std::string path = coup::Tracer::environmentPath();
+    if (path.empty()) {
+        path = "coup_trace.json";
+    }
+    try {
+        coup::Tracer::writeChromeTrace(path);
+        showMessage("Trace written to " + path);
+    } catch (const std::exception& e) {
+        showErrorPopup(e.what());
+    }
+}
+
 void GUI::updateButtons() {
     // Buttons are recreated in each draw function
 }
 
-bool GUI::checkForBlockers(coup::Player* actor, coup::ActionType action, coup::Player* /* target */) {
-    if (!game || !actor) return false;
+std::vector<coup::Player*> GUI::findBlockers(coup::Player* actor, coup::ActionType action) {
+    std::vector<coup::Player*> blockers;
+    if (!game || !actor) return blockers;
 
-    // Handle blocking for different actions
-    if (action == coup::ActionType::Bribe) {
-        // Check for Judge who can block bribe
-        for (auto* p : game->getAllAlivePlayers()) {
-            if (p && p->getRoleName() == "Judge" && p != actor) {
-                bool shouldBlock = false;
-                bool decided = false;
-                
-                actionState = ActionState::WaitingForBlock;
-                
-                blockPopup->show(p, actor, action, nullptr, [this, &shouldBlock, &decided](bool block) {
-                    shouldBlock = block;
-                    decided = true;
-                });
-                
-                // Wait for response
-                while (!decided && window.isOpen()) {
-                    sf::Event event;
-                    while (window.pollEvent(event)) {
-                        if (event.type == sf::Event::Closed) {
-                            window.close();
-                            return false;
-                        }
-                        else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                            sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                            blockPopup->handleClick(mousePos);
-                        }
-                    }
-                    
-                    // Update and render
-                    window.clear(sf::Color::Black);
-                    window.draw(backgroundSprite);
-                    
-                    for (auto& card : playerCards) {
-                        bool isCurrentPlayer = (card.getPlayer() == actor);
-                        card.draw(window, isCurrentPlayer);
-                    }
-                    
-                    blockPopup->draw(window);
-                    window.display();
-                }
-                
-                actionState = ActionState::None;
-                
-                if (shouldBlock) {
-                    showMessage(p->getName() + " (Judge) blocked " + actor->getName() + "'s bribe!");
-                    return true;
-                }
-                
-                break; // Only one Judge can block
-            }
+    // Judges may block a bribe, Governors may block tax
+    const char* role = action == coup::ActionType::Bribe ? "Judge"
+                     : action == coup::ActionType::Tax ? "Governor" : nullptr;
+    if (!role) return blockers;
+
+    for (auto* p : game->alivePlayers()) {
+        if (p && p != actor && p->getRoleName() == role) {
+            blockers.push_back(p);
         }
     }
-    else if (action == coup::ActionType::Tax) {
-        // Check for Governor who can block tax
-        for (auto* p : game->getAllAlivePlayers()) {
-            if (p && p->getRoleName() == "Governor" && p != actor) {
-                bool shouldBlock = false;
-                bool decided = false;
-                
-                actionState = ActionState::WaitingForBlock;
-                
-                blockPopup->show(p, actor, action, nullptr, [this, &shouldBlock, &decided](bool block) {
-                    shouldBlock = block;
-                    decided = true;
-                });
-                
-                // Wait for response
-                while (!decided && window.isOpen()) {
-                    sf::Event event;
-                    while (window.pollEvent(event)) {
-                        if (event.type == sf::Event::Closed) {
-                            window.close();
-                            return false;
-                        }
-                        else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                            sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                            blockPopup->handleClick(mousePos);
-                        }
-                    }
-                    
-                    // Update and render
-                    window.clear(sf::Color::Black);
-                    window.draw(backgroundSprite);
-                    
-                    for (auto& card : playerCards) {
-                        bool isCurrentPlayer = (card.getPlayer() == actor);
-                        card.draw(window, isCurrentPlayer);
-                    }
-                    
-                    blockPopup->draw(window);
-                    window.display();
-                }
-                
-                actionState = ActionState::None;
-                
-                if (shouldBlock) {
-                    showMessage(p->getName() + " (Governor) blocked " + actor->getName() + "'s tax collection!");
-                    return true;
-                }
-                
-                break; // Only one Governor can block
-            }
-        }
+    return blockers;
+}
+
+void GUI::requestBlockDecisions(coup::Player* actor, coup::ActionType action, coup::Player* target,
+                                std::function<void()> onAllowed) {
+    std::vector<coup::Player*> blockers = findBlockers(actor, action);
+    if (blockers.empty()) {
+        onAllowed();
+        return;
     }
 
-    return false;
+    // Each blocker is asked in turn from update(); the action runs only if all allow it
+    pendingBlock.actor = actor;
+    pendingBlock.action = action;
+    pendingBlock.target = target;
+    pendingBlock.blockers.assign(blockers.begin(), blockers.end());
+    pendingBlock.onAllowed = std::move(onAllowed);
+    pendingBlock.answer = BlockAnswer::Waiting;
+    actionState = ActionState::WaitingForBlock;
+    askNextBlocker();
 }
 
-coup::Player* GUI::findPotentialBlocker(coup::ActionType action) {
-    if (!game) return nullptr;
-    
-    if (action == coup::ActionType::Bribe) {
-        for (auto* p : game->getAllAlivePlayers()) {
-            if (p && p->getRoleName() == "Judge") {
-                return p;
-            }
-        }
-    }
-    else if (action == coup::ActionType::Tax) {
-        for (auto* p : game->getAllAlivePlayers()) {
-            if (p && p->getRoleName() == "Governor") {
-                return p;
-            }
-        }
-    }
-    
-    return nullptr;
+void GUI::askNextBlocker() {
+    pendingBlock.answer = BlockAnswer::Waiting;
+    blockPopup->show(pendingBlock.blockers.front(), pendingBlock.actor, pendingBlock.action, pendingBlock.target,
+                     [this](bool block) {
+                         pendingBlock.answer = block ? BlockAnswer::Block : BlockAnswer::Allow;
+                     });
 }
 
-bool GUI::showYesNoPopup(const std::string& message) {
-    bool result = false;
-    bool decided = false;
+void GUI::resolveBlockDecision() {
+    coup::Player* blocker = pendingBlock.blockers.front();
+    pendingBlock.blockers.pop_front();
 
-    blockPopup->isActive = true;
-    blockPopup->messageText.setString(message);
-    
-    blockPopup->yesButton->onClick = [&decided, &result]() {
-        result = true;
-        decided = true;
-    };
-    
-    blockPopup->noButton->onClick = [&decided, &result]() {
-        result = false;
-        decided = true;
-    };
-    
-    while (!decided && window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-                return false;
-            }
-            else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                blockPopup->handleClick(mousePos);
-            }
-        }
-        
-        window.clear(sf::Color::Black);
-        window.draw(backgroundSprite);
-        blockPopup->draw(window);
-        window.display();
+    if (pendingBlock.answer == BlockAnswer::Block) {
+        std::string what = pendingBlock.action == coup::ActionType::Bribe ? "'s bribe!" : "'s tax collection!";
+        showMessage(blocker->getName() + " (" + blocker->getRoleName() + ") blocked " +
+                    pendingBlock.actor->getName() + what);
+        pendingBlock = PendingBlock();
+        actionState = ActionState::None;
+        refreshActionButtons();
+        return;
     }
-    
-    blockPopup->isActive = false;
-    return result;
+
+    if (!pendingBlock.blockers.empty()) {
+        askNextBlocker();
+        return;
+    }
+
+    // Nobody blocked: continue with the action
+    std::function<void()> onAllowed = std::move(pendingBlock.onAllowed);
+    pendingBlock = PendingBlock();
+    actionState = ActionState::None;
+    onAllowed();
 }
 
 std::string GUI::sanitizeInput(const std::string& input) {
@@ -741,62 +735,16 @@ void GUI::updateArrestBlocks() {
     }
 }
 
-void GUI::loadAssets() {
-    // כאן התיקון: הסרת המשתנה שלא משמש fontLoaded
-    if (font.loadFromFile("GUI/fonts/ARIAL.TTF")) {
-        // יש הטענה מוצלחת
-    } else if (font.loadFromFile("./GUI/fonts/ARIAL.TTF")) {
-        // יש הטענה מוצלחת
-    } else if (font.loadFromFile("Arial.ttf")) {
-        // יש הטענה מוצלחת
-    } else {
-        // If we couldn't load the font, try to load any system font
-        std::cerr << "Failed to load font, using system font\n";
-        
-        // Try common fonts on different systems
-        if (font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf")) {
-            // יש הטענה מוצלחת
-        } else if (font.loadFromFile("C:\\Windows\\Fonts\\arial.ttf")) {
-            // יש הטענה מוצלחת
-        } else {
-            std::cerr << "Could not load any font, using default\n";
-            // If we couldn't load a font, use SFML's default
-        }
+void GUI::loadAssets(AssetBundle& assets) {
+    // Runs on the render thread: textures are uploaded here, decoding happened in AssetLoader
+    fontData.swap(assets.fontData);
+    if (fontData.empty() || !font.loadFromMemory(fontData.data(), fontData.size())) {
+        std::cerr << "Could not load any font, using default\n";
     }
 
-    if (!menuBackgroundTexture.loadFromFile("GUI/images/background_menu.png")) {
-        std::cerr << "Failed to load menu background! Using fallback.\n";
-        menuBackgroundTexture.create(1280, 720);
-        sf::Uint8* pixels = new sf::Uint8[1280 * 720 * 4];
-        for (int i = 0; i < 1280 * 720; ++i) {
-            pixels[i*4] = 30;
-            pixels[i*4+1] = 30;
-            pixels[i*4+2] = 50;
-            pixels[i*4+3] = 255;
-        }
-        menuBackgroundTexture.update(pixels);
-        delete[] pixels;
-    }
-    
-    if (!gameBackgroundTexture.loadFromFile("GUI/images/game_background.png")) {
-        std::cerr << "Failed to load game background! Using fallback.\n";
-        gameBackgroundTexture.create(1280, 720);
-        sf::Uint8* pixels = new sf::Uint8[1280 * 720 * 4];
-        for (int i = 0; i < 1280 * 720; ++i) {
-            pixels[i*4] = 20;
-            pixels[i*4+1] = 40;
-            pixels[i*4+2] = 40;
-            pixels[i*4+3] = 255;
-        }
-        gameBackgroundTexture.update(pixels);
-        delete[] pixels;
-    }
-    
-    // Properly load and use winner background
-    if (!winnerBackgroundTexture.loadFromFile("GUI/images/winner_bg.png")) {
-        std::cerr << "Failed to load winner background! Using fallback.\n";
-        winnerBackgroundTexture = gameBackgroundTexture;
-    }
+    menuBackgroundTexture.loadFromImage(assets.menuBackground);
+    gameBackgroundTexture.loadFromImage(assets.gameBackground);
+    winnerBackgroundTexture.loadFromImage(assets.winnerBackground);
 
     backgroundSprite.setScale(
         1280.0f / std::max(menuBackgroundTexture.getSize().x, 1u),
@@ -815,6 +763,15 @@ void GUI::loadAssets() {
     playerNamesText.setFont(font);
     playerNamesText.setCharacterSize(18);
     playerNamesText.setFillColor(sf::Color::White);
+
+    specialHeader.setFont(font);
+    specialHeader.setString("Special Abilities:");
+    specialHeader.setCharacterSize(16);
+    specialHeader.setFillColor(sf::Color::Cyan);
+    specialHeader.setPosition(1050.f, 170.f);
+
+    // Every size the widgets and the profiler overlay use, so no glyph is rasterised mid-game
+    UiBatch::warmUp(font, {13, 14, 16, 18, 20, 22, 24, 36, 64});
 }
 
 void GUI::setupMainMenu() {
@@ -828,7 +785,26 @@ void GUI::setupMainMenu() {
         showMessage("Select number of players (2-6)");
     });
 
-    buttons.emplace_back(540, 560, 200, 50, font, "Exit", [this]() {
+    buttons.emplace_back(540, 560, 200, 50, font, "Watch Replay", [this]() {
+        // A fresh bot game: six seats, seeded from the system so every replay differs
+        std::random_device entropy;
+        std::uint64_t seed = (static_cast<std::uint64_t>(entropy()) << 32) | entropy();
+        coup::GameRecording recording;
+        bool logging = coup::Logger::isEnabled();
+        coup::Logger::setEnabled(false);
+        try {
+            coup::Simulator::runGame(seed, coup::Game::MAX_PLAYERS, coup::Simulator::DEFAULT_MAX_TURNS, nullptr,
+                                     &recording);
+        } catch (const std::exception& e) {
+            coup::Logger::setEnabled(logging);
+            showErrorPopup("Failed to simulate a game: " + std::string(e.what()));
+            return;
+        }
+        coup::Logger::setEnabled(logging);
+        openReplay(recording);
+    });
+
+    buttons.emplace_back(540, 620, 200, 50, font, "Exit", [this]() {
         window.close();
     });
 }
@@ -837,20 +813,69 @@ void GUI::run() {
     sf::Clock clock;
     while (window.isOpen()) {
         sf::Event event;
+
+        // Idle: nothing animating and nothing changed, so sleep until input
+        if (!needsRedraw && !isAnimating()) {
+            if (!window.waitEvent(event)) {
+                continue;
+            }
+            dispatchEvent(event);
+            if (!window.isOpen()) {
+                return;  // closed (window button or Exit) - do not render another frame
+            }
+            clock.restart();  // time spent waiting is not animation time
+        }
+
+        profiler.beginFrame();
+        window.resetDrawCalls();
+
+        PhaseTimer eventsTimer(profiler, FramePhase::Events);
         while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-            else
-                handleEvent(event);
+            dispatchEvent(event);
+            if (!window.isOpen()) {
+                return;
+            }
         }
+        eventsTimer.stop();
 
+        // Cleared before update/render so changes they cause schedule another frame
+        needsRedraw = false;
         float dt = clock.restart().asSeconds();
-        update(dt);
+        {
+            PhaseTimer updateTimer(profiler, FramePhase::Update);
+            update(dt);
+        }
         render();
+        profiler.endFrame();
     }
 }
 
+void GUI::dispatchEvent(const sf::Event& event) {
+    if (event.type == sf::Event::Closed) {
+        window.close();
+        return;
+    }
+    // Nothing in the UI reacts to hovering, so pointer motion alone does not redraw
+    if (event.type != sf::Event::MouseMoved) {
+        needsRedraw = true;
+    }
+    handleEvent(event);
+}
+
+bool GUI::isAnimating() const {
+    // Timed UI (message fade, popup auto-dismiss, splash) and the live profiler need every frame
+    return currentState == State::Loading || messageTimer > 0.0f || (popup && popup->isActive) ||
+           profiler.isVisible() || replayPlaying;
+}
+
 void GUI::handleEvent(const sf::Event& event) {
+    if (currentState == State::Loading) {
+        return;  // nothing to interact with yet
+    }
+    if (currentState == State::Replay) {
+        handleReplayEvent(event);
+        return;
+    }
     if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
         sf::Vector2i mousePos = sf::Mouse::getPosition(window);
         
@@ -863,6 +888,11 @@ void GUI::handleEvent(const sf::Event& event) {
         if (blockPopup->isActive && blockPopup->handleClick(mousePos)) {
             return;
         }
+
+        // A block decision is modal: nothing else reacts until it is answered
+        if (actionState == ActionState::WaitingForBlock) {
+            return;
+        }
         
         // Handle spy panel
         if (spyPanel->isVisible && spyPanel->handleClick(mousePos)) {
@@ -936,6 +966,12 @@ void GUI::handleEvent(const sf::Event& event) {
             refreshActionButtons();
         }
     } 
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9) {
+        toggleTracing();
+    }
+    else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+        profiler.setVisible(!profiler.isVisible());
+    }
     else if (event.type == sf::Event::TextEntered && currentState == State::EnterAllPlayerNames) {
         // Safety checks before handling text input
         if (currentNameIndex < 0 || static_cast<size_t>(currentNameIndex) >= playerNames.size()) {
@@ -1008,6 +1044,14 @@ void GUI::handleEvent(const sf::Event& event) {
 }
 
 void GUI::update(float dt) {
+    coup::TraceSpan span("GUI::update", "gui");
+    if (currentState == State::Loading) {
+        splashTime += dt;
+        if (assetLoader.isReady()) {
+            finishLoading();
+        }
+        return;
+    }
     if (messageTimer > 0.0f) {
         messageTimer -= dt;
         if (messageTimer <= 0.0f) {
@@ -1017,6 +1061,27 @@ void GUI::update(float dt) {
     
     // Update popups
     popup->update(dt);
+
+    // Replay autoplay advances one operation per step, stopping at the end
+    if (currentState == State::Replay && replayPlaying && replay) {
+        replayClock += dt;
+        while (replayPlaying && replayClock >= REPLAY_STEP_SECONDS) {
+            replayClock -= REPLAY_STEP_SECONDS;
+            if (replay->position() < replay->size()) {
+                seekReplay(replay->position() + 1);
+            }
+            if (replay->position() == replay->size()) {
+                replayPlaying = false;
+                setupReplayButtons();
+            }
+        }
+        return;
+    }
+
+    // Continue a blockable action once the current blocker has answered
+    if (actionState == ActionState::WaitingForBlock && pendingBlock.answer != BlockAnswer::Waiting) {
+        resolveBlockDecision();
+    }
     
     // Update arrest blocks
     updateArrestBlocks();
@@ -1024,8 +1089,7 @@ void GUI::update(float dt) {
     // Check for game over condition FIRST - to avoid crashes
     if (game && currentState == State::Playing) {
         try {
-            std::vector<coup::Player*> activePlayers = game->getAllAlivePlayers();
-            if (activePlayers.size() <= 1) {
+            if (game->aliveCount() <= 1) {
                 std::cout << "Game over detected in update - transitioning to GameOver state" << std::endl;
                 currentState = State::GameOver;
                 actionState = ActionState::None;
@@ -1048,13 +1112,14 @@ void GUI::update(float dt) {
         }
     }
     
-    // Update player cards
-    if (currentState == State::Playing && game) {
+    // Update player cards (only after the engine reported a change)
+    if (currentState == State::Playing && game && playerCardsDirty) {
         updatePlayerCards();
     }
     
     // Check for turn change - תיקון בעיית startTurn כפול
-    if (game && currentState == State::Playing) {
+    if (game && currentState == State::Playing && turnDirty) {
+        turnDirty = false;
         try {
             std::string currentPlayerName = game->turn();
             
@@ -1086,19 +1151,35 @@ void GUI::update(float dt) {
 }
 
 void GUI::updatePlayerCards() {
+    coup::TraceSpan span("GUI::updatePlayerCards", "gui");
+    PhaseTimer phase(profiler, FramePhase::Cards);
     if (!game) return;
+    playerCardsDirty = false;
     
-    playerCards.clear();
     try {
-        std::vector<coup::Player*> players = game->getAllAlivePlayers();
-        
+        coup::Game::PlayerList players = game->getAlivePlayerList();
+
+        // Cards persist while the same players are alive; only changed texts are re-laid out
+        bool sameTable = players.size() == playerCards.size();
+        for (size_t i = 0; sameTable && i < players.size(); ++i) {
+            sameTable = playerCards[i].getPlayer() == players[i];
+        }
+        if (sameTable) {
+            for (auto& card : playerCards) {
+                card.update();
+            }
+            return;
+        }
+
+        // Someone joined or was eliminated: rebuild the layout
+        playerCards.clear();
+        playerCards.reserve(coup::Game::MAX_PLAYERS);
         for (size_t i = 0; i < players.size(); ++i) {
             if (players[i]) {
-                PlayerCard card(players[i], font);
+                playerCards.emplace_back(players[i], font);
                 float x = 20.f + (i % 3) * 270.f;
                 float y = 80.f + (i / 3) * 140.f;
-                card.setPosition(x, y);
-                playerCards.push_back(card);
+                playerCards.back().setPosition(x, y);
             }
         }
     } catch (const std::exception& e) {
@@ -1107,8 +1188,19 @@ void GUI::updatePlayerCards() {
 }
 
 void GUI::render() {
+    coup::TraceSpan span("GUI::render", "gui");
+    PhaseTimer renderTimer(profiler, FramePhase::Render);
     window.clear(sf::Color::Black);
 
+    if (currentState == State::Loading) {
+        drawSplash();
+        batch.flush();
+        renderTimer.stop();
+        PhaseTimer displayTimer(profiler, FramePhase::Display);
+        window.display();
+        return;
+    }
+
     // Draw background - use right texture for each state
     if (currentState == State::MainMenu) {
         backgroundSprite.setTexture(menuBackgroundTexture);
@@ -1121,6 +1213,8 @@ void GUI::render() {
 
     // Draw appropriate UI for current state
     switch (currentState) {
+        case State::Loading:
+            break;
         case State::MainMenu:
             drawMainMenu();
             break;
@@ -1139,51 +1233,77 @@ void GUI::render() {
         case State::GameOver:
             drawGameOver();
             break;
+        case State::Replay:
+            drawReplay();
+            break;
     }
 
     // Draw buttons
     for (auto& btn : buttons) {
-        btn.draw(window);
+        btn.draw(batch);
     }
     
     // Draw action buttons in playing state
     if (currentState == State::Playing) {
         // עבור מצב משחק פעיל, וודא שתמיד יש כפתורי פעולה
-        if (actionButtons.empty() && game && !game->getAllAlivePlayers().empty()) {
+        if (actionButtons.empty() && game && !game->alivePlayers().empty()) {
             refreshActionButtons();
         }
         
         for (auto& btn : actionButtons) {
-            btn.draw(window);
+            btn.draw(batch);
         }
         
         // Draw special abilities section header if current player is spy
         coup::Player* currentPlayer = getCurrentPlayer();
         if (currentPlayer && currentPlayer->getRoleName() == "Spy") {
-            sf::Text specialHeader("Special Abilities:", font, 16);
-            specialHeader.setFillColor(sf::Color::Cyan);
-            specialHeader.setPosition(1050.f, 170.f);
-            window.draw(specialHeader);
+            batch.add(specialHeader);
             
             // Draw spy panel if visible
-            spyPanel->draw(window);
+            spyPanel->draw(batch);
         }
     }
 
     // Draw message if active
     if (messageTimer > 0.0f) {
-        window.draw(messageText);
+        batch.add(messageText);
     }
     
     // Draw popup
-    popup->draw(window);
+    popup->draw(batch);
     
     // Draw block popup
-    blockPopup->draw(window);
+    blockPopup->draw(batch);
+
+    batch.flush();
+
+    // Frame-time overlay (F3) is drawn last and not counted in the frame's draw calls
+    profiler.setDrawCalls(window.getDrawCalls());
+    profiler.draw(window, font);
+    renderTimer.stop();
 
+    PhaseTimer displayTimer(profiler, FramePhase::Display);
     window.display();
 }
 
+void GUI::drawSplash() {
+    // Shapes only: the font is one of the assets still loading
+    sf::Vector2f size(batch.getTargetSize());
+    sf::RectangleShape track({400.f, 12.f});
+    track.setPosition((size.x - 400.f) / 2, size.y / 2);
+    track.setFillColor(sf::Color(40, 40, 60));
+    track.setOutlineThickness(2);
+    track.setOutlineColor(sf::Color(120, 120, 160));
+    batch.add(track);
+
+    // Indeterminate progress: a block sweeping across the track
+    float phase = splashTime - static_cast<int>(splashTime);
+    sf::RectangleShape sweep({100.f, 12.f});
+    sweep.setPosition(track.getPosition().x + phase * 300.f, track.getPosition().y);
+    sweep.setFillColor(sf::Color(200, 200, 255));
+    batch.add(sweep);
+}
+
 void GUI::drawMainMenu() {
     // No titles, the background image should handle this
 }
@@ -1193,7 +1313,7 @@ void GUI::drawSelectPlayerCount() {
     title.setFillColor(sf::Color::White);
     sf::FloatRect bounds = title.getLocalBounds();
     title.setPosition((window.getSize().x - bounds.width) / 2 - bounds.left, 100);
-    window.draw(title);
+    batch.add(title);
 
     buttons.clear();
     float xStart = 440, yPos = 300, buttonSize = 60, spacing = 80;
@@ -1241,18 +1361,18 @@ void GUI::drawEnterAllPlayerNames() {
     title.setFillColor(sf::Color::White);
     sf::FloatRect bounds = title.getLocalBounds();
     title.setPosition((window.getSize().x - bounds.width) / 2 - bounds.left, 100);
-    window.draw(title);
+    batch.add(title);
 
     // Player list
     playerNamesText.setPosition(500.f, 180.f);
-    window.draw(playerNamesText);
+    batch.add(playerNamesText);
 
     // Current prompt
     sf::Text prompt("Enter Player " + std::to_string(currentNameIndex + 1) + " Name:", font, 24);
     prompt.setFillColor(sf::Color::Yellow);
     bounds = prompt.getLocalBounds();
     prompt.setPosition((window.getSize().x - bounds.width) / 2 - bounds.left, 400);
-    window.draw(prompt);
+    batch.add(prompt);
     
     // Input box
     sf::RectangleShape inputBox(sf::Vector2f(400.f, 40.f));
@@ -1260,10 +1380,10 @@ void GUI::drawEnterAllPlayerNames() {
     inputBox.setFillColor(sf::Color(60, 60, 60));
     inputBox.setOutlineThickness(2);
     inputBox.setOutlineColor(sf::Color::White);
-    window.draw(inputBox);
+    batch.add(inputBox);
 
     inputText.setPosition(450.f, 455.f);
-    window.draw(inputText);
+    batch.add(inputText);
 
     buttons.clear();
     
@@ -1334,13 +1454,13 @@ void GUI::drawPlaying() {
         gameInfo.setPosition(20.f, 20.f);
         std::string infoStr = "Current Turn: " + game->turn() + "    Bank: " + std::to_string(game->getBankCoins()) + " coins";
         gameInfo.setString(infoStr);
-        window.draw(gameInfo);
+        batch.add(gameInfo);
         
         // Draw player cards
         coup::Player* currentPlayer = getCurrentPlayer();
         for (auto& card : playerCards) {
             bool isCurrentPlayer = (card.getPlayer() == currentPlayer);
-            card.draw(window, isCurrentPlayer);
+            card.draw(batch, isCurrentPlayer);
         }
         
         // Overlay message if selecting target
@@ -1349,7 +1469,7 @@ void GUI::drawPlaying() {
             targetMsg.setFillColor(sf::Color::Yellow);
             sf::FloatRect bounds = targetMsg.getLocalBounds();
             targetMsg.setPosition((window.getSize().x - bounds.width) / 2, 500);
-            window.draw(targetMsg);
+            batch.add(targetMsg);
             
             // Cancel button
             buttons.clear();
@@ -1394,7 +1514,7 @@ void GUI::drawGameOver() {
     title.setFillColor(sf::Color::White);
     sf::FloatRect bounds = title.getLocalBounds();
     title.setPosition((window.getSize().x - bounds.width) / 2 - bounds.left, 150);
-    window.draw(title);
+    batch.add(title);
 
     // Use cached winner name instead of repeatedly querying the game
     std::string winnerName = cachedWinnerName.empty() ? "Unknown" : cachedWinnerName;
@@ -1403,7 +1523,7 @@ void GUI::drawGameOver() {
     winnerText.setFillColor(sf::Color::Yellow);
     bounds = winnerText.getLocalBounds();
     winnerText.setPosition((window.getSize().x - bounds.width) / 2 - bounds.left, 250);
-    window.draw(winnerText);
+    batch.add(winnerText);
 
     buttons.emplace_back(540, 400, 200, 50, font, "Play Again", [this]() {
         // ניקוי משאבים לפני חזרה לתפריט הראשי
@@ -1442,11 +1562,12 @@ void GUI::startGame() {
         // Create new game instance
         game = new coup::Game();
         game->setConsoleMode(false);
+        game->subscribe(this);
+        playerCardsDirty = true;
+        turnDirty = true;
         
-        // Create random players with given names
-        for (int i = 0; i < playerCount; ++i) {
-            coup::randomPlayer(*game, playerNames[i]);
-        }
+        // Create all players at once with a balanced random role draw
+        game->setup(std::vector<std::string>(playerNames.begin(), playerNames.begin() + playerCount));
         
         // Initialize variables
         currentState = State::Playing;
@@ -1474,7 +1595,7 @@ coup::Player* GUI::getCurrentPlayer() {
     
     try {
         std::string currentName = game->turn();
-        for (auto* p : game->getAllAlivePlayers()) {
+        for (auto* p : game->alivePlayers()) {
             if (p && p->getName() == currentName) {
                 return p;
             }
@@ -1491,7 +1612,7 @@ std::vector<coup::Player*> GUI::getValidTargets(coup::Player* current, coup::Act
     if (!current || !game) return validTargets;
     
     try {
-        for (auto* p : game->getAllAlivePlayers()) {
+        for (auto* p : game->alivePlayers()) {
             if (p && p != current) {
                 // Filter targets based on action type
                 if (action == coup::ActionType::Arrest) {
@@ -1524,6 +1645,8 @@ std::vector<coup::Player*> GUI::getValidTargets(coup::Player* current, coup::Act
 }
 
 void GUI::refreshActionButtons() {
+    coup::TraceSpan span("GUI::refreshActionButtons", "gui");
+    PhaseTimer phase(profiler, FramePhase::Layout);
     actionButtons.clear();
     coup::Player* currentPlayer = getCurrentPlayer();
     
@@ -1557,6 +1680,7 @@ void GUI::refreshActionButtons() {
                 hasPerformedAction = false;
                 startedCurrentTurn = false;  // Reset for the next turn
                 lastPlayerName = "";  // Reset to force turn change detection
+                turnDirty = true;
                 actionState = ActionState::None;
                 refreshActionButtons();
                 updatePlayerCards();
@@ -1630,19 +1754,19 @@ void GUI::refreshActionButtons() {
     // Tax button with check for blockers
     actionButtons.emplace_back(startX + buttonWidth + spacing, buttonY, buttonWidth, buttonHeight, font, "Tax", [this, currentPlayer]() {
         try {
-            // Check if there's a player who can block tax
-            if (checkForBlockers(currentPlayer, coup::ActionType::Tax)) {
-                // Tax was blocked, do nothing
-                return;
-            }
-            
-            // If not blocked, proceed with the tax action
-            currentPlayer->tax();
-            showMessage(currentPlayer->getName() + " collected tax");
-            hasPerformedAction = true;
-            actionState = ActionState::WaitingForEndTurn;
-            refreshActionButtons();
-            updatePlayerCards();
+            // Governors may block; the tax is collected once every one of them allows it
+            requestBlockDecisions(currentPlayer, coup::ActionType::Tax, nullptr, [this, currentPlayer]() {
+                try {
+                    currentPlayer->tax();
+                    showMessage(currentPlayer->getName() + " collected tax");
+                    hasPerformedAction = true;
+                    actionState = ActionState::WaitingForEndTurn;
+                    refreshActionButtons();
+                    updatePlayerCards();
+                } catch (const std::exception& e) {
+                    showErrorPopup(e.what());
+                }
+            });
         } catch (const std::exception& e) {
             showErrorPopup(e.what());
         }
@@ -1764,6 +1888,7 @@ void GUI::refreshActionButtons() {
         hasPerformedAction = false;
         startedCurrentTurn = false;  // Reset for next turn
         lastPlayerName = "";  // Reset to force turn change detection
+        turnDirty = true;
         actionState = ActionState::None;
         refreshActionButtons();
         updatePlayerCards();
@@ -1783,13 +1908,22 @@ void GUI::performAction(coup::Player* player, coup::ActionType action, coup::Pla
             return;
         }
         
-        // Check for blockers for actions that can be blocked (bribe, tax)
-        if ((action == coup::ActionType::Bribe || action == coup::ActionType::Tax) && 
-            checkForBlockers(player, action, target)) {
-            // Action was blocked, do nothing
+        // Actions that can be blocked (bribe, tax) wait for the blockers' answers first
+        if (action == coup::ActionType::Bribe || action == coup::ActionType::Tax) {
+            requestBlockDecisions(player, action, target, [this, player, action, target]() {
+                executeAction(player, action, target);
+            });
             return;
         }
-        
+
+        executeAction(player, action, target);
+    } catch (const std::exception& e) {
+        showErrorPopup(e.what());
+    }
+}
+
+void GUI::executeAction(coup::Player* player, coup::ActionType action, coup::Player* target) {
+    try {
         if (action == coup::ActionType::None && player->getRoleName() == "Spy" && target) {
             // Special case for spy abilities
             if (coup::Spy* spy = dynamic_cast<coup::Spy*>(player)) {
@@ -1891,7 +2025,7 @@ void GUI::performAction(coup::Player* player, coup::ActionType action, coup::Pla
                         
                         // בדיקה מיידית של סיום המשחק
                         try {
-                            std::vector<coup::Player*> remainingPlayers = game->getAllAlivePlayers();
+                            coup::Game::PlayerList remainingPlayers = game->getAlivePlayerList();
                             std::cout << "Players remaining after coup: " << remainingPlayers.size() << std::endl;
                             
                             if (remainingPlayers.size() <= 1) {
@@ -1987,4 +2121,246 @@ void GUI::performAction(coup::Player* player, coup::ActionType action, coup::Pla
     } catch (const std::exception& e) {
         showErrorPopup(e.what());
     }
-}
\ No newline at end of file
+}
+namespace {
+    // One line for a recorded operation, e.g. "P3: arrest -> P1"
+    std::string describeOperation(const coup::ReplayEngine& replay, const coup::JournalEntry& entry) {
+        std::string line = replay.seatName(entry.actor) + ": " + coup::journalOpName(entry.op);
+        if (entry.target != coup::JOURNAL_NO_SEAT) {
+            line += " -> " + replay.seatName(entry.target);
+        }
+        return line;
+    }
+}
+
+void GUI::openReplay(const coup::GameRecording& recording) {
+    // The engine logs every replayed operation; seeking would flood the console
+    replayLogging = coup::Logger::isEnabled();
+    coup::Logger::setEnabled(false);
+    try {
+        replay = std::make_unique<coup::ReplayEngine>(recording);
+    } catch (const std::exception& e) {
+        coup::Logger::setEnabled(replayLogging);
+        showErrorPopup("Cannot replay this game: " + std::string(e.what()));
+        return;
+    }
+    replaySeed = recording.seed;
+    replayDragging = false;
+    replayPlaying = false;
+    replayClock = 0.0f;
+
+    timelineTrack.setSize({1200.f, 14.f});
+    timelineTrack.setPosition(40.f, 590.f);
+    timelineTrack.setFillColor(sf::Color(40, 40, 60, 220));
+    timelineTrack.setOutlineThickness(2);
+    timelineTrack.setOutlineColor(sf::Color(120, 120, 160));
+
+    replayTitleText.setFont(font);
+    replayTitleText.setCharacterSize(24);
+    replayTitleText.setFillColor(sf::Color::White);
+    replayTitleText.setPosition(20.f, 20.f);
+
+    replayOperationText.setFont(font);
+    replayOperationText.setCharacterSize(20);
+    replayOperationText.setFillColor(sf::Color::Yellow);
+    replayOperationText.setPosition(40.f, 550.f);
+
+    replayStatusText.setFont(font);
+    replayStatusText.setCharacterSize(14);
+    replayStatusText.setFillColor(sf::Color(200, 200, 200));
+    replayStatusText.setPosition(40.f, 615.f);
+
+    currentState = State::Replay;
+    playerCards.clear();
+    setupReplayButtons();
+    seekReplay(0);
+}
+
+void GUI::closeReplay() {
+    replay.reset();
+    replayPlaying = false;
+    replayDragging = false;
+    playerCards.clear();
+    coup::Logger::setEnabled(replayLogging);
+    currentState = State::MainMenu;
+    setupMainMenu();
+}
+
+void GUI::setupReplayButtons() {
+    buttons.clear();
+    buttons.emplace_back(40, 650, 70, 40, font, "|<", [this]() { seekReplay(0); });
+    buttons.emplace_back(120, 650, 70, 40, font, "<<", [this]() {
+        std::size_t turn = replay->turnAt(replay->position());
+        // From the start of a turn, go to the start of the one before
+        if (turn > 0 && replay->position() > 0 && replay->turnAt(replay->position() - 1) != turn) {
+            --turn;
+        }
+        seekReplay(replay->turnStart(turn));
+    });
+    buttons.emplace_back(200, 650, 70, 40, font, "<", [this]() {
+        if (replay->position() > 0) seekReplay(replay->position() - 1);
+    });
+    buttons.emplace_back(280, 650, 100, 40, font, replayPlaying ? "Pause" : "Play", [this]() {
+        replayPlaying = !replayPlaying && replay->position() < replay->size();
+        replayClock = 0.0f;
+        buttons[3].setLabel(replayPlaying ? "Pause" : "Play");
+    });
+    buttons.emplace_back(390, 650, 70, 40, font, ">", [this]() {
+        if (replay->position() < replay->size()) seekReplay(replay->position() + 1);
+    });
+    buttons.emplace_back(470, 650, 70, 40, font, ">>", [this]() {
+        seekReplay(replay->turnStart(std::min(replay->turnAt(replay->position()) + 1, replay->turnCount())));
+    });
+    buttons.emplace_back(550, 650, 70, 40, font, ">|", [this]() { seekReplay(replay->size()); });
+    buttons.emplace_back(1140, 650, 100, 40, font, "Menu", [this]() { closeReplay(); });
+}
+
+void GUI::seekReplay(std::size_t position) {
+    auto start = std::chrono::steady_clock::now();
+    replay->seek(position);
+    lastSeekMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // A seek that restored a checkpoint replaced the players, so the cards are rebuilt
+    const coup::Game& shown = replay->getGame();
+    std::vector<coup::Player*> alive;
+    for (coup::Player* player : replay->getTable()) {
+        if (shown.isAlive(*player)) {
+            alive.push_back(player);
+        }
+    }
+    bool sameTable = alive.size() == playerCards.size();
+    for (size_t i = 0; sameTable && i < alive.size(); ++i) {
+        sameTable = playerCards[i].getPlayer() == alive[i];
+    }
+    if (sameTable) {
+        for (auto& card : playerCards) {
+            card.update();
+        }
+    } else {
+        playerCards.clear();
+        playerCards.reserve(coup::Game::MAX_PLAYERS);
+        for (size_t i = 0; i < alive.size(); ++i) {
+            playerCards.emplace_back(alive[i], font);
+            playerCards.back().setPosition(20.f + (i % 3) * 270.f, 80.f + (i / 3) * 140.f);
+        }
+    }
+    updateReplayTexts();
+    needsRedraw = true;
+}
+
+void GUI::seekReplayToMouse(int x) {
+    float left = timelineTrack.getPosition().x;
+    float fraction = (static_cast<float>(x) - left) / timelineTrack.getSize().x;
+    fraction = std::max(0.0f, std::min(1.0f, fraction));
+    std::size_t position = static_cast<std::size_t>(fraction * replay->size() + 0.5f);
+    if (position != replay->position()) {
+        seekReplay(position);
+    }
+}
+
+void GUI::updateReplayTexts() {
+    const coup::Game& shown = replay->getGame();
+    std::string title = "Replay (seed " + std::to_string(replaySeed) + ")    Bank: " +
+                        std::to_string(shown.getBankCoins()) + " coins";
+    if (shown.isGameOver()) {
+        title += "    Winner: " + shown.winner();
+    } else {
+        title += "    Turn: " + shown.turn();
+    }
+    replayTitleText.setString(title);
+
+    std::size_t position = replay->position();
+    std::string operation = "Turn " + std::to_string(replay->turnAt(position) + 1) + "/" +
+                            std::to_string(replay->turnCount()) + "    Operation " + std::to_string(position) +
+                            "/" + std::to_string(replay->size());
+    if (position > 0) {
+        operation += "    Last: " + describeOperation(*replay, replay->operationAt(position - 1));
+    }
+    replayOperationText.setString(operation);
+
+    replayStatusText.setString("Seek " + std::to_string(lastSeekMicros) + " us, " +
+                               std::to_string(replay->lastSeekCost()) + " operations replayed (checkpoint every " +
+                               std::to_string(replay->checkpointInterval()) +
+                               ")    Drag the timeline; Left/Right step, Up/Down turn, Space play");
+}
+
+void GUI::handleReplayEvent(const sf::Event& event) {
+    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+        sf::Vector2i mousePos(event.mouseButton.x, event.mouseButton.y);
+        if (popup->isActive && popup->handleClick(mousePos)) {
+            return;
+        }
+        for (size_t i = 0; i < buttons.size(); ++i) {
+            if (buttons[i].isClicked(mousePos)) {
+                if (buttons[i].onClick) buttons[i].onClick();  // may close the viewer
+                return;
+            }
+        }
+        // Generous vertical margin so the thin track is easy to grab
+        sf::FloatRect grab = timelineTrack.getGlobalBounds();
+        grab.top -= 12.f;
+        grab.height += 24.f;
+        if (grab.contains(static_cast<sf::Vector2f>(mousePos))) {
+            replayDragging = true;
+            seekReplayToMouse(mousePos.x);
+        }
+    } else if (event.type == sf::Event::MouseMoved && replayDragging) {
+        seekReplayToMouse(event.mouseMove.x);
+    } else if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
+        replayDragging = false;
+    } else if (event.type == sf::Event::KeyPressed) {
+        // Shortcuts press the transport buttons, in setupReplayButtons() order
+        switch (event.key.code) {
+            case sf::Keyboard::Left: buttons[2].onClick(); break;
+            case sf::Keyboard::Right: buttons[4].onClick(); break;
+            case sf::Keyboard::Up: buttons[5].onClick(); break;
+            case sf::Keyboard::Down: buttons[1].onClick(); break;
+            case sf::Keyboard::Home: buttons[0].onClick(); break;
+            case sf::Keyboard::End: buttons[6].onClick(); break;
+            case sf::Keyboard::Space: buttons[3].onClick(); break;
+            case sf::Keyboard::Escape: closeReplay(); break;
+            case sf::Keyboard::F3: profiler.setVisible(!profiler.isVisible()); break;
+            case sf::Keyboard::F9: toggleTracing(); break;
+            default: break;
+        }
+    }
+}
+
+void GUI::drawReplay() {
+    if (!replay) return;
+
+    batch.add(replayTitleText);
+    coup::Player* mover = replay->getGame().isGameOver() ? nullptr : replay->getGame().getCurrentPlayer();
+    for (auto& card : playerCards) {
+        card.draw(batch, card.getPlayer() == mover);
+    }
+
+    // Timeline: played part filled, a mark per checkpoint, and the thumb at the current operation
+    batch.add(timelineTrack);
+    sf::Vector2f origin = timelineTrack.getPosition();
+    float width = timelineTrack.getSize().x;
+    float fraction = replay->size() ? static_cast<float>(replay->position()) / replay->size() : 1.0f;
+    sf::RectangleShape played({width * fraction, timelineTrack.getSize().y});
+    played.setPosition(origin);
+    played.setFillColor(sf::Color(110, 110, 200, 220));
+    batch.add(played);
+
+    sf::RectangleShape mark({1.f, 6.f});
+    mark.setFillColor(sf::Color(200, 200, 255, 160));
+    std::size_t marks = std::min<std::size_t>(replay->checkpointCount(), 200);  // at most one per 6 px
+    for (std::size_t i = 1; i < marks; ++i) {
+        std::size_t checkpoint = i * replay->checkpointCount() / marks;
+        float x = static_cast<float>(checkpoint * replay->checkpointInterval()) / std::max<std::size_t>(replay->size(), 1);
+        mark.setPosition(origin.x + std::min(x, 1.0f) * width, origin.y + timelineTrack.getSize().y + 3.f);
+        batch.add(mark);
+    }
+
+    sf::RectangleShape thumb({10.f, 30.f});
+    thumb.setPosition(origin.x + width * fraction - 5.f, origin.y - 8.f);
+    thumb.setFillColor(replayDragging ? sf::Color::Cyan : sf::Color::White);
+    batch.add(thumb);
+
+    batch.add(replayOperationText);
+    batch.add(replayStatusText);
+}
@@ -1,13 +1,18 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <deque>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <map>
 #include <string>
 #include "../GameLogic/Game.hpp"
+#include "../GameLogic/Replay.hpp"
 #include "../Players/Player.hpp"
+#include "FrameProfiler.hpp"
+#include "UiBatch.hpp"
+#include "AssetLoader.hpp"
 
 // Button class for GUI elements
 class Button {
@@ -16,7 +21,7 @@ public:
            const sf::Font& font, const std::string& label, 
            std::function<void()> onClick);
     
-    void draw(sf::RenderWindow& window);
+    void draw(UiBatch& batch);
     bool isClicked(sf::Vector2i mousePos);
     void setEnabled(bool enabled);
     void setSelected(bool selected);
@@ -37,8 +42,9 @@ class PlayerCard {
 public:
     PlayerCard(coup::Player* player, const sf::Font& font);
     
-    void update();
-    void draw(sf::RenderWindow& window, bool isCurrentPlayer);
+    // Re-lays out only the texts whose player state changed; returns true if any did
+    bool update();
+    void draw(UiBatch& batch, bool isCurrentPlayer);
     void setPosition(float x, float y);
     sf::FloatRect getBounds() const;
     
@@ -51,6 +57,13 @@ private:
     sf::Text roleText;
     sf::Text coinsText;
     sf::Text statusText;
+
+    // Last state shown, compared on every update (dirty check)
+    bool initialized;
+    int shownCoins;
+    bool shownSanctioned;
+    coup::ArrestStatus shownArrestStatus;
+    bool shownArrestBlocked;
 };
 
 // Message popup
@@ -60,7 +73,7 @@ public:
     
     void show(const std::string& message, bool isError);
     void update(float dt);
-    void draw(sf::RenderWindow& window);
+    void draw(UiBatch& batch);
     bool handleClick(sf::Vector2i mousePos);
     
     bool isActive;
@@ -80,7 +93,7 @@ public:
     void show(coup::Player* blocker, coup::Player* actor, 
               coup::ActionType action, coup::Player* target,
               std::function<void(bool)> callback);
-    void draw(sf::RenderWindow& window);
+    void draw(UiBatch& batch);
     bool handleClick(sf::Vector2i mousePos);
     void hide() { isActive = false; };
     
@@ -105,7 +118,7 @@ public:
     SpyAbilitiesPanel(const sf::Font& font);
     
     void show(std::function<void(bool)> spyActionCallback);
-    void draw(sf::RenderWindow& window);
+    void draw(UiBatch& batch);
     bool handleClick(sf::Vector2i mousePos);
     void setPosition(float x, float y);
     
@@ -121,22 +134,30 @@ private:
 };
 
 // Main GUI class
-class GUI {
+class GUI : public coup::GameObserver {
 public:
     GUI();
     ~GUI();
     
     void run();
+
+    // Open this recording (see coup::GameRecording) in the replay viewer instead of the main menu
+    void setReplayFile(const std::string& path) { replayPath = path; }
+
+    // Engine change events mark what needs refreshing on the next update
+    void onGameEvent(coup::Game& changed, const coup::GameEvent& event) override;
     
 private:
     // Game states
     enum class State {
+        Loading,
         MainMenu,
         SelectPlayerCount,
         EnterAllPlayerNames,
         Playing,
         TargetSelection,
-        GameOver
+        GameOver,
+        Replay
     };
     void cleanupGame();
     std::string cachedWinnerName;
@@ -148,6 +169,18 @@ private:
         WaitingForBlock
     };
     
+    // Blockable action waiting for answers (ActionState::WaitingForBlock)
+    enum class BlockAnswer { Waiting, Allow, Block };
+    struct PendingBlock {
+        coup::Player* actor = nullptr;
+        coup::ActionType action = coup::ActionType::None;
+        coup::Player* target = nullptr;
+        std::deque<coup::Player*> blockers;   // still to be asked, front is on screen
+        std::function<void()> onAllowed;      // continuation when nobody blocks
+        BlockAnswer answer = BlockAnswer::Waiting;
+    };
+    PendingBlock pendingBlock;
+
     // Constants
     const float MESSAGE_DURATION = 3.0f;
     
@@ -157,10 +190,18 @@ private:
     coup::ActionType pendingAction;
     bool startedCurrentTurn;
     std::string lastPlayerName;
+    bool playerCardsDirty;      // a player's coins/status/alive state changed
+    bool turnDirty;             // the current player may have changed
+    bool needsRedraw;           // something visible changed since the last frame
     
     // SFML objects
-    sf::RenderWindow window;
+    ProfiledWindow window;
+    FrameProfiler profiler;
+    UiBatch batch;              // widget shapes and text, drawn once per frame
     sf::Font font;
+    std::vector<char> fontData;   // font file bytes, read by font while it lives
+    AssetLoader assetLoader;
+    float splashTime;
     sf::Texture menuBackgroundTexture;
     sf::Texture gameBackgroundTexture;
     sf::Texture winnerBackgroundTexture;
@@ -168,6 +209,7 @@ private:
     sf::Text messageText;
     sf::Text inputText;
     sf::Text playerNamesText;
+    sf::Text specialHeader;
     
     // Game objects
     coup::Game* game;
@@ -191,24 +233,52 @@ private:
     
     // Tracked game state
     std::map<std::string, int> arrestBlockedPlayers;
+
+    // Replay viewer (State::Replay): a recorded game with a timeline of its operations
+    std::string replayPath;                      // recording to open once assets are loaded
+    std::unique_ptr<coup::ReplayEngine> replay;
+    std::uint64_t replaySeed;
+    bool replayDragging;                         // the timeline thumb follows the mouse
+    bool replayPlaying;                          // advancing one operation per REPLAY_STEP_SECONDS
+    float replayClock;
+    bool replayLogging;                          // Logger state to restore when the viewer closes
+    long long lastSeekMicros;
+    sf::RectangleShape timelineTrack;
+    sf::Text replayTitleText;
+    sf::Text replayOperationText;
+    sf::Text replayStatusText;
+    const float REPLAY_STEP_SECONDS = 0.15f;
     
     // Initialization
-    void loadAssets();
+    void loadAssets(AssetBundle& assets);
+    void finishLoading();
+    void drawSplash();
     void setupMainMenu();
     void startGame();
+    void openReplay(const coup::GameRecording& recording);
+    void closeReplay();
+    void setupReplayButtons();
     
     // Game logic
     void updateButtons();
-    bool checkForBlockers(coup::Player* actor, coup::ActionType action, coup::Player* target = nullptr);
-    coup::Player* findPotentialBlocker(coup::ActionType action);
-    bool showYesNoPopup(const std::string& message);
+    std::vector<coup::Player*> findBlockers(coup::Player* actor, coup::ActionType action);
+    void requestBlockDecisions(coup::Player* actor, coup::ActionType action, coup::Player* target,
+                               std::function<void()> onAllowed);
+    void askNextBlocker();
+    void resolveBlockDecision();
     coup::Player* getCurrentPlayer();
     std::vector<coup::Player*> getValidTargets(coup::Player* current, coup::ActionType action);
     void refreshActionButtons();
     void updatePlayerCards();
+    void seekReplay(std::size_t position);
+    void seekReplayToMouse(int x);
+    void updateReplayTexts();
     
     // Event handling
+    void dispatchEvent(const sf::Event& event);
     void handleEvent(const sf::Event& event);
+    void handleReplayEvent(const sf::Event& event);
+    bool isAnimating() const;
     void update(float dt);
     void render();
     
@@ -219,9 +289,11 @@ private:
     void drawPlaying();
     void drawTargetSelection();
     void drawGameOver();
+    void drawReplay();
     
     // Action handling
     void performAction(coup::Player* player, coup::ActionType action, coup::Player* target = nullptr);
+    void executeAction(coup::Player* player, coup::ActionType action, coup::Player* target);
     bool hasUsedBribe(coup::Player* player) const;
     bool isPlayerArrestBlocked(const std::string& playerName) const;
     void updateArrestBlocks();
@@ -230,6 +302,7 @@ private:
     void showMessage(const std::string& msg);
     void showErrorPopup(const std::string& msg);
     void showInfoPopup(const std::string& msg);
+    void toggleTracing();
     std::string sanitizeInput(const std::string& input);
     bool isValidUtf8(const std::string& str);
 };
\ No newline at end of file
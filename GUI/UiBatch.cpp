@@ -0,0 +1,211 @@
+// Email: nitzanwa@gmail.com
+
+#include "UiBatch.hpp"
+#include "FrameProfiler.hpp"
+
+namespace {
+    void appendQuad(sf::VertexArray& vertices, const sf::Transform& transform,
+                    float left, float top, float right, float bottom, const sf::Color& color) {
+        sf::Vector2f a = transform.transformPoint(left, top);
+        sf::Vector2f b = transform.transformPoint(right, top);
+        sf::Vector2f c = transform.transformPoint(left, bottom);
+        sf::Vector2f d = transform.transformPoint(right, bottom);
+        vertices.append(sf::Vertex(a, color));
+        vertices.append(sf::Vertex(b, color));
+        vertices.append(sf::Vertex(c, color));
+        vertices.append(sf::Vertex(c, color));
+        vertices.append(sf::Vertex(b, color));
+        vertices.append(sf::Vertex(d, color));
+    }
+}
+
+UiBatch::UiBatch(ProfiledWindow& window) : window(window), activeLayers(0), lookupKey{nullptr, 0, false, {}} {}
+
+sf::Vector2u UiBatch::getTargetSize() const {
+    return window.getSize();
+}
+
+UiBatch::Layer& UiBatch::current() {
+    if (activeLayers == 0) {
+        beginLayer();
+    }
+    return layers[activeLayers - 1];
+}
+
+void UiBatch::beginLayer() {
+    if (activeLayers > 0) {
+        const Layer& top = layers[activeLayers - 1];
+        bool empty = top.shapes.getVertexCount() == 0;
+        for (const GlyphPage& page : top.pages) {
+            empty = empty && page.vertices.getVertexCount() == 0;
+        }
+        if (empty) {
+            return;  // nothing to cover yet
+        }
+    }
+    if (activeLayers == layers.size()) {
+        layers.emplace_back();
+        layers.back().shapes.setPrimitiveType(sf::Triangles);
+    }
+    ++activeLayers;
+}
+
+UiBatch::GlyphPage& UiBatch::pageFor(Layer& layer, const sf::Font* font, unsigned int characterSize) {
+    for (GlyphPage& page : layer.pages) {
+        if (page.font == font && page.characterSize == characterSize) {
+            return page;
+        }
+    }
+    layer.pages.push_back(GlyphPage{font, characterSize, sf::VertexArray(sf::Triangles)});
+    return layer.pages.back();
+}
+
+void UiBatch::add(const sf::RectangleShape& shape) {
+    Layer& layer = current();
+    const sf::Transform& transform = shape.getTransform();
+    sf::Vector2f size = shape.getSize();
+    float t = shape.getOutlineThickness();
+
+    if (shape.getFillColor().a > 0) {
+        appendQuad(layer.shapes, transform, 0.f, 0.f, size.x, size.y, shape.getFillColor());
+    }
+    if (t != 0.f && shape.getOutlineColor().a > 0) {
+        // Four bands around the rectangle (outward for positive thickness, like SFML)
+        float outer = t > 0 ? -t : 0.f;
+        float inner = t > 0 ? 0.f : -t;
+        const sf::Color& color = shape.getOutlineColor();
+        appendQuad(layer.shapes, transform, outer, outer, size.x - outer, inner, color);
+        appendQuad(layer.shapes, transform, outer, size.y - inner, size.x - outer, size.y - outer, color);
+        appendQuad(layer.shapes, transform, outer, inner, inner, size.y - inner, color);
+        appendQuad(layer.shapes, transform, size.x - inner, inner, size.x - outer, size.y - inner, color);
+    }
+}
+
+std::size_t UiBatch::TextKeyHash::operator()(const TextKey& key) const {
+    std::size_t h = std::hash<std::u32string>()(key.text);
+    h ^= std::hash<const void*>()(key.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= (static_cast<std::size_t>(key.characterSize) << 1 | (key.bold ? 1 : 0)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+const std::vector<UiBatch::GlyphQuad>& UiBatch::layout(const sf::Text& text) {
+    const sf::Font* font = text.getFont();
+    const sf::String& string = text.getString();
+    lookupKey.font = font;
+    lookupKey.characterSize = text.getCharacterSize();
+    lookupKey.bold = (text.getStyle() & sf::Text::Bold) != 0;
+    lookupKey.text.clear();
+    for (std::size_t i = 0; i < string.getSize(); ++i) {
+        lookupKey.text.push_back(static_cast<char32_t>(string[i]));
+    }
+
+    auto found = textCache.find(lookupKey);
+    if (found != textCache.end()) {
+        return found->second;
+    }
+    if (textCache.size() >= TEXT_CACHE_LIMIT) {
+        textCache.clear();  // a runaway set of distinct strings; start over
+    }
+
+    // Same layout as sf::Text: baseline at characterSize, glyph quads padded by one pixel
+    std::vector<GlyphQuad> quads;
+    unsigned int size = lookupKey.characterSize;
+    bool bold = lookupKey.bold;
+    const float padding = 1.f;
+    float whitespace = font->getGlyph(L' ', size, bold).advance;
+    float lineSpacing = font->getLineSpacing(size);
+    float x = 0.f;
+    float y = static_cast<float>(size);
+    sf::Uint32 previous = 0;
+    for (char32_t c : lookupKey.text) {
+        if (c == '\r') {
+            continue;
+        }
+        x += font->getKerning(previous, c, size);
+        previous = c;
+        if (c == ' ') {
+            x += whitespace;
+        } else if (c == '\t') {
+            x += whitespace * 4;
+        } else if (c == '\n') {
+            y += lineSpacing;
+            x = 0.f;
+        } else {
+            const sf::Glyph& glyph = font->getGlyph(c, size, bold);
+            quads.push_back(GlyphQuad{
+                x + glyph.bounds.left - padding,
+                y + glyph.bounds.top - padding,
+                x + glyph.bounds.left + glyph.bounds.width + padding,
+                y + glyph.bounds.top + glyph.bounds.height + padding,
+                static_cast<float>(glyph.textureRect.left) - padding,
+                static_cast<float>(glyph.textureRect.top) - padding,
+                static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding,
+                static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding});
+            x += glyph.advance;
+        }
+    }
+    return textCache.emplace(lookupKey, std::move(quads)).first->second;
+}
+
+void UiBatch::add(const sf::Text& text) {
+    if (!text.getFont() || text.getString().isEmpty()) {
+        return;
+    }
+    const std::vector<GlyphQuad>& quads = layout(text);
+    const sf::Color& color = text.getFillColor();
+    const sf::Transform& transform = text.getTransform();
+    sf::VertexArray& vertices = pageFor(current(), text.getFont(), text.getCharacterSize()).vertices;
+
+    for (const GlyphQuad& q : quads) {
+        sf::Vertex a(transform.transformPoint(q.left, q.top), color, sf::Vector2f(q.u1, q.v1));
+        sf::Vertex b(transform.transformPoint(q.right, q.top), color, sf::Vector2f(q.u2, q.v1));
+        sf::Vertex c(transform.transformPoint(q.left, q.bottom), color, sf::Vector2f(q.u1, q.v2));
+        sf::Vertex d(transform.transformPoint(q.right, q.bottom), color, sf::Vector2f(q.u2, q.v2));
+        vertices.append(a);
+        vertices.append(b);
+        vertices.append(c);
+        vertices.append(c);
+        vertices.append(b);
+        vertices.append(d);
+    }
+}
+
+void UiBatch::warmUp(const sf::Font& font, const std::vector<unsigned int>& characterSizes) {
+    for (unsigned int size : characterSizes) {
+        for (sf::Uint32 c = 32; c < 127; ++c) {
+            font.getGlyph(c, size, false);
+        }
+        // Forces the page texture to its final size before the first frame uses it
+        font.getTexture(size);
+    }
+}
+
+std::size_t UiBatch::pendingDrawCalls() const {
+    std::size_t calls = 0;
+    for (std::size_t l = 0; l < activeLayers; ++l) {
+        calls += layers[l].shapes.getVertexCount() > 0 ? 1 : 0;
+        for (const GlyphPage& page : layers[l].pages) {
+            calls += page.vertices.getVertexCount() > 0 ? 1 : 0;
+        }
+    }
+    return calls;
+}
+
+void UiBatch::flush() {
+    for (std::size_t l = 0; l < activeLayers; ++l) {
+        Layer& layer = layers[l];
+        if (layer.shapes.getVertexCount() > 0) {
+            window.draw(layer.shapes);
+            layer.shapes.clear();
+        }
+        for (GlyphPage& page : layer.pages) {
+            if (page.vertices.getVertexCount() > 0) {
+                // Fetched at draw time: adding glyphs may have grown the page texture
+                sf::RenderStates states(&page.font->getTexture(page.characterSize));
+                window.draw(page.vertices, states);
+                page.vertices.clear();
+            }
+        }
+    }
+    activeLayers = 0;
+}
@@ -0,0 +1,94 @@
+// Email: nitzanwa@gmail.com
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ProfiledWindow;
+
+// Collects widget rectangles and text glyphs for a frame and draws them with
+// one vertex array per layer for the shapes and one per font page (font and
+// character size) for the text. Within a layer all shapes are drawn before
+// all text; popups start a new layer so they cover what was added before.
+class UiBatch {
+public:
+    explicit UiBatch(ProfiledWindow& window);
+
+    // Fill and outline of a rectangle (position, origin and scale are applied)
+    void add(const sf::RectangleShape& shape);
+
+    // Glyph quads of a text, laid out like sf::Text (regular/bold, multi-line)
+    void add(const sf::Text& text);
+
+    // Rasterise the printable ASCII glyphs at the given sizes now, so a size
+    // seen for the first time mid-game does not stall on glyph uploads
+    static void warmUp(const sf::Font& font, const std::vector<unsigned int>& characterSizes);
+
+    // Laid-out texts currently cached
+    std::size_t cachedTexts() const { return textCache.size(); }
+
+    // Everything added after this call is drawn above everything added before it
+    void beginLayer();
+
+    // Draw all layers in order and start a new, empty frame
+    void flush();
+
+    // Size of the window the batch draws into (for centering widgets)
+    sf::Vector2u getTargetSize() const;
+
+    // Vertex arrays that the next flush will draw
+    std::size_t pendingDrawCalls() const;
+
+private:
+    struct GlyphPage {
+        const sf::Font* font;
+        unsigned int characterSize;
+        sf::VertexArray vertices;
+    };
+
+    // Glyph quad relative to the text's origin (before its transform)
+    struct GlyphQuad {
+        float left, top, right, bottom;
+        float u1, v1, u2, v2;
+    };
+
+    struct TextKey {
+        const sf::Font* font;
+        unsigned int characterSize;
+        bool bold;
+        std::u32string text;
+
+        bool operator==(const TextKey& other) const {
+            return font == other.font && characterSize == other.characterSize && bold == other.bold &&
+                   text == other.text;
+        }
+    };
+
+    struct TextKeyHash {
+        std::size_t operator()(const TextKey& key) const;
+    };
+
+    struct Layer {
+        sf::VertexArray shapes;
+        std::vector<GlyphPage> pages;
+    };
+
+    ProfiledWindow& window;
+
+    // Layers are reused between frames so their vertex storage is kept
+    std::vector<Layer> layers;
+    std::size_t activeLayers;
+
+    // Layout of each distinct (string, font, size, style), reused until it is evicted
+    std::unordered_map<TextKey, std::vector<GlyphQuad>, TextKeyHash> textCache;
+    TextKey lookupKey;   // reused so a cache hit does not allocate
+
+    static const std::size_t TEXT_CACHE_LIMIT = 2048;
+
+    const std::vector<GlyphQuad>& layout(const sf::Text& text);
+    Layer& current();
+    GlyphPage& pageFor(Layer& layer, const sf::Font* font, unsigned int characterSize);
+};
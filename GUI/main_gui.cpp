@@ -1,7 +1,26 @@
 #include "GUI.hpp"
+#include "../GameLogic/Tracer.hpp"
+
+#include <iostream>
+
+// Usage: gui_app [recording]  (a recording opens in the replay viewer, see COUP_RECORD in coup_sim)
+// COUP_TRACE=<file> records a trace from startup and writes it on exit
+int main(int argc, char* argv[]) {
+    std::string tracePath = coup::Tracer::environmentPath();
+    coup::Tracer::setEnabled(!tracePath.empty());
 
-int main() {
     GUI gui;
+    if (argc > 1) {
+        gui.setReplayFile(argv[1]);
+    }
     gui.run();
+
+    if (coup::Tracer::isEnabled()) {
+        try {
+            coup::Tracer::writeChromeTrace(tracePath);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
     return 0;
-}
\ No newline at end of file
+}
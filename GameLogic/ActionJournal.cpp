@@ -0,0 +1,74 @@
+// Email: nitzanwa@gmail.com
+
+#include "ActionJournal.hpp"
+#include "../Players/Player.hpp"
+#include "../Players/Roles/Baron.hpp"
+
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        Player &seat(const Game::PlayerList &table, std::uint8_t index) {
+            if (index >= table.size()) {
+                throw std::runtime_error("Journal entry refers to seat " + std::to_string(index) +
+                                         " of a " + std::to_string(table.size()) + "-player table");
+            }
+            return *table[index];
+        }
+    }
+
+    void performJournalEntry(Game &, const Game::PlayerList &table, const JournalEntry &entry) {
+        Player &actor = seat(table, entry.actor);
+        switch (entry.op) {
+            case JournalOp::StartTurn: actor.startTurn(); break;
+            case JournalOp::Gather: actor.gather(); break;
+            case JournalOp::Tax: actor.tax(); break;
+            case JournalOp::Bribe: actor.bribe(); break;
+            case JournalOp::Arrest: actor.arrest(seat(table, entry.target)); break;
+            case JournalOp::Sanction: actor.sanction(seat(table, entry.target)); break;
+            case JournalOp::Coup: actor.coup(seat(table, entry.target)); break;
+            case JournalOp::Invest: {
+                Baron *baron = dynamic_cast<Baron *>(&actor);
+                if (!baron) {
+                    throw std::runtime_error("Journaled invest by a non-Baron seat");
+                }
+                baron->invest();
+                break;
+            }
+            case JournalOp::EndTurn: actor.endTurn(); break;
+            case JournalOp::Decision: break;
+            default: throw std::runtime_error("Unknown journal operation");
+        }
+    }
+
+    bool ReplayDecisions::shouldBribe(Player &) {
+        if (answers.empty()) {
+            return false;
+        }
+        bool answer = answers.front();
+        answers.pop_front();
+        return answer;
+    }
+
+    bool ReplayDecisions::shouldBlock(Player &blocker, ActionType, Player *, Player *) {
+        return shouldBribe(blocker);
+    }
+
+    const char *journalOpName(JournalOp op) {
+        switch (op) {
+            case JournalOp::StartTurn: return "start_turn";
+            case JournalOp::Gather: return "gather";
+            case JournalOp::Tax: return "tax";
+            case JournalOp::Bribe: return "bribe";
+            case JournalOp::Arrest: return "arrest";
+            case JournalOp::Sanction: return "sanction";
+            case JournalOp::Coup: return "coup";
+            case JournalOp::Invest: return "invest";
+            case JournalOp::EndTurn: return "end_turn";
+            case JournalOp::Decision: return "decision";
+            default: return "unknown";
+        }
+    }
+
+}
@@ -0,0 +1,120 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef ACTION_JOURNAL_HPP
+#define ACTION_JOURNAL_HPP
+
+#include "Game.hpp"
+#include "Role.hpp"
+#include "../Players/DecisionPolicy.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @enum JournalOp
+     * @brief Player operations a game driver performs, as journaled
+     */
+    enum class JournalOp : std::uint8_t {
+        StartTurn,  ///< actor->startTurn()
+        Gather,     ///< actor->gather()
+        Tax,        ///< actor->tax()
+        Bribe,      ///< actor->bribe()
+        Arrest,     ///< actor->arrest(target)
+        Sanction,   ///< actor->sanction(target)
+        Coup,       ///< actor->coup(target)
+        Invest,     ///< actor (a Baron) ->invest()
+        EndTurn,    ///< actor->endTurn()
+        Decision    ///< a bribe/block question put to actor was answered target (0/1)
+    };
+
+    constexpr int JOURNAL_OP_COUNT = 10;        ///< Number of JournalOp values
+    constexpr std::uint8_t JOURNAL_NO_SEAT = 0xFF;  ///< Target of an untargeted operation
+
+    /**
+     * @struct JournalEntry
+     * @brief One accepted operation; players are seat indices in join order
+     */
+    struct JournalEntry {
+        JournalOp op;
+        std::uint8_t actor;   ///< Seat performing the operation (or answering the question)
+        std::uint8_t target;  ///< Target seat, JOURNAL_NO_SEAT, or the Decision answer
+    };
+
+    /**
+     * @class ActionJournal
+     * @brief Receives everything needed to replay one game
+     *
+     * A driver reports the table it set up, every operation that succeeded,
+     * in order, and every bribe/block decision its policies made (the
+     * decisions are reported while the operation that asked runs, so they
+     * precede it). Operations that threw are not reported: the engine
+     * validates before it changes state, so they had no effect.
+     */
+    class ActionJournal {
+    public:
+        virtual ~ActionJournal() = default;
+
+        /**
+         * @brief A game was set up with Game(seed) and setup(names, roles)
+         */
+        virtual void gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                                 const std::vector<Role> &roles) = 0;
+
+        /**
+         * @brief An operation was accepted (or a decision was made)
+         */
+        virtual void record(const JournalEntry &entry) = 0;
+
+        /**
+         * @brief The game finished or was abandoned
+         * @param winnerSeat Seat of the winner, or -1 if there is none
+         */
+        virtual void gameEnded(int winnerSeat) = 0;
+    };
+
+    /**
+     * @brief Perform a journaled operation on a game
+     * @param game Game to act on
+     * @param table Players in seat order (as returned by Game::setup)
+     * @param entry Operation to perform (Decision entries are ignored)
+     * @throws std::runtime_error if the engine rejects the operation or a seat is invalid
+     */
+    void performJournalEntry(Game &game, const Game::PlayerList &table, const JournalEntry &entry);
+
+    /**
+     * @class ReplayDecisions
+     * @brief Answers bribe/block questions with journaled decisions, in order
+     *
+     * Attach to every player of a replayed game and push() each Decision
+     * entry before performing the operation that follows it. A question
+     * with no journaled answer is answered "no".
+     */
+    class ReplayDecisions : public DecisionPolicy {
+    private:
+        std::deque<bool> answers;
+
+    public:
+        void push(const JournalEntry &decision) { answers.push_back(decision.target != 0); }
+
+        /**
+         * @brief Answers not consumed yet (non-zero after a replay means it diverged)
+         */
+        std::size_t pending() const { return answers.size(); }
+
+        bool shouldBribe(Player &player) override;
+        bool shouldBlock(Player &blocker, ActionType action, Player *actor, Player *target) override;
+    };
+
+    /**
+     * @brief Stable lowercase name of an operation (e.g. "start_turn")
+     */
+    const char *journalOpName(JournalOp op);
+
+}
+
+#endif // ACTION_JOURNAL_HPP
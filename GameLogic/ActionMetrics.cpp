@@ -0,0 +1,255 @@
+// Email: nitzanwa@gmail.com
+
+#include "ActionMetrics.hpp"
+#include "EngineMetrics.hpp"
+#include "Tracer.hpp"
+
+#include <chrono>
+
+namespace coup {
+
+    const char *rejectReasonName(RejectReason reason) {
+        switch (reason) {
+            case RejectReason::NotYourTurn: return "not_your_turn";
+            case RejectReason::Sanctioned: return "sanctioned";
+            case RejectReason::NotEnoughCoins: return "not_enough_coins";
+            case RejectReason::InvalidTarget: return "invalid_target";
+            case RejectReason::ArrestUnavailable: return "arrest_unavailable";
+            case RejectReason::BribeUnavailable: return "bribe_unavailable";
+            default: return "other";
+        }
+    }
+
+    namespace {
+        // Single-writer increment: a plain load/store pair instead of a locked
+        // read-modify-write; readers on other threads still see whole values.
+        template <typename T>
+        void bump(std::atomic<T> &counter, T amount = 1) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+
+    namespace {
+        // Trace span name per ActionType
+        const char *const ACTION_SPAN_NAMES[ACTION_TYPE_COUNT] = {
+            "Player::none", "Player::gather", "Player::tax", "Player::bribe",
+            "Player::arrest", "Player::sanction", "Player::coup", "Baron::invest"
+        };
+    }
+
+    std::uint64_t metricsClockNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // ---- HistogramSnapshot ----
+
+    int HistogramSnapshot::bucketFor(std::uint64_t ns) {
+        if (ns < static_cast<std::uint64_t>(SUB_BUCKETS)) {
+            return static_cast<int>(ns);
+        }
+        int exponent = 63 - __builtin_clzll(ns);
+        if (exponent > MAX_EXPONENT) {
+            return BUCKET_COUNT - 1;
+        }
+        int sub = static_cast<int>((ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    std::uint64_t HistogramSnapshot::bucketLowerBound(int bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return static_cast<std::uint64_t>(bucket);
+        }
+        int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+        std::uint64_t mantissa = static_cast<std::uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS);
+        return mantissa << (exponent - SUB_BUCKET_BITS);
+    }
+
+    double HistogramSnapshot::meanNs() const {
+        return count ? static_cast<double>(sumNs) / count : 0.0;
+    }
+
+    std::uint64_t HistogramSnapshot::percentileNs(double percentile) const {
+        if (count == 0) {
+            return 0;
+        }
+        if (percentile < 0) {
+            percentile = 0;
+        }
+        if (percentile > 100) {
+            percentile = 100;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(percentile / 100.0 * count + 0.5);
+        if (rank == 0) {
+            rank = 1;
+        }
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKET_COUNT; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                std::uint64_t upper = b + 1 < BUCKET_COUNT ? bucketLowerBound(b + 1) - 1 : maxNs;
+                return upper < maxNs ? upper : maxNs;
+            }
+        }
+        return maxNs;
+    }
+
+    // ---- LatencyHistogram ----
+
+    LatencyHistogram::LatencyHistogram() {
+        reset();
+    }
+
+    void LatencyHistogram::record(std::uint64_t ns) {
+        bump<std::uint32_t>(buckets[HistogramSnapshot::bucketFor(ns)]);
+        bump<std::uint64_t>(count);
+        bump<std::uint64_t>(sumNs, ns);
+        if (ns > maxNs.load(std::memory_order_relaxed)) {
+            maxNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    HistogramSnapshot LatencyHistogram::snapshot() const {
+        HistogramSnapshot copy;
+        copy.count = count.load(std::memory_order_relaxed);
+        copy.sumNs = sumNs.load(std::memory_order_relaxed);
+        copy.maxNs = maxNs.load(std::memory_order_relaxed);
+        for (int b = 0; b < HistogramSnapshot::BUCKET_COUNT; ++b) {
+            copy.buckets[b] = buckets[b].load(std::memory_order_relaxed);
+        }
+        return copy;
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto &bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        sumNs.store(0, std::memory_order_relaxed);
+        maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    // ---- ActionCounters ----
+
+    std::uint64_t ActionCounters::totalRejected() const {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : rejected) {
+            total += n;
+        }
+        return total;
+    }
+
+    std::uint64_t ActionCounters::totalBlocked() const {
+        std::uint64_t total = 0;
+        for (std::uint64_t n : blockedBy) {
+            total += n;
+        }
+        return total;
+    }
+
+    // ---- ActionMetrics ----
+
+    ActionMetrics::ActionMetrics() : current(ActionType::None), currentStartNs(0), currentTraced(false) {
+        reset();
+    }
+
+    void ActionMetrics::recordRejection(RejectReason reason) {
+        if (current == ActionType::None) {
+            return;
+        }
+        bump<std::uint64_t>(counters[static_cast<int>(current)].rejected[static_cast<int>(reason)]);
+        EngineShard::add(EngineMetrics::local().actionsRejected[static_cast<int>(reason)]);
+        if (currentTraced) {
+            Tracer::record(ACTION_SPAN_NAMES[static_cast<int>(current)], "action", currentStartNs,
+                           metricsClockNs(), rejectReasonName(reason));
+        }
+        current = ActionType::None;
+    }
+
+    void ActionMetrics::recordBlock(ActionType action, Role blocker) {
+        bump<std::uint64_t>(counters[static_cast<int>(action)].blockedBy[static_cast<int>(blocker)]);
+        EngineShard::add(EngineMetrics::local().blocks[static_cast<int>(blocker)]);
+    }
+
+    void ActionMetrics::recordBlockLatency(ActionType action, std::uint64_t ns) {
+        blockLatency[static_cast<int>(action)].record(ns);
+    }
+
+    MetricsSnapshot ActionMetrics::snapshot() const {
+        MetricsSnapshot copy;
+        for (int a = 0; a < ACTION_TYPE_COUNT; ++a) {
+            const LiveCounters &live = counters[a];
+            ActionCounters &out = copy.actions[a];
+            out.attempted = live.attempted.load(std::memory_order_relaxed);
+            out.succeeded = live.succeeded.load(std::memory_order_relaxed);
+            for (int r = 0; r < REJECT_REASON_COUNT; ++r) {
+                out.rejected[r] = live.rejected[r].load(std::memory_order_relaxed);
+            }
+            for (int r = 0; r < ROLE_COUNT; ++r) {
+                out.blockedBy[r] = live.blockedBy[r].load(std::memory_order_relaxed);
+            }
+            copy.actionLatency[a] = actionLatency[a].snapshot();
+            copy.blockLatency[a] = blockLatency[a].snapshot();
+        }
+        return copy;
+    }
+
+    void ActionMetrics::reset() {
+        current = ActionType::None;
+        for (LiveCounters &live : counters) {
+            live.attempted.store(0, std::memory_order_relaxed);
+            live.succeeded.store(0, std::memory_order_relaxed);
+            for (auto &n : live.rejected) {
+                n.store(0, std::memory_order_relaxed);
+            }
+            for (auto &n : live.blockedBy) {
+                n.store(0, std::memory_order_relaxed);
+            }
+        }
+        for (LatencyHistogram &h : actionLatency) {
+            h.reset();
+        }
+        for (LatencyHistogram &h : blockLatency) {
+            h.reset();
+        }
+    }
+
+    // ---- ActionTimer ----
+
+    ActionTimer::ActionTimer(ActionMetrics &metrics, ActionType action)
+        : metrics(metrics), action(action), startNs(0) {
+        bump<std::uint64_t>(metrics.counters[static_cast<int>(action)].attempted);
+        EngineShard::add(EngineMetrics::local().actionsAttempted[static_cast<int>(action)]);
+        startNs = metricsClockNs();
+        metrics.current = action;
+        metrics.currentStartNs = startNs;
+        metrics.currentTraced = Tracer::isEnabled();
+    }
+
+    ActionTimer::~ActionTimer() {
+        // Still open: the action ended in an exception that was not a counted rejection
+        if (metrics.current != ActionType::None) {
+            metrics.recordRejection(RejectReason::Other);
+        }
+    }
+
+    void ActionTimer::succeed() {
+        bump<std::uint64_t>(metrics.counters[static_cast<int>(action)].succeeded);
+        EngineShard::add(EngineMetrics::local().actionsSucceeded[static_cast<int>(action)]);
+        close("succeeded");
+    }
+
+    void ActionTimer::finish() {
+        close("no_effect");
+    }
+
+    void ActionTimer::close(const char *outcome) {
+        std::uint64_t endNs = metricsClockNs();
+        metrics.actionLatency[static_cast<int>(action)].record(endNs - startNs);
+        if (metrics.currentTraced) {
+            Tracer::record(ACTION_SPAN_NAMES[static_cast<int>(action)], "action", startNs, endNs, outcome);
+        }
+        metrics.current = ActionType::None;
+    }
+
+}
@@ -0,0 +1,264 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef ACTION_METRICS_HPP
+#define ACTION_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "ActionType.hpp"
+#include "Role.hpp"
+
+namespace coup {
+
+    constexpr int ACTION_TYPE_COUNT = 8;  ///< Number of ActionType values (None..Invest)
+
+    /**
+     * @enum RejectReason
+     * @brief Why an action was refused before it took effect
+     */
+    enum class RejectReason : std::uint8_t {
+        NotYourTurn,        ///< Acting out of turn
+        Sanctioned,         ///< Economic action while sanctioned
+        NotEnoughCoins,     ///< Actor cannot pay the cost
+        InvalidTarget,      ///< Target dead, self, already sanctioned or unable to pay
+        ArrestUnavailable,  ///< Arrest cooldown or arrest blocked by Spy
+        BribeUnavailable,   ///< Bribe without a prior action, twice, or already used
+        Other               ///< Any other failure (e.g. bank exhausted)
+    };
+
+    constexpr int REJECT_REASON_COUNT = 7;  ///< Number of RejectReason values
+
+    /**
+     * @brief Short name of a rejection reason
+     * @param reason Reason to name
+     * @return Static lower-case name (e.g. "not_your_turn")
+     */
+    const char *rejectReasonName(RejectReason reason);
+
+    /**
+     * @struct HistogramSnapshot
+     * @brief Point-in-time copy of a LatencyHistogram
+     */
+    struct HistogramSnapshot {
+        static constexpr int SUB_BUCKET_BITS = 3;                   ///< 12.5% relative precision
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_EXPONENT = 39;                     ///< Values >= 2^40 ns share the top bucket
+        static constexpr int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+        std::uint64_t count = 0;    ///< Recorded samples
+        std::uint64_t sumNs = 0;    ///< Sum of samples
+        std::uint64_t maxNs = 0;    ///< Largest sample
+        std::array<std::uint32_t, BUCKET_COUNT> buckets{};  ///< Samples per bucket
+
+        /**
+         * @brief Bucket holding a value
+         * @param ns Sample in nanoseconds
+         * @return Bucket index
+         */
+        static int bucketFor(std::uint64_t ns);
+
+        /**
+         * @brief Smallest value that falls into a bucket
+         * @param bucket Bucket index
+         * @return Lower bound in nanoseconds
+         */
+        static std::uint64_t bucketLowerBound(int bucket);
+
+        /**
+         * @brief Mean sample
+         * @return Mean in nanoseconds (0 if empty)
+         */
+        double meanNs() const;
+
+        /**
+         * @brief Value at a percentile, accurate to one bucket
+         * @param percentile Percentile in [0, 100]
+         * @return Upper bound of the bucket holding that rank, capped at maxNs (0 if empty)
+         */
+        std::uint64_t percentileNs(double percentile) const;
+    };
+
+    /**
+     * @class LatencyHistogram
+     * @brief Lock-free log-linear (HDR-style) histogram of nanosecond latencies
+     *
+     * Single writer: record() and reset() belong to one thread at a time and
+     * use plain relaxed loads/stores, so recording costs no locked
+     * instructions. snapshot() may run concurrently from any thread and may
+     * miss the samples in flight.
+     */
+    class LatencyHistogram {
+    private:
+        std::array<std::atomic<std::uint32_t>, HistogramSnapshot::BUCKET_COUNT> buckets;
+        std::atomic<std::uint64_t> count;
+        std::atomic<std::uint64_t> sumNs;
+        std::atomic<std::uint64_t> maxNs;
+
+    public:
+        LatencyHistogram();
+        LatencyHistogram(const LatencyHistogram &other) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &other) = delete;
+
+        /**
+         * @brief Add one sample
+         * @param ns Latency in nanoseconds
+         */
+        void record(std::uint64_t ns);
+
+        /**
+         * @brief Copy the current contents
+         */
+        HistogramSnapshot snapshot() const;
+
+        /**
+         * @brief Clear all samples
+         */
+        void reset();
+    };
+
+    /**
+     * @struct ActionCounters
+     * @brief Outcome counts for one action type
+     */
+    struct ActionCounters {
+        std::uint64_t attempted = 0;                                 ///< Calls of the action
+        std::uint64_t succeeded = 0;                                 ///< Completed and took effect
+        std::array<std::uint64_t, REJECT_REASON_COUNT> rejected{};   ///< Refused, by RejectReason
+        std::array<std::uint64_t, ROLE_COUNT> blockedBy{};           ///< Blocked, by blocker Role
+
+        std::uint64_t rejectedBy(RejectReason reason) const { return rejected[static_cast<int>(reason)]; }
+        std::uint64_t blockedByRole(Role role) const { return blockedBy[static_cast<int>(role)]; }
+        std::uint64_t totalRejected() const;
+        std::uint64_t totalBlocked() const;
+    };
+
+    /**
+     * @struct MetricsSnapshot
+     * @brief Point-in-time copy of all action metrics, indexed by ActionType
+     */
+    struct MetricsSnapshot {
+        std::array<ActionCounters, ACTION_TYPE_COUNT> actions;           ///< Counters per action
+        std::array<HistogramSnapshot, ACTION_TYPE_COUNT> actionLatency;  ///< Action execution time
+        std::array<HistogramSnapshot, ACTION_TYPE_COUNT> blockLatency;   ///< Block resolution time
+
+        const ActionCounters &counters(ActionType action) const { return actions[static_cast<int>(action)]; }
+        const HistogramSnapshot &latency(ActionType action) const { return actionLatency[static_cast<int>(action)]; }
+        const HistogramSnapshot &blockResolution(ActionType action) const { return blockLatency[static_cast<int>(action)]; }
+    };
+
+    /**
+     * @class ActionMetrics
+     * @brief Per-ActionType counters and latency histograms kept by Game
+     *
+     * Written only by the game's thread; every counter is a relaxed atomic,
+     * so another thread (e.g. a server's stats reporter) can take snapshots
+     * lock-free while the game records.
+     * The "action in progress" used to attribute rejections is owned by the
+     * game thread and set through ActionTimer.
+     */
+    class ActionMetrics {
+    private:
+        struct LiveCounters {
+            std::atomic<std::uint64_t> attempted;
+            std::atomic<std::uint64_t> succeeded;
+            std::array<std::atomic<std::uint64_t>, REJECT_REASON_COUNT> rejected;
+            std::array<std::atomic<std::uint64_t>, ROLE_COUNT> blockedBy;
+        };
+
+        std::array<LiveCounters, ACTION_TYPE_COUNT> counters;
+        std::array<LatencyHistogram, ACTION_TYPE_COUNT> actionLatency;
+        std::array<LatencyHistogram, ACTION_TYPE_COUNT> blockLatency;
+        ActionType current;          ///< Open action (None outside actions)
+        std::uint64_t currentStartNs;///< When the open action started
+        bool currentTraced;          ///< Whether the open action is recorded as a trace span
+
+        friend class ActionTimer;
+
+    public:
+        ActionMetrics();
+        ActionMetrics(const ActionMetrics &other) = delete;
+        ActionMetrics &operator=(const ActionMetrics &other) = delete;
+
+        /**
+         * @brief Count a refusal of the open action and close it (ignored outside actions)
+         * @param reason Why it was refused
+         */
+        void recordRejection(RejectReason reason);
+
+        /**
+         * @brief Count a successful block
+         * @param action Action that was blocked
+         * @param blocker Role of the blocking player
+         */
+        void recordBlock(ActionType action, Role blocker);
+
+        /**
+         * @brief Add a block-resolution time (one blocking round)
+         * @param action Action that was offered for blocking
+         * @param ns Time spent resolving in nanoseconds
+         */
+        void recordBlockLatency(ActionType action, std::uint64_t ns);
+
+        /**
+         * @brief Copy all counters and histograms
+         */
+        MetricsSnapshot snapshot() const;
+
+        /**
+         * @brief Zero all counters and histograms
+         */
+        void reset();
+    };
+
+    /**
+     * @class ActionTimer
+     * @brief Measures one action call
+     *
+     * Counts the attempt on construction; succeed() counts a success and
+     * records the execution time, finish() records the time of a call that
+     * ended without effect (e.g. blocked). Rejections are counted by
+     * ActionMetrics::recordRejection(). While Tracer is on, each call is
+     * also recorded as a span with its outcome. An action still open when
+     * the timer is destroyed (an exception that did not go through
+     * recordRejection(), e.g. an empty bank) is counted as rejected (Other).
+     */
+    class ActionTimer {
+    private:
+        ActionMetrics &metrics;
+        ActionType action;
+        std::uint64_t startNs;
+
+    public:
+        ActionTimer(ActionMetrics &metrics, ActionType action);
+        ActionTimer(const ActionTimer &other) = delete;
+        ActionTimer &operator=(const ActionTimer &other) = delete;
+
+        /**
+         * @brief Counts the action as rejected (Other) unless it was already closed
+         */
+        ~ActionTimer();
+
+        /**
+         * @brief The action took effect
+         */
+        void succeed();
+
+        /**
+         * @brief The action ended without taking effect
+         */
+        void finish();
+
+    private:
+        void close(const char *outcome);
+    };
+
+    /**
+     * @brief Monotonic clock reading used for all metric latencies
+     * @return Nanoseconds since an arbitrary epoch
+     */
+    std::uint64_t metricsClockNs();
+
+}
+
+#endif // ACTION_METRICS_HPP
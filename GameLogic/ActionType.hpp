@@ -3,13 +3,15 @@
 #ifndef ACTION_TYPE_HPP
 #define ACTION_TYPE_HPP
 
+#include <cstdint>
+
 namespace coup {
 
     /**
      * @enum ActionType
      * @brief Represents all possible actions in the Coup game
      */
-    enum class ActionType {
+    enum class ActionType : std::uint8_t {
         None,       ///< No action (default state)
         Gather,     ///< Take 1 coin from the bank
         Tax,        ///< Collect tax (2-3 coins depending on role)
@@ -0,0 +1,103 @@
+// Email: nitzanwa@gmail.com
+
+#include "AllocationTracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace coup {
+
+    namespace {
+        thread_local AllocationStats stats;
+    }
+
+#ifdef COUP_TRACK_ALLOCATIONS
+    namespace {
+        // Each block carries its size in a header so frees can update live
+        // bytes; the header keeps the default new alignment.
+        constexpr std::size_t HEADER = alignof(std::max_align_t);
+
+        void *trackedAlloc(std::size_t size) {
+            void *raw = std::malloc(size + HEADER);
+            if (!raw) {
+                throw std::bad_alloc();
+            }
+            *static_cast<std::size_t *>(raw) = size;
+            ++stats.allocations;
+            stats.bytes += size;
+            stats.liveBytes += static_cast<std::int64_t>(size);
+            if (stats.liveBytes > stats.peakLiveBytes) {
+                stats.peakLiveBytes = stats.liveBytes;
+            }
+            return static_cast<char *>(raw) + HEADER;
+        }
+
+        void trackedFree(void *p) noexcept {
+            if (!p) {
+                return;
+            }
+            void *raw = static_cast<char *>(p) - HEADER;
+            ++stats.deallocations;
+            stats.liveBytes -= static_cast<std::int64_t>(*static_cast<std::size_t *>(raw));
+            std::free(raw);
+        }
+    }
+
+    bool AllocationTracker::isEnabled() { return true; }
+#else
+    bool AllocationTracker::isEnabled() { return false; }
+#endif
+
+    AllocationStats AllocationTracker::current() {
+        return stats;
+    }
+
+    std::int64_t AllocationTracker::beginPeak() {
+        std::int64_t previous = stats.peakLiveBytes;
+        stats.peakLiveBytes = stats.liveBytes;
+        return previous;
+    }
+
+    void AllocationTracker::restorePeak(std::int64_t outerPeak) {
+        if (outerPeak > stats.peakLiveBytes) {
+            stats.peakLiveBytes = outerPeak;
+        }
+    }
+
+    AllocationScope::AllocationScope()
+        : start(AllocationTracker::current()), outerPeak(AllocationTracker::beginPeak()) {}
+
+    AllocationScope::~AllocationScope() {
+        AllocationTracker::restorePeak(outerPeak);
+    }
+
+    std::uint64_t AllocationScope::allocations() const {
+        return AllocationTracker::current().allocations - start.allocations;
+    }
+
+    std::uint64_t AllocationScope::deallocations() const {
+        return AllocationTracker::current().deallocations - start.deallocations;
+    }
+
+    std::uint64_t AllocationScope::bytes() const {
+        return AllocationTracker::current().bytes - start.bytes;
+    }
+
+    std::int64_t AllocationScope::peakLiveBytes() const {
+        return AllocationTracker::current().peakLiveBytes - start.liveBytes;
+    }
+
+    std::int64_t AllocationScope::liveBytes() const {
+        return AllocationTracker::current().liveBytes - start.liveBytes;
+    }
+
+}
+
+#ifdef COUP_TRACK_ALLOCATIONS
+void *operator new(std::size_t size) { return coup::trackedAlloc(size); }
+void *operator new[](std::size_t size) { return coup::trackedAlloc(size); }
+void operator delete(void *p) noexcept { coup::trackedFree(p); }
+void operator delete[](void *p) noexcept { coup::trackedFree(p); }
+void operator delete(void *p, std::size_t) noexcept { coup::trackedFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { coup::trackedFree(p); }
+#endif
@@ -0,0 +1,112 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace coup {
+
+    /**
+     * @struct AllocationStats
+     * @brief Heap activity counted on one thread
+     */
+    struct AllocationStats {
+        std::uint64_t allocations = 0;  ///< operator new calls
+        std::uint64_t deallocations = 0;///< operator delete calls
+        std::uint64_t bytes = 0;        ///< Bytes requested by operator new
+        std::int64_t liveBytes = 0;     ///< Bytes allocated and not yet freed
+        std::int64_t peakLiveBytes = 0; ///< High-water mark of liveBytes
+    };
+
+    /**
+     * @class AllocationTracker
+     * @brief Counts heap allocations made through global operator new/delete
+     *
+     * Counting is compiled in only when COUP_TRACK_ALLOCATIONS is defined
+     * (make TRACK_ALLOCS=1); otherwise the hooks are absent, isEnabled()
+     * returns false and every count stays zero. Counters are per thread, so
+     * a block freed on another thread than it was allocated on shifts live
+     * bytes between the two threads.
+     */
+    class AllocationTracker {
+    public:
+        /**
+         * @brief Whether this build counts allocations
+         * @return true if operator new/delete are hooked
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Counters of the calling thread since it started
+         * @return Current totals
+         */
+        static AllocationStats current();
+
+        /**
+         * @brief Restart the peak-live high-water mark at the current live size
+         * @return Previous peak, to be handed back to restorePeak()
+         */
+        static std::int64_t beginPeak();
+
+        /**
+         * @brief Fold an outer peak back in after a nested measurement
+         * @param outerPeak Value returned by the matching beginPeak()
+         */
+        static void restorePeak(std::int64_t outerPeak);
+    };
+
+    /**
+     * @class AllocationScope
+     * @brief RAII window over the calling thread's allocation counters
+     *
+     * Usage:
+     * @code
+     * AllocationScope scope;
+     * game.aliveCount();
+     * CHECK(scope.allocations() == 0);
+     * @endcode
+     * Scopes may nest; each reports only the activity since it was opened.
+     */
+    class AllocationScope {
+    private:
+        AllocationStats start;    ///< Counters when the scope opened
+        std::int64_t outerPeak;   ///< Enclosing peak, restored on close
+
+    public:
+        AllocationScope();
+        ~AllocationScope();
+        AllocationScope(const AllocationScope &other) = delete;
+        AllocationScope &operator=(const AllocationScope &other) = delete;
+
+        /**
+         * @brief Allocations made inside the scope
+         */
+        std::uint64_t allocations() const;
+
+        /**
+         * @brief Deallocations made inside the scope
+         */
+        std::uint64_t deallocations() const;
+
+        /**
+         * @brief Bytes requested inside the scope
+         */
+        std::uint64_t bytes() const;
+
+        /**
+         * @brief Highest live heap size reached inside the scope, above its
+         *        size when the scope opened
+         */
+        std::int64_t peakLiveBytes() const;
+
+        /**
+         * @brief Net bytes still allocated from inside the scope
+         */
+        std::int64_t liveBytes() const;
+    };
+
+}
+
+#endif // ALLOCATION_TRACKER_HPP
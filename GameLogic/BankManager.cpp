@@ -1,5 +1,6 @@
 #include "BankManager.hpp"
 #include "Logger.hpp"
+#include "EngineMetrics.hpp"
 
 namespace coup {
 
@@ -12,6 +13,7 @@ namespace coup {
         }
         game.setBankCoins(game.getBankCoins() - amount);
         player.setCoins(player.getCoins() + amount);
+        EngineShard::add(EngineMetrics::local().bankPayouts);
         Logger::log("Bank transferred " + std::to_string(amount) + " coins to " + player.getName());
     }
 
@@ -24,6 +26,7 @@ namespace coup {
         }
         player.setCoins(player.getCoins() - amount);
         game.setBankCoins(game.getBankCoins() + amount);
+        EngineShard::add(EngineMetrics::local().bankReturns);
         Logger::log(player.getName() + " transferred " + std::to_string(amount) + " coins to bank");
     }
 
@@ -36,6 +39,7 @@ namespace coup {
         }
         from.setCoins(from.getCoins() - amount);
         to.setCoins(to.getCoins() + amount);
+        EngineShard::add(EngineMetrics::local().playerTransfers);
         Logger::log(from.getName() + " transferred " + std::to_string(amount) + " coins to " + to.getName());
     }
 
@@ -0,0 +1,138 @@
+// Email: nitzanwa@gmail.com
+
+#include "EngineMetrics.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace coup {
+
+    namespace {
+        const char *const ACTION_LABELS[ACTION_TYPE_COUNT] = {
+            "none", "gather", "tax", "bribe", "arrest", "sanction", "coup", "invest"
+        };
+
+        const char *const ROLE_LABELS[ROLE_COUNT] = {
+            "governor", "spy", "baron", "general", "judge", "merchant"
+        };
+
+        std::string label(const char *key, const char *value) {
+            return std::string(key) + "=\"" + value + "\"";
+        }
+
+        // Shards outlive their threads so finished threads' counts stay in the totals
+        std::mutex shardMutex;
+        std::vector<std::unique_ptr<EngineShard>> shards;
+        thread_local EngineShard *localShard = nullptr;
+
+        template <typename T>
+        T sum(std::atomic<T> EngineShard::*field) {
+            T total = 0;
+            for (const auto &shard : shards) {
+                total += ((*shard).*field).load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        template <std::size_t N>
+        std::uint64_t sum(std::array<std::atomic<std::uint64_t>, N> EngineShard::*field, std::size_t i) {
+            std::uint64_t total = 0;
+            for (const auto &shard : shards) {
+                total += ((*shard).*field)[i].load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+    }
+
+    EngineMetrics::EngineMetrics(MetricsRegistry &registry)
+        : gamesStarted(registry.counter("coup_games_started_total", "Games created or reset")),
+          gamesFinished(registry.counter("coup_games_finished_total", "Games that reached a winner")),
+          gamesActive(registry.gauge("coup_games_active", "Game objects currently alive")),
+          bankCoins(registry.gauge("coup_bank_coins", "Coins held by the banks of live games")),
+          coinsInCirculation(registry.gauge("coup_coins_in_circulation",
+                                            "Coins paid out by the banks of live games")),
+          bankPayouts(registry.counter("coup_bank_transfers_total", "Coin transfers by direction",
+                                       label("direction", "to_player"))),
+          bankReturns(registry.counter("coup_bank_transfers_total", "Coin transfers by direction",
+                                       label("direction", "to_bank"))),
+          playerTransfers(registry.counter("coup_bank_transfers_total", "Coin transfers by direction",
+                                           label("direction", "player_to_player"))),
+          gameDuration(registry.histogram("coup_game_duration_seconds", "Wall time from game start to winner",
+                                          {0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 1, 10, 60, 600})),
+          actionsPerSecond(registry.gauge("coup_actions_per_second", "Actions attempted per second")),
+          blocksPerSecond(registry.gauge("coup_blocks_per_second", "Successful blocks per second")),
+          gamesFinishedPerSecond(registry.gauge("coup_games_finished_per_second", "Games finished per second")) {
+        for (int a = 0; a < ACTION_TYPE_COUNT; ++a) {
+            actionsAttempted[a] = &registry.counter("coup_actions_total", "Actions attempted",
+                                                    label("action", ACTION_LABELS[a]));
+        }
+        for (int a = 0; a < ACTION_TYPE_COUNT; ++a) {
+            actionsSucceeded[a] = &registry.counter("coup_actions_succeeded_total", "Actions that took effect",
+                                                    label("action", ACTION_LABELS[a]));
+        }
+        for (int r = 0; r < REJECT_REASON_COUNT; ++r) {
+            actionsRejected[r] = &registry.counter("coup_actions_rejected_total", "Actions refused by the rules",
+                                                   label("reason", rejectReasonName(static_cast<RejectReason>(r))));
+        }
+        for (int r = 0; r < ROLE_COUNT; ++r) {
+            blocks[r] = &registry.counter("coup_blocks_total", "Successful blocks by blocker role",
+                                          label("role", ROLE_LABELS[r]));
+        }
+    }
+
+    EngineMetrics &EngineMetrics::get() {
+        static EngineMetrics metrics(MetricsRegistry::global());
+        return metrics;
+    }
+
+    EngineShard &EngineMetrics::local() {
+        if (!localShard) {
+            std::lock_guard<std::mutex> lock(shardMutex);
+            shards.emplace_back(new EngineShard());
+            localShard = shards.back().get();
+        }
+        return *localShard;
+    }
+
+    void EngineMetrics::collect() {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        for (std::size_t a = 0; a < ACTION_TYPE_COUNT; ++a) {
+            actionsAttempted[a]->set(sum(&EngineShard::actionsAttempted, a));
+            actionsSucceeded[a]->set(sum(&EngineShard::actionsSucceeded, a));
+        }
+        for (std::size_t r = 0; r < REJECT_REASON_COUNT; ++r) {
+            actionsRejected[r]->set(sum(&EngineShard::actionsRejected, r));
+        }
+        for (std::size_t r = 0; r < ROLE_COUNT; ++r) {
+            blocks[r]->set(sum(&EngineShard::blocks, r));
+        }
+        gamesStarted.set(sum(&EngineShard::gamesStarted));
+        gamesFinished.set(sum(&EngineShard::gamesFinished));
+        bankPayouts.set(sum(&EngineShard::bankPayouts));
+        bankReturns.set(sum(&EngineShard::bankReturns));
+        playerTransfers.set(sum(&EngineShard::playerTransfers));
+        gamesActive.set(static_cast<double>(sum(&EngineShard::gamesActive)));
+        bankCoins.set(static_cast<double>(sum(&EngineShard::bankCoins)));
+        coinsInCirculation.set(static_cast<double>(sum(&EngineShard::coinsInCirculation)));
+    }
+
+    std::uint64_t EngineMetrics::totalActions() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        std::uint64_t total = 0;
+        for (std::size_t a = 0; a < ACTION_TYPE_COUNT; ++a) {
+            total += sum(&EngineShard::actionsAttempted, a);
+        }
+        return total;
+    }
+
+    std::uint64_t EngineMetrics::totalBlocks() const {
+        std::lock_guard<std::mutex> lock(shardMutex);
+        std::uint64_t total = 0;
+        for (std::size_t r = 0; r < ROLE_COUNT; ++r) {
+            total += sum(&EngineShard::blocks, r);
+        }
+        return total;
+    }
+
+}
@@ -0,0 +1,108 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef ENGINE_METRICS_HPP
+#define ENGINE_METRICS_HPP
+
+#include "ActionMetrics.hpp"
+#include "MetricsRegistry.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace coup {
+
+    /**
+     * @struct EngineShard
+     * @brief One thread's share of the engine counters
+     *
+     * Only the owning thread writes, with a relaxed load and store rather
+     * than a read-modify-write, so games on different threads never touch
+     * the same cache line. Gauges are kept as signed deltas: a game may end
+     * on another thread than it started on, but the sum over all shards is
+     * still right.
+     */
+    struct alignas(64) EngineShard {
+        std::array<std::atomic<std::uint64_t>, ACTION_TYPE_COUNT> actionsAttempted{};
+        std::array<std::atomic<std::uint64_t>, ACTION_TYPE_COUNT> actionsSucceeded{};
+        std::array<std::atomic<std::uint64_t>, REJECT_REASON_COUNT> actionsRejected{};
+        std::array<std::atomic<std::uint64_t>, ROLE_COUNT> blocks{};
+        std::atomic<std::uint64_t> gamesStarted{0};
+        std::atomic<std::uint64_t> gamesFinished{0};
+        std::atomic<std::uint64_t> bankPayouts{0};
+        std::atomic<std::uint64_t> bankReturns{0};
+        std::atomic<std::uint64_t> playerTransfers{0};
+        std::atomic<std::int64_t> gamesActive{0};
+        std::atomic<std::int64_t> bankCoins{0};
+        std::atomic<std::int64_t> coinsInCirculation{0};
+
+        /**
+         * @brief Add to a counter of this shard (owning thread only)
+         */
+        template <typename T>
+        static void add(std::atomic<T> &counter, typename std::atomic<T>::value_type amount = 1) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * @struct EngineMetrics
+     * @brief Process-wide engine metrics, registered once in MetricsRegistry::global()
+     *
+     * Game, BankManager and the players count into their thread's
+     * EngineShard (see local()); collect() sums the shards into the
+     * registry handles below, and MetricsExporter calls it before every
+     * scrape and snapshot. The per-game ActionMetrics keep the detailed
+     * latency histograms, and the rate gauges are filled in by
+     * MetricsExporter's sampler.
+     */
+    struct EngineMetrics {
+        Counter *actionsAttempted[ACTION_TYPE_COUNT];   ///< coup_actions_total{action}
+        Counter *actionsSucceeded[ACTION_TYPE_COUNT];   ///< coup_actions_succeeded_total{action}
+        Counter *actionsRejected[REJECT_REASON_COUNT];  ///< coup_actions_rejected_total{reason}
+        Counter *blocks[ROLE_COUNT];                    ///< coup_blocks_total{role}
+        Counter &gamesStarted;
+        Counter &gamesFinished;
+        Gauge &gamesActive;
+        Gauge &bankCoins;               ///< Coins held by the banks of live games
+        Gauge &coinsInCirculation;      ///< Coins paid out by live banks and not yet returned
+        Counter &bankPayouts;           ///< coup_bank_transfers_total{direction="to_player"}
+        Counter &bankReturns;           ///< coup_bank_transfers_total{direction="to_bank"}
+        Counter &playerTransfers;       ///< coup_bank_transfers_total{direction="player_to_player"}
+        Histogram &gameDuration;        ///< Seconds from start to winner (observed once per game, not sharded)
+        Gauge &actionsPerSecond;
+        Gauge &blocksPerSecond;
+        Gauge &gamesFinishedPerSecond;
+
+        /**
+         * @brief The engine's metric handles (registered on first use)
+         */
+        static EngineMetrics &get();
+
+        /**
+         * @brief The calling thread's shard (created on the thread's first use)
+         */
+        static EngineShard &local();
+
+        /**
+         * @brief Sum every shard into the registry counters and gauges
+         */
+        void collect();
+
+        /**
+         * @brief Sum of coup_actions_total over all actions, across shards
+         */
+        std::uint64_t totalActions() const;
+
+        /**
+         * @brief Sum of coup_blocks_total over all roles, across shards
+         */
+        std::uint64_t totalBlocks() const;
+
+    private:
+        explicit EngineMetrics(MetricsRegistry &registry);
+    };
+
+}
+
+#endif // ENGINE_METRICS_HPP
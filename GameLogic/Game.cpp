@@ -2,33 +2,103 @@
 
 #include "Game.hpp"
 #include "Logger.hpp"
+#include "Tracer.hpp"
+#include "EngineMetrics.hpp"
+#include "PlayerFactory.hpp"
+#include "Snapshot.hpp"
 #include "../Players/Player.hpp"
 #include <stdexcept>
-#include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <random>
 
 namespace coup {
 
-    Game::Game()
+    namespace {
+        std::uint64_t freshSeed() {
+            std::random_device rd;
+            return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+        }
+    }
+
+    Game::Game() : Game(freshSeed()) {}
+
+    Game::Game(std::uint64_t seed)
         : current_turn_index(0), bankCoins(200), isConsoleMode(true),
           pendingActionActor(nullptr), pendingActionType(ActionType::None), pendingActionTarget(nullptr),
-          lastWinnerName("") {
-        Logger::log("New game initialized with 200 coins in the bank.");
+          lastWinnerName(""), rng(seed), bulkSetupInProgress(false), coinsIssued(0), startedNs(0) {
+        startMetrics();
+        Logger::log("New game initialized with 200 coins in the bank (seed " + std::to_string(seed) + ").");
     }
 
     Game::~Game() {
         Logger::log("Game destructor called - cleaning up");
+        stopMetrics();
         player_list.clear();
+        ownedPlayers.clear();
         Logger::log("Game cleanup completed");
     }
 
+    void Game::startMetrics() {
+        EngineShard &shard = EngineMetrics::local();
+        EngineShard::add(shard.gamesStarted);
+        EngineShard::add(shard.gamesActive);
+        EngineShard::add(shard.bankCoins, bankCoins);
+        startedNs = metricsClockNs();
+    }
+
+    void Game::stopMetrics() {
+        EngineShard &shard = EngineMetrics::local();
+        EngineShard::add(shard.gamesActive, -1);
+        EngineShard::add(shard.bankCoins, -bankCoins);
+        EngineShard::add(shard.coinsInCirculation, -coinsIssued);
+    }
+
+    void Game::subscribe(GameObserver *observer) {
+        if (observer && std::find(observers.begin(), observers.end(), observer) == observers.end()) {
+            observers.push_back(observer);
+        }
+    }
+
+    void Game::unsubscribe(GameObserver *observer) {
+        observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    }
+
+    void Game::publish(const GameEvent &event) {
+        for (GameObserver *observer : observers) {
+            observer->onGameEvent(*this, event);
+        }
+    }
+
+    const char *gameEventName(GameEventType type) {
+        switch (type) {
+            case GameEventType::PlayerJoined: return "player_joined";
+            case GameEventType::CoinsChanged: return "coins_changed";
+            case GameEventType::SanctionChanged: return "sanction_changed";
+            case GameEventType::ArrestStatusChanged: return "arrest_status_changed";
+            case GameEventType::ArrestBlockedChanged: return "arrest_blocked_changed";
+            case GameEventType::PlayerEliminated: return "player_eliminated";
+            case GameEventType::TurnAdvanced: return "turn_advanced";
+            case GameEventType::PendingActionSet: return "pending_action_set";
+            case GameEventType::PendingActionResolved: return "pending_action_resolved";
+            case GameEventType::GameOver: return "game_over";
+            default: return "unknown";
+        }
+    }
+
     void Game::addPlayer(Player *player) {
+        if (bulkSetupInProgress) {
+            // setup() has already validated the whole table
+            player_list.push_back(player);
+            notify(GameEventType::PlayerJoined, player);
+            return;
+        }
         if (!lastWinnerName.empty()) {
             throw std::runtime_error("Cannot add players after game has ended. Please reset the game.");
         }
-        if (player_list.size() >= 6) {
-            throw std::runtime_error("Cannot add more than 6 players");
+        if (player_list.size() >= MAX_PLAYERS) {
+            throw std::runtime_error("Cannot add more than " + std::to_string(MAX_PLAYERS) + " players");
         }
         for (auto *p : player_list) {
             if (p && p->getName() == player->getName()) {
@@ -37,12 +107,67 @@ namespace coup {
         }
         player_list.push_back(player);
         Logger::log("Player '" + player->getName() + "' added to the game. Total players: " + std::to_string(player_list.size()));
+        notify(GameEventType::PlayerJoined, player);
 
         if (player_list.size() < 2) {
             Logger::log("Warning: less than 2 players — game cannot start.");
         }
     }
 
+    Game::PlayerList Game::setup(const std::vector<std::string> &names, const std::vector<Role> &roles) {
+        if (!player_list.empty() || !lastWinnerName.empty()) {
+            throw std::runtime_error("Game setup requires an empty game. Please reset the game.");
+        }
+        if (names.size() < 2 || names.size() > MAX_PLAYERS) {
+            throw std::runtime_error("Game setup needs 2-" + std::to_string(MAX_PLAYERS) + " players");
+        }
+        if (roles.size() != names.size()) {
+            throw std::runtime_error("Game setup needs exactly one role per player");
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i].empty()) {
+                throw std::runtime_error("Player name cannot be empty");
+            }
+            for (size_t j = 0; j < i; ++j) {
+                if (names[j] == names[i]) {
+                    throw std::runtime_error("Player name already exists: " + names[i]);
+                }
+            }
+        }
+
+        player_list.reserve(names.size());
+        ownedPlayers.reserve(names.size());
+        PlayerList created;
+        bulkSetupInProgress = true;
+        try {
+            for (size_t i = 0; i < names.size(); ++i) {
+                ownedPlayers.emplace_back(createPlayer(*this, names[i], roles[i]));
+                created.push_back(ownedPlayers.back().get());
+            }
+        } catch (...) {
+            bulkSetupInProgress = false;
+            player_list.clear();
+            ownedPlayers.clear();
+            throw;
+        }
+        bulkSetupInProgress = false;
+
+        std::string summary = "Game setup with " + std::to_string(created.size()) + " players:";
+        for (Player *p : created) {
+            summary += " " + p->getName() + " (" + p->getRoleName() + ")";
+        }
+        Logger::log(summary);
+        return created;
+    }
+
+    Game::PlayerList Game::setup(const std::vector<std::string> &names) {
+        if (names.size() > MAX_PLAYERS) {
+            throw std::runtime_error("Game setup needs 2-" + std::to_string(MAX_PLAYERS) + " players");
+        }
+        InlineVector<Role, MAX_PLAYERS> drawn = drawBalancedRoles(rng, names.size());
+        return setup(names, std::vector<Role>(drawn.begin(), drawn.end()));
+    }
+
     /**
      * @brief Gets the name of the current player whose turn it is
      * @return Current player's name
@@ -104,6 +229,7 @@ namespace coup {
         // Verify we found a valid player
         if (player_list[current_turn_index] != nullptr) {
             Logger::log("Next turn: " + player_list[current_turn_index]->getName());
+            notify(GameEventType::TurnAdvanced, player_list[current_turn_index]);
         } else {
             Logger::log("Warning: Could not advance to next alive player");
         }
@@ -111,16 +237,14 @@ namespace coup {
 
     std::vector<std::string> Game::players() const {
         std::vector<std::string> active_players;
-        for (auto *p : player_list) {
-            if (p != nullptr) {
-                active_players.push_back(p->getName());
-            }
-        }
-        std::ostringstream oss;
-        for (const auto &n : active_players) {
-            oss << n << " ";
-        }
-        Logger::log("Active players: " + oss.str());
+        active_players.reserve(aliveCount());
+        std::string names = "Active players: ";
+        for (Player *p : alivePlayers()) {
+            active_players.push_back(p->getName());
+            names += active_players.back();
+            names += ' ';
+        }
+        Logger::log(names);
         return active_players;
     }
 
@@ -128,6 +252,10 @@ namespace coup {
         if (coins < 0) {
             throw std::runtime_error("Bank cannot hold negative coins");
         }
+        EngineShard &shard = EngineMetrics::local();
+        EngineShard::add(shard.bankCoins, coins - bankCoins);
+        EngineShard::add(shard.coinsInCirculation, bankCoins - coins);
+        coinsIssued += bankCoins - coins;
         bankCoins = coins;
         Logger::log("Bank coins set to " + std::to_string(bankCoins));
     }
@@ -145,6 +273,111 @@ namespace coup {
         return false;
     }
 
+    int Game::seatOf(const Player *player) const {
+        for (size_t i = 0; i < player_list.size(); ++i) {
+            if (player && player_list[i] == player) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    int Game::snapshotSeatOf(const Player *player) const {
+        if (!player) {
+            return -1;
+        }
+        int seat = seatOf(player);
+        // Eliminated seats are empty; setup() players keep their seat order in ownedPlayers
+        if (seat < 0 && ownedPlayers.size() == player_list.size()) {
+            for (size_t i = 0; i < ownedPlayers.size(); ++i) {
+                if (ownedPlayers[i].get() == player) {
+                    return static_cast<int>(i);
+                }
+            }
+        }
+        return seat;
+    }
+
+    void Game::saveSnapshot(GameSnapshot &out) const {
+        if (player_list.size() > MAX_PLAYERS) {
+            throw std::runtime_error("Cannot snapshot more than " + std::to_string(MAX_PLAYERS) + " players");
+        }
+        if (bankCoins > INT16_MAX) {
+            throw std::runtime_error("Bank coins do not fit in a snapshot");
+        }
+        std::memset(&out, 0, sizeof(out));
+        out.magic = SNAPSHOT_MAGIC;
+        out.version = SNAPSHOT_VERSION;
+        out.playerCount = static_cast<std::uint8_t>(player_list.size());
+        out.currentSeat = static_cast<std::uint8_t>(current_turn_index);
+        out.seed = rng.getSeed();
+        out.rngPosition = rng.getPosition();
+        out.bankCoins = static_cast<std::int16_t>(bankCoins);
+
+        auto seatByte = [this](const Player *player) {
+            int seat = snapshotSeatOf(player);
+            return seat < 0 ? SNAPSHOT_NO_SEAT : static_cast<std::uint8_t>(seat);
+        };
+        bool ownedInSeatOrder = ownedPlayers.size() == player_list.size();
+        for (size_t seat = 0; seat < player_list.size(); ++seat) {
+            PlayerSnapshot &record = out.players[seat];
+            const Player *player = player_list[seat] ? player_list[seat]
+                                 : ownedInSeatOrder ? ownedPlayers[seat].get() : nullptr;
+            if (!player) {
+                continue;  // eliminated player the game does not own: identity is gone
+            }
+            player->saveState(record);
+            record.lastActionTarget = seatByte(player->getLastActionTarget());
+            if (player_list[seat]) {
+                record.flags |= SNAPSHOT_ALIVE;
+            }
+        }
+        out.pendingActor = seatByte(pendingActionActor);
+        out.pendingAction = static_cast<std::uint8_t>(pendingActionType);
+        out.pendingTarget = seatByte(pendingActionTarget);
+    }
+
+    Game::PlayerList Game::loadSnapshot(const GameSnapshot &snapshot) {
+        validateSnapshot(snapshot);
+        bool console = isConsoleMode;
+        resetGame();
+        isConsoleMode = console;
+        rng.reseed(snapshot.seed);
+        rng.discard(snapshot.rngPosition);
+
+        std::vector<std::string> names;
+        std::vector<Role> roles;
+        for (size_t seat = 0; seat < snapshot.playerCount; ++seat) {
+            const PlayerSnapshot &record = snapshot.players[seat];
+            names.push_back(record.nameLength > 0 ? std::string(record.getName()) : "#" + std::to_string(seat));
+            roles.push_back(record.getRole());
+        }
+        PlayerList table = setup(names, roles);
+
+        setBankCoins(snapshot.bankCoins);
+        for (size_t seat = 0; seat < table.size(); ++seat) {
+            std::uint8_t target = snapshot.players[seat].lastActionTarget;
+            table[seat]->restoreState(snapshot.players[seat], target == SNAPSHOT_NO_SEAT ? nullptr : table[target]);
+        }
+        for (size_t seat = 0; seat < table.size(); ++seat) {
+            if (!snapshot.players[seat].has(SNAPSHOT_ALIVE)) {
+                player_list[seat] = nullptr;
+                notify(GameEventType::PlayerEliminated, table[seat]);
+            }
+        }
+        current_turn_index = snapshot.currentSeat;
+        if (snapshot.pendingActor != SNAPSHOT_NO_SEAT) {
+            setPendingAction(table[snapshot.pendingActor], static_cast<ActionType>(snapshot.pendingAction),
+                             snapshot.pendingTarget == SNAPSHOT_NO_SEAT ? nullptr : table[snapshot.pendingTarget]);
+        }
+        if (player_list[current_turn_index]) {
+            notify(GameEventType::TurnAdvanced, player_list[current_turn_index]);
+        }
+        Logger::log("Game restored from snapshot: " + std::to_string(table.size()) + " seats, " +
+                    std::to_string(aliveCount()) + " alive");
+        return table;
+    }
+
     /**
      * @brief Eliminates a player from the game by setting their slot to nullptr
      * @param player Reference to the player to eliminate
@@ -170,6 +403,7 @@ namespace coup {
             Logger::log("Warning: Player '" + player.getName() + "' was not found in the game for elimination");
             return;
         }
+        notify(GameEventType::PlayerEliminated, &player);
 
         // Check for immediate game over after elimination
         if (isGameOver()) {
@@ -178,6 +412,9 @@ namespace coup {
                 if (p != nullptr) {
                     lastWinnerName = p->getName();
                     Logger::log("Game over detected! Winner declared: " + lastWinnerName);
+                    EngineShard::add(EngineMetrics::local().gamesFinished);
+                    EngineMetrics::get().gameDuration.observe((metricsClockNs() - startedNs) / 1e9);
+                    notify(GameEventType::GameOver, p);
                     break;
                 }
             }
@@ -189,13 +426,7 @@ namespace coup {
     }
 
     bool Game::isGameOver() const {
-        int alive_count = 0;
-        for (auto *p : player_list) {
-            if (p != nullptr) {
-                ++alive_count;
-            }
-        }
-        return alive_count <= 1; // Changed to <= 1 for safety (handles 0 or 1 players)
+        return aliveCount() <= 1; // Changed to <= 1 for safety (handles 0 or 1 players)
     }
 
     /**
@@ -230,13 +461,18 @@ namespace coup {
     void Game::resetGame() {
         Logger::log("Resetting game...");
         player_list.clear();
+        ownedPlayers.clear();
         current_turn_index = 0;
+        stopMetrics();
         bankCoins = 200;
+        coinsIssued = 0;
+        startMetrics();
         pendingActionActor = nullptr;
         pendingActionType = ActionType::None;
         pendingActionTarget = nullptr;
         lastWinnerName.clear();
         isConsoleMode = true;
+        rng.reseed(rng.getSeed());
     }
 
     void Game::setPendingAction(Player *actor, ActionType actionType, Player *target) {
@@ -244,6 +480,9 @@ namespace coup {
         pendingActionType = actionType;
         pendingActionTarget = target;
         Logger::log("Pending action set: " + actor->getName() + " -> " + std::to_string(static_cast<int>(actionType)));
+        if (!observers.empty()) {
+            publish(GameEvent{GameEventType::PendingActionSet, actor, target, actionType, 0, 0});
+        }
     }
 
     bool Game::hasPendingAction() const {
@@ -255,12 +494,17 @@ namespace coup {
     }
 
     void Game::resolvePendingAction() {
+        Player *actor = pendingActionActor;
+        ActionType action = pendingActionType;
         if (pendingActionActor) {
             Logger::log("Resolving pending action for " + pendingActionActor->getName());
         }
         pendingActionActor = nullptr;
         pendingActionType = ActionType::None;
         pendingActionTarget = nullptr;
+        if (actor && !observers.empty()) {
+            publish(GameEvent{GameEventType::PendingActionResolved, actor, nullptr, action, 0, 0});
+        }
     }
 
     void Game::requestImmediateResponse(Player *actor, ActionType action, Player *target) {
@@ -286,13 +530,36 @@ namespace coup {
      * valid player pointers.
      */
     std::vector<Player*> Game::getAllAlivePlayers() const {
-        std::vector<Player*> alive;
+        return std::vector<Player*>(alivePlayers().begin(), alivePlayers().end());
+    }
+
+    std::size_t Game::fillAlivePlayers(Player **out, std::size_t capacity) const {
+        std::size_t written = 0;
+        for (Player *p : alivePlayers()) {
+            if (written >= capacity) {
+                break;
+            }
+            out[written++] = p;
+        }
+        return written;
+    }
+
+    Game::PlayerList Game::getAlivePlayerList() const {
+        PlayerList alive;
+        for (Player *p : alivePlayers()) {
+            alive.push_back(p);
+        }
+        return alive;
+    }
+
+    std::size_t Game::aliveCount() const {
+        std::size_t count = 0;
         for (auto *p : player_list) {
             if (p != nullptr) {
-                alive.push_back(p);
+                ++count;
             }
         }
-        return alive;
+        return count;
     }
 
     /**
@@ -346,10 +613,11 @@ namespace coup {
      * ENHANCED: Added safety checks for nullptr players during iteration.
      */
     bool Game::checkForBlocking(Player* actor, ActionType action, Player* target) {
+        TraceSpan span("Game::checkForBlocking", "engine");
         Logger::log("Checking if anyone wants to block " + actor->getName() + "'s " + getActionName(action));
+        std::uint64_t startNs = metricsClockNs();
         
-        auto alivePlayers = getAllAlivePlayers();
-        for (Player* p : alivePlayers) {
+        for (Player* p : alivePlayers()) {
             // Skip if same player or nullptr (extra safety)
             if (p == actor || p == nullptr) continue;
             
@@ -363,16 +631,19 @@ namespace coup {
                     std::cin >> choice;
                     if (choice == 'y' || choice == 'Y') {
                         executeBlock(p, action, actor, target);
+                        metrics.recordBlockLatency(action, metricsClockNs() - startNs);
                         return true;
                     }
                 } else {
                     if (p->askForBlock(action, actor, target)) {
                         executeBlock(p, action, actor, target);
+                        metrics.recordBlockLatency(action, metricsClockNs() - startNs);
                         return true;
                     }
                 }
             }
         }
+        metrics.recordBlockLatency(action, metricsClockNs() - startNs);
         return false;
     }
 
@@ -414,10 +685,12 @@ namespace coup {
                 setBankCoins(getBankCoins() + actor->taxAmount());
                 Logger::log("Governor blocked tax - " + std::to_string(actor->taxAmount()) + " coins returned to bank");
             }
+            metrics.recordBlock(action, Role::Governor);
         }
         else if (blocker->getRoleName() == "Judge" && action == ActionType::Bribe) {
             actor->blockLastAction();
             Logger::log("Judge blocked bribe - " + actor->getName() + " loses 4 coins permanently");
+            metrics.recordBlock(action, Role::Judge);
         }
         else if (blocker->getRoleName() == "General" && action == ActionType::Coup) {
             blocker->setCoins(blocker->getCoins() - 5);
@@ -425,6 +698,7 @@ namespace coup {
             
             // Fixed: Removed problematic loop that served no purpose
             Logger::log("General blocked coup - paid 5 coins, " + (target ? target->getName() : "target") + " is safe");
+            metrics.recordBlock(action, Role::General);
         }
         
         actor->blockLastAction();
@@ -7,10 +7,17 @@
 #include <vector>
 #include <memory>
 #include "ActionType.hpp"
+#include "ActionMetrics.hpp"
+#include "GameEvents.hpp"
+#include "InlineVector.hpp"
+#include "PlayerRange.hpp"
+#include "Rng.hpp"
+#include "Role.hpp"
 
 namespace coup {
 
     class Player;  // forward declaration
+    struct GameSnapshot;
 
     /**
      * @class Game
@@ -24,6 +31,10 @@ namespace coup {
      * - Win condition checking
      */
     class Game {
+    public:
+        static constexpr std::size_t MAX_PLAYERS = 6;              ///< Maximum players per game
+        using PlayerList = InlineVector<Player *, MAX_PLAYERS>;    ///< Allocation-free player list
+
     private:
         std::vector<Player *> player_list;     ///< List of all players in the game
         size_t current_turn_index;             ///< Index of the current player's turn
@@ -33,6 +44,29 @@ namespace coup {
         Player *pendingActionTarget;           ///< Target of the last action (if any)
         std::string lastWinnerName;            ///< Name of the winner (cached for game reset)
         bool isConsoleMode;                    ///< Whether game is in console mode or GUI mode
+        Rng rng;                               ///< Per-game random stream (role draws etc.)
+        std::vector<std::unique_ptr<Player>> ownedPlayers; ///< Players created by setup()
+        bool bulkSetupInProgress;              ///< Whether setup() is registering players
+        ActionMetrics metrics;                 ///< Per-action counters and latency histograms
+        int coinsIssued;                       ///< Coins paid out by this bank (for EngineMetrics)
+        std::uint64_t startedNs;               ///< When the game started (metricsClockNs)
+        std::vector<GameObserver *> observers; ///< Change-event subscribers (not owned)
+
+        /**
+         * @brief Count this game as started and its bank into EngineMetrics
+         */
+        void startMetrics();
+
+        /**
+         * @brief Remove this game's bank and issued coins from EngineMetrics
+         */
+        void stopMetrics();
+
+        /**
+         * @brief Seat of a player, eliminated players of setup() included
+         * @return Seat index, or -1 if unknown
+         */
+        int snapshotSeatOf(const Player *player) const;
 
     public:
         /**
@@ -40,6 +74,12 @@ namespace coup {
          * Sets bank to 200 coins and prepares for player registration
          */
         Game();
+
+        /**
+         * @brief Constructor with an explicit seed for reproducible games
+         * @param seed Seed for the game's random stream
+         */
+        explicit Game(std::uint64_t seed);
         
         /**
          * @brief Destructor - cleans up game resources
@@ -59,6 +99,33 @@ namespace coup {
          */
         void addPlayer(Player *player);
         
+        /**
+         * @brief Creates and registers all players in one pass
+         * 
+         * Names are validated together up front, storage is reserved once and
+         * a single summary line is logged. The game owns the created players.
+         * 
+         * @param names Player names in turn order
+         * @param roles Role for each name (same length as names)
+         * @return Created players in turn order
+         * @throws std::runtime_error if the game already has players, the
+         *         count is outside 2-6, the lengths differ, or a name is
+         *         empty or duplicated
+         */
+        PlayerList setup(const std::vector<std::string> &names, const std::vector<Role> &roles);
+
+        /**
+         * @brief Creates all players with a shuffled, balanced role draw
+         * 
+         * Roles come from the game's random stream, so the same seed always
+         * deals the same roles; no role is dealt twice.
+         * 
+         * @param names Player names in turn order
+         * @return Created players in turn order
+         * @throws std::runtime_error on the same conditions as the role overload
+         */
+        PlayerList setup(const std::vector<std::string> &names);
+
         /**
          * @brief Gets the name of the player whose turn it is
          * @return Current player's name
@@ -96,6 +163,13 @@ namespace coup {
          * @return true if player is alive, false if eliminated
          */
         bool isAlive(const Player &player) const;
+
+        /**
+         * @brief Seat of a player: join order, unchanged by other eliminations
+         * @param player Player to look up
+         * @return Seat index, or -1 if the player is not seated or was eliminated
+         */
+        int seatOf(const Player *player) const;
         
         /**
          * @brief Eliminates a player from the game
@@ -167,6 +241,34 @@ namespace coup {
          * @return Vector of pointers to alive players
          */
         std::vector<Player*> getAllAlivePlayers() const;
+
+        /**
+         * @brief Gets a non-allocating view over the players still alive
+         * @return Range of alive player pointers in turn order
+         */
+        AlivePlayerRange alivePlayers() const {
+            return AlivePlayerRange(player_list.data(), player_list.data() + player_list.size());
+        }
+
+        /**
+         * @brief Copies alive players into a caller-provided buffer
+         * @param out Destination buffer
+         * @param capacity Number of slots available in out
+         * @return Number of players written (at most capacity)
+         */
+        std::size_t fillAlivePlayers(Player **out, std::size_t capacity) const;
+
+        /**
+         * @brief Gets all players still alive without heap allocation
+         * @return Inline list of alive player pointers
+         */
+        PlayerList getAlivePlayerList() const;
+
+        /**
+         * @brief Counts the players still alive
+         * @return Number of alive players
+         */
+        std::size_t aliveCount() const;
         
         /**
          * @brief Gets the current player
@@ -209,6 +311,99 @@ namespace coup {
          */
         void executeBlock(Player* blocker, ActionType action, Player* actor, Player* target);
 
+        /**
+         * @brief Gets the game's random stream
+         * @return Reference to the per-game generator
+         */
+        Rng &getRng() { return rng; }
+
+        /**
+         * @brief Gets the seed the game's random stream started from
+         * @return Seed value (replaying with it reproduces all draws)
+         */
+        std::uint64_t getSeed() const { return rng.getSeed(); }
+
+        /**
+         * @brief Restarts the game's random stream
+         * @param seed New seed
+         */
+        void setSeed(std::uint64_t seed) { rng.reseed(seed); }
+
+        /**
+         * @brief Captures the whole game state (see GameSnapshot)
+         * @param out Snapshot to fill
+         * @throws std::runtime_error if a player has no role, a name longer than
+         *         SNAPSHOT_NAME_CAPACITY, or coins that do not fit
+         */
+        void saveSnapshot(GameSnapshot &out) const;
+
+        /**
+         * @brief Resets the game and restores a snapshot into it
+         *
+         * Creates one owned player per seat and publishes the restored state
+         * to observers (joins, coins, statuses, eliminations, current turn).
+         * An eliminated seat saved without its player gets the name "#<seat>".
+         *
+         * @param snapshot Snapshot to restore (validated first)
+         * @return Players in seat order, eliminated seats included
+         * @throws std::runtime_error if the snapshot is malformed
+         */
+        PlayerList loadSnapshot(const GameSnapshot &snapshot);
+
+        /**
+         * @brief Gets the live action metrics (players record into these)
+         * @return Reference to the game's metrics
+         */
+        ActionMetrics &getMetrics() { return metrics; }
+
+        /**
+         * @brief Copies per-action counters and latency histograms
+         * @return Snapshot safe to read while the game keeps running
+         */
+        MetricsSnapshot metricsSnapshot() const { return metrics.snapshot(); }
+
+        /**
+         * @brief Zeroes all action metrics (resetGame() keeps them)
+         */
+        void resetMetrics() { metrics.reset(); }
+
+        /**
+         * @brief Registers an observer for change events (no-op if already subscribed)
+         * @param observer Observer to notify (not owned)
+         */
+        void subscribe(GameObserver *observer);
+
+        /**
+         * @brief Removes an observer (no-op if not subscribed)
+         * @param observer Observer to remove
+         */
+        void unsubscribe(GameObserver *observer);
+
+        /**
+         * @brief Whether anyone listens for change events
+         * @return true if at least one observer is subscribed
+         */
+        bool hasObservers() const { return !observers.empty(); }
+
+        /**
+         * @brief Delivers an event to every observer (callers skip this when hasObservers() is false)
+         * @param event Change that was just applied
+         */
+        void publish(const GameEvent &event);
+
+        /**
+         * @brief Publishes an event about one player if anyone listens
+         * @param type Event type
+         * @param player Player the change is about
+         * @param oldValue Value before the change
+         * @param newValue Value after the change
+         */
+        void notify(GameEventType type, Player *player, int oldValue = 0, int newValue = 0) {
+            if (!observers.empty()) {
+                publish(GameEvent{type, player, nullptr, ActionType::None, oldValue, newValue});
+            }
+        }
+
         /**
          * @brief Sets console mode on/off
          * @param console true for console mode, false for GUI mode
@@ -0,0 +1,80 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef GAME_EVENTS_HPP
+#define GAME_EVENTS_HPP
+
+#include "ActionType.hpp"
+#include <cstdint>
+
+namespace coup {
+
+    class Game;    // forward declaration
+    class Player;  // forward declaration
+
+    /**
+     * @enum GameEventType
+     * @brief Kinds of state change published by Game
+     */
+    enum class GameEventType : std::uint8_t {
+        PlayerJoined,           ///< player registered with the game
+        CoinsChanged,           ///< player's coins: oldValue -> newValue
+        SanctionChanged,        ///< player's sanction flag: oldValue -> newValue (0/1)
+        ArrestStatusChanged,    ///< player's ArrestStatus: oldValue -> newValue
+        ArrestBlockedChanged,   ///< player's arrest-blocked flag: oldValue -> newValue (0/1)
+        PlayerEliminated,       ///< player removed from the game
+        TurnAdvanced,           ///< player is now the current player
+        PendingActionSet,       ///< player performed action on target (may be nullptr)
+        PendingActionResolved,  ///< the pending action by player was cleared
+        GameOver                ///< player is the winner
+    };
+
+    constexpr int GAME_EVENT_TYPE_COUNT = 10;  ///< Number of GameEventType values
+
+    /**
+     * @struct GameEvent
+     * @brief One state change; fields not used by the event type are zero/nullptr
+     */
+    struct GameEvent {
+        GameEventType type;
+        Player *player;       ///< Player the change is about
+        Player *target;       ///< Target of a pending action
+        ActionType action;    ///< Action of a pending-action event
+        int oldValue;         ///< Value before the change
+        int newValue;         ///< Value after the change
+    };
+
+    /**
+     * @class GameObserver
+     * @brief Receives a game's change events as they happen
+     *
+     * Subscribed with Game::subscribe(); the game holds a non-owning pointer,
+     * so the observer must unsubscribe (or outlive the game). Events are
+     * delivered synchronously on the thread that changed the game, in the
+     * order the changes happened. An observer must not subscribe or
+     * unsubscribe observers from inside onGameEvent(), and should not throw.
+     */
+    class GameObserver {
+    public:
+        /**
+         * @brief Virtual destructor
+         */
+        virtual ~GameObserver() = default;
+
+        /**
+         * @brief Called after a change has been applied
+         * @param game Game that changed
+         * @param event What changed
+         */
+        virtual void onGameEvent(Game &game, const GameEvent &event) = 0;
+    };
+
+    /**
+     * @brief Stable lowercase name of an event type (e.g. "coins_changed")
+     * @param type Event type
+     * @return Name string with static storage
+     */
+    const char *gameEventName(GameEventType type);
+
+}
+
+#endif // GAME_EVENTS_HPP
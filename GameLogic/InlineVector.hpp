@@ -0,0 +1,71 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef INLINE_VECTOR_HPP
+#define INLINE_VECTOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+namespace coup {
+
+    /**
+     * @class InlineVector
+     * @brief Fixed-capacity vector stored entirely inline (no heap allocation)
+     *
+     * Intended for small, bounded collections such as per-game player lists.
+     *
+     * @tparam T Element type (must be default constructible)
+     * @tparam N Maximum number of elements
+     */
+    template <typename T, std::size_t N>
+    class InlineVector {
+    private:
+        std::array<T, N> items;   ///< Inline element storage
+        std::size_t count;        ///< Number of elements in use
+
+    public:
+        using value_type = T;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        /**
+         * @brief Default constructor - creates an empty vector
+         */
+        InlineVector() : items(), count(0) {}
+
+        /**
+         * @brief Append an element
+         * @param value Element to append
+         * @throws std::runtime_error if capacity is exceeded
+         */
+        void push_back(const T &value) {
+            if (count >= N) {
+                throw std::runtime_error("InlineVector capacity exceeded");
+            }
+            items[count++] = value;
+        }
+
+        /**
+         * @brief Remove all elements
+         */
+        void clear() { count = 0; }
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        static constexpr std::size_t capacity() { return N; }
+
+        T &operator[](std::size_t index) { return items[index]; }
+        const T &operator[](std::size_t index) const { return items[index]; }
+        T &back() { return items[count - 1]; }
+        const T &back() const { return items[count - 1]; }
+
+        iterator begin() { return items.data(); }
+        iterator end() { return items.data() + count; }
+        const_iterator begin() const { return items.data(); }
+        const_iterator end() const { return items.data() + count; }
+    };
+
+}
+
+#endif // INLINE_VECTOR_HPP
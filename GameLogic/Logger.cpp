@@ -3,7 +3,12 @@
 
 namespace coup {
 
+    bool Logger::enabled = true;
+
     void Logger::log(const std::string& message) {
+        if (!enabled) {
+            return;
+        }
         std::cout << "[LOG] " << message << std::endl;
     }
 
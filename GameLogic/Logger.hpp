@@ -15,14 +15,29 @@ namespace coup {
      * Can be extended to support file logging or different log levels
      */
     class Logger {
+    private:
+        static bool enabled;  ///< Whether messages are written
+
     public:
         /**
          * @brief Log a message to console
          * @param message Message to log
          */
         static void log(const std::string& message);
+
+        /**
+         * @brief Turn console logging on or off (e.g. for headless simulation)
+         * @param on true to write messages
+         */
+        static void setEnabled(bool on) { enabled = on; }
+
+        /**
+         * @brief Check whether logging is on
+         * @return true if messages are written
+         */
+        static bool isEnabled() { return enabled; }
     };
 
 }
 
-#endif // LOGGER_HPP
\ No newline at end of file
+#endif // LOGGER_HPP
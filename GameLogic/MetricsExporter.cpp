@@ -0,0 +1,241 @@
+// Email: nitzanwa@gmail.com
+
+#include "MetricsExporter.hpp"
+#include "EngineMetrics.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        void sendAll(int fd, const std::string &data) {
+            std::size_t sent = 0;
+            while (sent < data.size()) {
+                ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    if (n < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    return;
+                }
+                sent += static_cast<std::size_t>(n);
+            }
+        }
+
+        std::string httpResponse(const std::string &status, const std::string &type, const std::string &body) {
+            return "HTTP/1.1 " + status + "\r\nContent-Type: " + type +
+                   "\r\nContent-Length: " + std::to_string(body.size()) +
+                   "\r\nConnection: close\r\n\r\n" + body;
+        }
+    }
+
+    MetricsExporter::MetricsExporter(MetricsRegistry &registry, double sampleIntervalSeconds)
+        : registry(registry), listenFd(-1), port(0), fileIntervalSeconds(5.0),
+          sampleIntervalSeconds(sampleIntervalSeconds), stopping(false), lastActions(0), lastBlocks(0),
+          lastFinished(0), lastSampleNs(0) {
+        EngineMetrics &engine = EngineMetrics::get();
+        lastActions = engine.totalActions();
+        lastBlocks = engine.totalBlocks();
+        engine.collect();
+        lastFinished = engine.gamesFinished.get();
+        lastSampleNs = metricsClockNs();
+    }
+
+    MetricsExporter::~MetricsExporter() {
+        try {
+            stop();
+        } catch (...) {
+            // the final snapshot is best effort during destruction
+        }
+    }
+
+    void MetricsExporter::serveHttp(int requestedPort) {
+        if (listenFd >= 0) {
+            throw std::runtime_error("Metrics exporter is already serving HTTP");
+        }
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create metrics socket: " + std::string(std::strerror(errno)));
+        }
+        int reuse = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<std::uint16_t>(requestedPort));
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+            std::string reason = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot listen on metrics port " + std::to_string(requestedPort) + ": " + reason);
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &len);
+        pauseWorker();
+        port = ntohs(addr.sin_port);
+        listenFd = fd;
+        ensureRunning();
+    }
+
+    void MetricsExporter::writeFile(const std::string &path, double intervalSeconds) {
+        if (intervalSeconds <= 0) {
+            throw std::runtime_error("Metrics file interval must be positive");
+        }
+        writeSnapshot(registry, path);
+        pauseWorker();
+        filePath = path;
+        fileIntervalSeconds = intervalSeconds;
+        ensureRunning();
+    }
+
+    void MetricsExporter::stop() {
+        pauseWorker();
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            listenFd = -1;
+            port = 0;
+        }
+        if (!filePath.empty()) {
+            std::string path = filePath;
+            filePath.clear();
+            writeSnapshot(registry, path);
+        }
+    }
+
+    void MetricsExporter::sampleRates() {
+        EngineMetrics &engine = EngineMetrics::get();
+        engine.collect();
+        std::uint64_t now = metricsClockNs();
+        std::uint64_t actions = engine.totalActions();
+        std::uint64_t blocks = engine.totalBlocks();
+        std::uint64_t finished = engine.gamesFinished.get();
+        double seconds = (now - lastSampleNs) / 1e9;
+        if (seconds > 0) {
+            engine.actionsPerSecond.set((actions - lastActions) / seconds);
+            engine.blocksPerSecond.set((blocks - lastBlocks) / seconds);
+            engine.gamesFinishedPerSecond.set((finished - lastFinished) / seconds);
+        }
+        lastActions = actions;
+        lastBlocks = blocks;
+        lastFinished = finished;
+        lastSampleNs = now;
+    }
+
+    void MetricsExporter::writeSnapshot(const MetricsRegistry &registry, const std::string &path) {
+        EngineMetrics::get().collect();
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("Cannot open metrics file: " + tmp);
+            }
+            registry.writePrometheus(out);
+            if (!out) {
+                throw std::runtime_error("Cannot write metrics file: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace metrics file: " + path);
+        }
+    }
+
+    bool MetricsExporter::startFromEnvironment() {
+        const char *portVar = std::getenv("COUP_METRICS_PORT");
+        const char *fileVar = std::getenv("COUP_METRICS_FILE");
+        if (portVar && *portVar) {
+            serveHttp(std::atoi(portVar));
+        }
+        if (fileVar && *fileVar) {
+            const char *intervalVar = std::getenv("COUP_METRICS_INTERVAL");
+            writeFile(fileVar, intervalVar && *intervalVar ? std::atof(intervalVar) : 5.0);
+        }
+        return (portVar && *portVar) || (fileVar && *fileVar);
+    }
+
+    void MetricsExporter::pauseWorker() {
+        if (worker.joinable()) {
+            stopping.store(true);
+            worker.join();
+            stopping.store(false);
+        }
+    }
+
+    void MetricsExporter::ensureRunning() {
+        if (!worker.joinable()) {
+            worker = std::thread(&MetricsExporter::run, this);
+        }
+    }
+
+    void MetricsExporter::run() {
+        const int tickMs = 50;
+        std::uint64_t nextSample = metricsClockNs() + static_cast<std::uint64_t>(sampleIntervalSeconds * 1e9);
+        std::uint64_t nextFile = metricsClockNs() + static_cast<std::uint64_t>(fileIntervalSeconds * 1e9);
+
+        while (!stopping.load()) {
+            if (listenFd >= 0) {
+                pollfd pfd{listenFd, POLLIN, 0};
+                if (::poll(&pfd, 1, tickMs) > 0 && (pfd.revents & POLLIN)) {
+                    int client = ::accept(listenFd, nullptr, nullptr);
+                    if (client >= 0) {
+                        handleConnection(client);
+                        ::close(client);
+                    }
+                }
+            } else {
+                ::poll(nullptr, 0, tickMs);
+            }
+
+            std::uint64_t now = metricsClockNs();
+            if (now >= nextSample) {
+                sampleRates();
+                nextSample = now + static_cast<std::uint64_t>(sampleIntervalSeconds * 1e9);
+            }
+            if (!filePath.empty() && now >= nextFile) {
+                try {
+                    writeSnapshot(registry, filePath);
+                } catch (const std::exception &) {
+                    // keep serving; the next period retries
+                }
+                nextFile = now + static_cast<std::uint64_t>(fileIntervalSeconds * 1e9);
+            }
+        }
+        // Last sample before stop() writes its final snapshot
+        sampleRates();
+    }
+
+    void MetricsExporter::handleConnection(int fd) {
+        // Only the request line matters; wait briefly for it to arrive
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+            pollfd pfd{fd, POLLIN, 0};
+            if (::poll(&pfd, 1, 1000) <= 0) {
+                return;
+            }
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return;
+            }
+            request.append(buffer, static_cast<std::size_t>(n));
+        }
+
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+            EngineMetrics::get().collect();
+            sendAll(fd, httpResponse("200 OK", "text/plain; version=0.0.4", registry.renderPrometheus()));
+        } else {
+            sendAll(fd, httpResponse("404 Not Found", "text/plain", "not found\n"));
+        }
+    }
+
+}
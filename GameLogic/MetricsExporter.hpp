@@ -0,0 +1,113 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef METRICS_EXPORTER_HPP
+#define METRICS_EXPORTER_HPP
+
+#include "MetricsRegistry.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace coup {
+
+    /**
+     * @class MetricsExporter
+     * @brief Publishes a MetricsRegistry in Prometheus text format
+     *
+     * A background thread refreshes the engine's rate gauges (actions/s,
+     * blocks/s, games finished/s) and, depending on what was started,
+     * answers "GET /metrics" on a 127.0.0.1 HTTP socket and/or rewrites a
+     * snapshot file atomically (temporary file + rename) at a fixed period.
+     * The engine's per-thread counter shards are summed before every scrape
+     * and snapshot. Everything stops when the exporter is destroyed.
+     */
+    class MetricsExporter {
+    private:
+        MetricsRegistry &registry;
+        int listenFd;                    ///< HTTP socket (-1 when not serving)
+        int port;                        ///< Bound HTTP port
+        std::string filePath;            ///< Snapshot file ("" when not writing)
+        double fileIntervalSeconds;
+        double sampleIntervalSeconds;
+        std::atomic<bool> stopping;
+        std::thread worker;
+
+        std::uint64_t lastActions;
+        std::uint64_t lastBlocks;
+        std::uint64_t lastFinished;
+        std::uint64_t lastSampleNs;
+
+        void pauseWorker();
+        void ensureRunning();
+        void run();
+        void handleConnection(int fd);
+
+        /**
+         * @brief Recompute the rate gauges from the counters seen since the last sample
+         *
+         * Worker thread only: the last* fields are not guarded.
+         */
+        void sampleRates();
+
+    public:
+        /**
+         * @brief Constructor
+         * @param registry Registry to export (normally MetricsRegistry::global())
+         * @param sampleIntervalSeconds Period of the rate gauge refresh
+         */
+        explicit MetricsExporter(MetricsRegistry &registry = MetricsRegistry::global(),
+                                 double sampleIntervalSeconds = 1.0);
+        MetricsExporter(const MetricsExporter &other) = delete;
+        MetricsExporter &operator=(const MetricsExporter &other) = delete;
+
+        /**
+         * @brief Destructor - stops the background thread and closes the socket
+         */
+        ~MetricsExporter();
+
+        /**
+         * @brief Serve GET /metrics on 127.0.0.1
+         * @param port TCP port (0 picks a free one, see getPort())
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        void serveHttp(int port);
+
+        /**
+         * @brief Periodically write the exposition text to a file
+         * @param path Destination file (replaced atomically)
+         * @param intervalSeconds Period between snapshots
+         * @throws std::runtime_error if the first snapshot cannot be written
+         */
+        void writeFile(const std::string &path, double intervalSeconds = 5.0);
+
+        /**
+         * @brief Stop serving and writing (a final file snapshot is written)
+         */
+        void stop();
+
+        /**
+         * @brief Port the HTTP endpoint is bound to (0 when not serving)
+         */
+        int getPort() const { return port; }
+
+        /**
+         * @brief Write one snapshot of a registry to a file
+         * @param registry Registry to export
+         * @param path Destination file (replaced atomically)
+         * @throws std::runtime_error if the file cannot be written
+         */
+        static void writeSnapshot(const MetricsRegistry &registry, const std::string &path);
+
+        /**
+         * @brief Start exporting as configured by COUP_METRICS_PORT / COUP_METRICS_FILE
+         * @return true if either variable was set
+         * @throws std::runtime_error if the configured endpoint cannot be started
+         */
+        bool startFromEnvironment();
+    };
+
+}
+
+#endif // METRICS_EXPORTER_HPP
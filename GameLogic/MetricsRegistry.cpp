@@ -0,0 +1,175 @@
+// Email: nitzanwa@gmail.com
+
+#include "MetricsRegistry.hpp"
+
+#include <cmath>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        void addDouble(std::atomic<double> &target, double delta) {
+            double seen = target.load(std::memory_order_relaxed);
+            while (!target.compare_exchange_weak(seen, seen + delta, std::memory_order_relaxed)) {
+            }
+        }
+
+        void writeNumber(std::ostream &out, double v) {
+            if (std::isinf(v)) {
+                out << (v > 0 ? "+Inf" : "-Inf");
+            } else if (v == std::floor(v) && std::fabs(v) < 1e15) {
+                out << static_cast<long long>(v);
+            } else {
+                out << v;
+            }
+        }
+
+        // Sample name with labels, e.g. name{a="x",le="0.5"}
+        void writeSeries(std::ostream &out, const std::string &name, const std::string &labels,
+                         const std::string &extra = "") {
+            out << name;
+            if (!labels.empty() || !extra.empty()) {
+                out << '{' << labels << (!labels.empty() && !extra.empty() ? "," : "") << extra << '}';
+            }
+            out << ' ';
+        }
+    }
+
+    void Gauge::add(double delta) {
+        addDouble(value, delta);
+    }
+
+    Histogram::Histogram(const std::vector<double> &bounds)
+        : bounds(bounds), buckets(new std::atomic<std::uint64_t>[bounds.size() + 1]), count(0), sum(0.0) {
+        for (std::size_t i = 0; i < bounds.size(); ++i) {
+            if (i > 0 && !(bounds[i] > bounds[i - 1])) {
+                throw std::runtime_error("Histogram bounds must be strictly ascending");
+            }
+        }
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void Histogram::observe(double v) {
+        std::size_t i = 0;
+        while (i < bounds.size() && v > bounds[i]) {
+            ++i;
+        }
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        addDouble(sum, v);
+    }
+
+    MetricsRegistry &MetricsRegistry::global() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    MetricsRegistry::Entry *MetricsRegistry::find(const std::string &name, const std::string &labels, Kind kind) {
+        Entry *match = nullptr;
+        for (const auto &entry : entries) {
+            if (entry->name != name) {
+                continue;
+            }
+            if (entry->kind != kind) {
+                throw std::runtime_error("Metric " + name + " is already registered with another type");
+            }
+            if (entry->labels == labels) {
+                match = entry.get();
+            }
+        }
+        return match;
+    }
+
+    Counter &MetricsRegistry::counter(const std::string &name, const std::string &help, const std::string &labels) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Entry *existing = find(name, labels, Kind::Counter)) {
+            return *existing->counter;
+        }
+        std::unique_ptr<Entry> entry(new Entry{Kind::Counter, name, help, labels, nullptr, nullptr, nullptr});
+        entry->counter.reset(new Counter());
+        entries.push_back(std::move(entry));
+        return *entries.back()->counter;
+    }
+
+    Gauge &MetricsRegistry::gauge(const std::string &name, const std::string &help, const std::string &labels) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Entry *existing = find(name, labels, Kind::Gauge)) {
+            return *existing->gauge;
+        }
+        std::unique_ptr<Entry> entry(new Entry{Kind::Gauge, name, help, labels, nullptr, nullptr, nullptr});
+        entry->gauge.reset(new Gauge());
+        entries.push_back(std::move(entry));
+        return *entries.back()->gauge;
+    }
+
+    Histogram &MetricsRegistry::histogram(const std::string &name, const std::string &help,
+                                          const std::vector<double> &bounds, const std::string &labels) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Entry *existing = find(name, labels, Kind::Histogram)) {
+            return *existing->histogram;
+        }
+        std::unique_ptr<Entry> entry(new Entry{Kind::Histogram, name, help, labels, nullptr, nullptr, nullptr});
+        entry->histogram.reset(new Histogram(bounds));
+        entries.push_back(std::move(entry));
+        return *entries.back()->histogram;
+    }
+
+    void MetricsRegistry::writePrometheus(std::ostream &out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::set<std::string> described;
+        for (const auto &first : entries) {
+            if (!described.insert(first->name).second) {
+                continue;
+            }
+            const char *type = first->kind == Kind::Counter ? "counter"
+                             : first->kind == Kind::Gauge ? "gauge" : "histogram";
+            out << "# HELP " << first->name << ' ' << first->help << '\n';
+            out << "# TYPE " << first->name << ' ' << type << '\n';
+
+            // All label sets of this family, grouped under one HELP/TYPE
+            for (const auto &entry : entries) {
+                if (entry->name != first->name) {
+                    continue;
+                }
+                if (entry->kind == Kind::Counter) {
+                    writeSeries(out, entry->name, entry->labels);
+                    out << entry->counter->get() << '\n';
+                } else if (entry->kind == Kind::Gauge) {
+                    writeSeries(out, entry->name, entry->labels);
+                    writeNumber(out, entry->gauge->get());
+                    out << '\n';
+                } else {
+                    const Histogram &h = *entry->histogram;
+                    std::uint64_t cumulative = 0;
+                    for (std::size_t i = 0; i <= h.getBounds().size(); ++i) {
+                        cumulative += h.bucketCount(i);
+                        std::ostringstream le;
+                        le << "le=\"";
+                        writeNumber(le, i < h.getBounds().size() ? h.getBounds()[i]
+                                                                 : std::numeric_limits<double>::infinity());
+                        le << '"';
+                        writeSeries(out, entry->name + "_bucket", entry->labels, le.str());
+                        out << cumulative << '\n';
+                    }
+                    writeSeries(out, entry->name + "_sum", entry->labels);
+                    writeNumber(out, h.getSum());
+                    out << '\n';
+                    writeSeries(out, entry->name + "_count", entry->labels);
+                    out << h.getCount() << '\n';
+                }
+            }
+        }
+    }
+
+    std::string MetricsRegistry::renderPrometheus() const {
+        std::ostringstream out;
+        writePrometheus(out);
+        return out.str();
+    }
+
+}
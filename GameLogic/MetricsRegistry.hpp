@@ -0,0 +1,162 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef METRICS_REGISTRY_HPP
+#define METRICS_REGISTRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @class Counter
+     * @brief Monotonic process-wide count (Prometheus counter)
+     */
+    class Counter {
+    private:
+        std::atomic<std::uint64_t> value;
+
+    public:
+        Counter() : value(0) {}
+        Counter(const Counter &other) = delete;
+        Counter &operator=(const Counter &other) = delete;
+
+        void inc(std::uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+
+        /**
+         * @brief Publish a total counted elsewhere (e.g. summed from per-thread shards)
+         */
+        void set(std::uint64_t total) { value.store(total, std::memory_order_relaxed); }
+
+        std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    /**
+     * @class Gauge
+     * @brief Value that can go up and down (Prometheus gauge)
+     */
+    class Gauge {
+    private:
+        std::atomic<double> value;
+
+    public:
+        Gauge() : value(0.0) {}
+        Gauge(const Gauge &other) = delete;
+        Gauge &operator=(const Gauge &other) = delete;
+
+        void set(double v) { value.store(v, std::memory_order_relaxed); }
+        void add(double delta);
+        double get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+    /**
+     * @class Histogram
+     * @brief Distribution over fixed upper bounds (Prometheus histogram)
+     */
+    class Histogram {
+    private:
+        std::vector<double> bounds;                               ///< Sorted bucket upper bounds
+        std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;    ///< Per-bound counts (+Inf last)
+        std::atomic<std::uint64_t> count;
+        std::atomic<double> sum;
+
+    public:
+        /**
+         * @brief Constructor
+         * @param bounds Ascending bucket upper bounds (+Inf is implicit)
+         * @throws std::runtime_error if bounds are not strictly ascending
+         */
+        explicit Histogram(const std::vector<double> &bounds);
+        Histogram(const Histogram &other) = delete;
+        Histogram &operator=(const Histogram &other) = delete;
+
+        /**
+         * @brief Add one observation
+         * @param v Observed value
+         */
+        void observe(double v);
+
+        const std::vector<double> &getBounds() const { return bounds; }
+        std::uint64_t bucketCount(std::size_t i) const { return buckets[i].load(std::memory_order_relaxed); }
+        std::uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+        double getSum() const { return sum.load(std::memory_order_relaxed); }
+    };
+
+    /**
+     * @class MetricsRegistry
+     * @brief Named counters, gauges and histograms with Prometheus text export
+     *
+     * Registration takes a lock and returns a reference that stays valid for
+     * the registry's lifetime; updating a metric is lock-free. Asking again
+     * for the same name and labels returns the same metric. Labels are given
+     * preformatted, e.g. "action=\"tax\"".
+     */
+    class MetricsRegistry {
+    private:
+        enum class Kind { Counter, Gauge, Histogram };
+
+        struct Entry {
+            Kind kind;
+            std::string name;
+            std::string help;
+            std::string labels;
+            std::unique_ptr<Counter> counter;
+            std::unique_ptr<Gauge> gauge;
+            std::unique_ptr<Histogram> histogram;
+        };
+
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<Entry>> entries;  ///< In registration order
+
+        Entry *find(const std::string &name, const std::string &labels, Kind kind);
+
+    public:
+        MetricsRegistry() = default;
+        MetricsRegistry(const MetricsRegistry &other) = delete;
+        MetricsRegistry &operator=(const MetricsRegistry &other) = delete;
+
+        /**
+         * @brief The process-wide registry the engine reports into
+         */
+        static MetricsRegistry &global();
+
+        /**
+         * @brief Get or create a counter
+         * @throws std::runtime_error if the name is registered with another type
+         */
+        Counter &counter(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        /**
+         * @brief Get or create a gauge
+         * @throws std::runtime_error if the name is registered with another type
+         */
+        Gauge &gauge(const std::string &name, const std::string &help, const std::string &labels = "");
+
+        /**
+         * @brief Get or create a histogram
+         * @param bounds Bucket upper bounds, used only when the histogram is created
+         * @throws std::runtime_error if the name is registered with another type
+         */
+        Histogram &histogram(const std::string &name, const std::string &help,
+                             const std::vector<double> &bounds, const std::string &labels = "");
+
+        /**
+         * @brief Write every metric in Prometheus text exposition format (0.0.4)
+         * @param out Destination stream
+         */
+        void writePrometheus(std::ostream &out) const;
+
+        /**
+         * @brief Render the Prometheus text into a string
+         */
+        std::string renderPrometheus() const;
+    };
+
+}
+
+#endif // METRICS_REGISTRY_HPP
@@ -0,0 +1,566 @@
+// Email: nitzanwa@gmail.com
+
+#include "OutcomeFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace coup {
+
+    namespace {
+        constexpr char FILE_MAGIC[8] = {'C', 'O', 'U', 'P', 'O', 'U', 'T', 'C'};
+        constexpr std::uint32_t GROUP_MAGIC = 0x50524747;  // "GGRP"
+        constexpr std::size_t GROUP_HEADER_SIZE = 16;
+        constexpr std::size_t CHUNK_HEADER_SIZE = 8;
+        constexpr unsigned ROLE_BITS = 3;
+        constexpr unsigned NO_ROLE = 7;  // role code of an empty seat
+        constexpr const char *COLUMN_NAMES[OUTCOME_COLUMN_COUNT] = {"seed",  "player_count", "roles", "winner",
+                                                                    "turns", "coins",        "actions"};
+
+        /**
+         * First 32 bytes of an outcome file; row groups follow
+         */
+        struct FileHeader {
+            char magic[8];
+            std::uint16_t version;
+            std::uint16_t columnCount;
+            std::uint32_t reserved;
+            std::uint64_t reserved2;
+            std::uint64_t reserved3;
+        };
+
+        static_assert(sizeof(FileHeader) == 32, "FileHeader layout is part of the file format");
+        static_assert(ROLE_COUNT <= static_cast<int>(NO_ROLE), "roles are packed in 3 bits");
+        static_assert(Game::MAX_PLAYERS <= 8, "per-turn coin masks are one byte");
+
+        void writeAll(int fd, const void *data, std::size_t size, const std::string &path) {
+            const auto *in = static_cast<const char *>(data);
+            while (size > 0) {
+                ssize_t n = ::write(fd, in, size);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    throw std::runtime_error("Cannot write outcome file " + path + ": " + std::strerror(errno));
+                }
+                in += n;
+                size -= static_cast<std::size_t>(n);
+            }
+        }
+
+        void putVarint(std::vector<std::uint8_t> &out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        void putSigned(std::vector<std::uint8_t> &out, std::int64_t value) {
+            putVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+        }
+
+        void putFixed(std::vector<std::uint8_t> &out, std::uint64_t value, int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        std::uint64_t getFixed(const std::uint8_t *in, int bytes) {
+            std::uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        /**
+         * Bounds-checked cursor over one column chunk
+         */
+        struct ChunkReader {
+            const std::uint8_t *p;
+            const std::uint8_t *end;
+            bool ok = true;
+
+            std::uint8_t byte() {
+                if (p == end) {
+                    ok = false;
+                    return 0;
+                }
+                return *p++;
+            }
+
+            std::uint64_t varint() {
+                std::uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    std::uint8_t b = byte();
+                    value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        return value;
+                    }
+                }
+                ok = false;
+                return 0;
+            }
+
+            std::int64_t signedVarint() {
+                std::uint64_t value = varint();
+                return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+            }
+
+            std::uint64_t fixed(int bytes) {
+                if (static_cast<std::size_t>(end - p) < static_cast<std::size_t>(bytes)) {
+                    ok = false;
+                    p = end;
+                    return 0;
+                }
+                std::uint64_t value = getFixed(p, bytes);
+                p += bytes;
+                return value;
+            }
+        };
+
+        [[noreturn]] void corrupt(std::size_t group, OutcomeColumn column) {
+            throw std::runtime_error("Outcome row group " + std::to_string(group) + " has a corrupt " +
+                                     outcomeColumnName(column) + " column");
+        }
+
+        bool wanted(unsigned columns, OutcomeColumn column) { return (columns & outcomeColumnBit(column)) != 0; }
+    }
+
+    const char *outcomeColumnName(OutcomeColumn column) {
+        std::size_t index = static_cast<std::size_t>(column);
+        return index < OUTCOME_COLUMN_COUNT ? COLUMN_NAMES[index] : "unknown";
+    }
+
+    GameOutcome OutcomeBatch::row(std::size_t index) const {
+        if (index >= rows) {
+            throw std::runtime_error("Outcome row " + std::to_string(index) + " is out of range (batch holds " +
+                                     std::to_string(rows) + ")");
+        }
+        if (seeds.size() != rows || playerCounts.size() != rows || winners.size() != rows || turns.size() != rows ||
+            coinOffsets.size() != rows + 1 || roles.size() != rows * Game::MAX_PLAYERS ||
+            actions.size() != rows * Game::MAX_PLAYERS * OUTCOME_ACTION_COUNT) {
+            throw std::runtime_error("Outcome batch was read without every column");
+        }
+        GameOutcome outcome;
+        outcome.seed = seeds[index];
+        outcome.playerCount = playerCounts[index];
+        for (std::size_t seat = 0; seat < Game::MAX_PLAYERS; ++seat) {
+            outcome.roles[seat] = roles[index * Game::MAX_PLAYERS + seat];
+        }
+        outcome.winnerSeat = winners[index];
+        outcome.turns = turns[index];
+        outcome.coins.assign(coins.begin() + static_cast<std::ptrdiff_t>(coinOffsets[index]),
+                             coins.begin() + static_cast<std::ptrdiff_t>(coinOffsets[index + 1]));
+        std::size_t first = index * Game::MAX_PLAYERS * OUTCOME_ACTION_COUNT;
+        for (std::size_t i = 0; i < outcome.actions.size(); ++i) {
+            outcome.actions[i] = actions[first + i];
+        }
+        return outcome;
+    }
+
+    OutcomeWriter::OutcomeWriter(const std::string &path, std::size_t groupRows)
+        : fd(-1), path(path), groupRows(groupRows), pendingRows(0), rows(0), bytes(0) {
+        if (groupRows == 0 || groupRows > UINT32_MAX) {
+            throw std::runtime_error("Outcome row groups must hold 1 to 2^32 - 1 games");
+        }
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create outcome file " + path + ": " + std::strerror(errno));
+        }
+        FileHeader header{};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.version = OUTCOME_FILE_VERSION;
+        header.columnCount = OUTCOME_COLUMN_COUNT;
+        try {
+            writeAll(fd, &header, sizeof(header), path);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        bytes = sizeof(header);
+    }
+
+    OutcomeWriter::~OutcomeWriter() {
+        try {
+            close();
+        } catch (const std::runtime_error &) {
+            // Reported only when close() is called explicitly
+        }
+    }
+
+    void OutcomeWriter::append(const GameOutcome &outcome) {
+        if (fd < 0) {
+            throw std::runtime_error("Outcome file " + path + " is closed");
+        }
+        std::size_t seats = outcome.playerCount;
+        if (seats == 0 || seats > Game::MAX_PLAYERS || outcome.coins.size() % seats != 0 ||
+            outcome.winnerSeat < -1 || outcome.winnerSeat >= static_cast<int>(seats)) {
+            throw std::runtime_error("Outcome of game " + std::to_string(outcome.seed) + " is malformed");
+        }
+        std::uint64_t packedRoles = 0;
+        for (std::size_t seat = Game::MAX_PLAYERS; seat-- > 0;) {
+            unsigned role = seat < seats ? static_cast<unsigned>(outcome.roles[seat]) : NO_ROLE;
+            if (role >= static_cast<unsigned>(ROLE_COUNT) && seat < seats) {
+                throw std::runtime_error("Outcome of game " + std::to_string(outcome.seed) + " has a bad role");
+            }
+            packedRoles = (packedRoles << ROLE_BITS) | role;
+        }
+
+        putFixed(columns[static_cast<std::size_t>(OutcomeColumn::Seed)], outcome.seed, 8);
+
+        columns[static_cast<std::size_t>(OutcomeColumn::PlayerCount)].push_back(outcome.playerCount);
+        putVarint(columns[static_cast<std::size_t>(OutcomeColumn::Roles)], packedRoles);
+        columns[static_cast<std::size_t>(OutcomeColumn::Winner)].push_back(
+            static_cast<std::uint8_t>(outcome.winnerSeat + 1));
+        putVarint(columns[static_cast<std::size_t>(OutcomeColumn::Turns)], outcome.turns);
+
+        // A turn changes one or two seats' coins: store which, and by how much
+        std::vector<std::uint8_t> &coins = columns[static_cast<std::size_t>(OutcomeColumn::Coins)];
+        std::size_t coinTurns = outcome.coins.size() / seats;
+        putVarint(coins, coinTurns);
+        coins.push_back(static_cast<std::uint8_t>(seats));
+        std::int16_t previous[Game::MAX_PLAYERS] = {};
+        for (std::size_t turn = 0; turn < coinTurns; ++turn) {
+            const std::int16_t *now = &outcome.coins[turn * seats];
+            std::uint8_t changed = 0;
+            for (std::size_t seat = 0; seat < seats; ++seat) {
+                if (now[seat] != previous[seat]) {
+                    changed = static_cast<std::uint8_t>(changed | (1u << seat));
+                }
+            }
+            coins.push_back(changed);
+            for (std::size_t seat = 0; seat < seats; ++seat) {
+                if (changed & (1u << seat)) {
+                    putSigned(coins, static_cast<std::int64_t>(now[seat]) - previous[seat]);
+                    previous[seat] = now[seat];
+                }
+            }
+        }
+
+        std::vector<std::uint8_t> &actions = columns[static_cast<std::size_t>(OutcomeColumn::Actions)];
+        actions.push_back(static_cast<std::uint8_t>(seats));
+        for (std::size_t seat = 0; seat < seats; ++seat) {
+            const std::uint32_t *counted = &outcome.actions[seat * OUTCOME_ACTION_COUNT];
+            std::uint8_t used = 0;
+            for (std::size_t a = 0; a < OUTCOME_ACTION_COUNT; ++a) {
+                if (counted[a] != 0) {
+                    used = static_cast<std::uint8_t>(used | (1u << a));
+                }
+            }
+            actions.push_back(used);
+            for (std::size_t a = 0; a < OUTCOME_ACTION_COUNT; ++a) {
+                if (counted[a] != 0) {
+                    putVarint(actions, counted[a]);
+                }
+            }
+        }
+
+        ++rows;
+        if (++pendingRows == groupRows) {
+            flushGroup();
+        }
+    }
+
+    void OutcomeWriter::flushGroup() {
+        if (pendingRows == 0) {
+            return;
+        }
+        std::size_t body = 0;
+        for (const std::vector<std::uint8_t> &column : columns) {
+            body += CHUNK_HEADER_SIZE + column.size();
+        }
+        group.clear();
+        group.reserve(GROUP_HEADER_SIZE + body);
+        putFixed(group, GROUP_MAGIC, 4);
+        putFixed(group, pendingRows, 4);
+        putFixed(group, body, 8);
+        for (std::size_t c = 0; c < OUTCOME_COLUMN_COUNT; ++c) {
+            putFixed(group, c, 4);
+            putFixed(group, columns[c].size(), 4);
+            group.insert(group.end(), columns[c].begin(), columns[c].end());
+            columns[c].clear();
+        }
+        pendingRows = 0;
+        writeAll(fd, group.data(), group.size(), path);
+        bytes += group.size();
+    }
+
+    void OutcomeWriter::close() {
+        if (fd < 0) {
+            return;
+        }
+        int file = fd;
+        try {
+            flushGroup();
+        } catch (...) {
+            fd = -1;
+            ::close(file);
+            throw;
+        }
+        fd = -1;
+        if (::close(file) < 0) {
+            throw std::runtime_error("Cannot close outcome file " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    OutcomeFile::OutcomeFile(const std::string &path) : mapping(nullptr), mappedSize(0), rows(0) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open outcome file " + path + ": " + std::strerror(errno));
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Outcome file " + path + " is truncated");
+        }
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+        void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map outcome file " + path + ": " + std::strerror(errno));
+        }
+        mapping = data;
+        mappedSize = size;
+
+        const auto *header = static_cast<const FileHeader *>(data);
+        std::string problem;
+        if (std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            problem = "is not an outcome file";
+        } else if (header->version != OUTCOME_FILE_VERSION || header->columnCount != OUTCOME_COLUMN_COUNT) {
+            problem = "has unsupported version " + std::to_string(header->version);
+        }
+
+        // Index the row groups; a group cut short at the end of the file is a write that never finished
+        const auto *bytes = static_cast<const std::uint8_t *>(data);
+        std::size_t offset = sizeof(FileHeader);
+        while (problem.empty() && size - offset >= GROUP_HEADER_SIZE) {
+            const std::uint8_t *at = bytes + offset;
+            std::uint64_t body = getFixed(at + 8, 8);
+            if (getFixed(at, 4) != GROUP_MAGIC) {
+                problem = "has a corrupt row group at byte " + std::to_string(offset);
+                break;
+            }
+            if (body > size - offset - GROUP_HEADER_SIZE) {
+                break;
+            }
+            Group indexed{};
+            indexed.rows = static_cast<std::size_t>(getFixed(at + 4, 4));
+            const std::uint8_t *chunk = at + GROUP_HEADER_SIZE;
+            const std::uint8_t *end = chunk + body;
+            unsigned seen = 0;
+            while (chunk != end) {
+                if (static_cast<std::size_t>(end - chunk) < CHUNK_HEADER_SIZE) {
+                    seen = 0;
+                    break;
+                }
+                std::uint64_t column = getFixed(chunk, 4);
+                std::uint64_t chunkSize = getFixed(chunk + 4, 4);
+                chunk += CHUNK_HEADER_SIZE;
+                if (column >= OUTCOME_COLUMN_COUNT || (seen & (1u << column)) ||
+                    chunkSize > static_cast<std::size_t>(end - chunk)) {
+                    seen = 0;
+                    break;
+                }
+                seen |= 1u << column;
+                indexed.chunks[column] = chunk;
+                indexed.chunkSizes[column] = static_cast<std::size_t>(chunkSize);
+                chunk += chunkSize;
+            }
+            if (seen != OUTCOME_ALL_COLUMNS) {
+                problem = "has a corrupt row group at byte " + std::to_string(offset);
+                break;
+            }
+            groups.push_back(indexed);
+            rows += indexed.rows;
+            offset += GROUP_HEADER_SIZE + static_cast<std::size_t>(body);
+        }
+        if (!problem.empty()) {
+            ::munmap(mapping, mappedSize);
+            throw std::runtime_error("Outcome file " + path + " " + problem);
+        }
+    }
+
+    OutcomeFile::OutcomeFile(OutcomeFile &&other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)),
+          groups(std::move(other.groups)), rows(std::exchange(other.rows, 0)) {}
+
+    OutcomeFile &OutcomeFile::operator=(OutcomeFile &&other) noexcept {
+        if (this != &other) {
+            if (mapping) {
+                ::munmap(mapping, mappedSize);
+            }
+            mapping = std::exchange(other.mapping, nullptr);
+            mappedSize = std::exchange(other.mappedSize, 0);
+            groups = std::move(other.groups);
+            rows = std::exchange(other.rows, 0);
+        }
+        return *this;
+    }
+
+    OutcomeFile::~OutcomeFile() {
+        if (mapping) {
+            ::munmap(mapping, mappedSize);
+        }
+    }
+
+    std::uint64_t OutcomeFile::columnBytes(OutcomeColumn column) const {
+        std::uint64_t total = 0;
+        for (const Group &group : groups) {
+            total += group.chunkSizes.at(static_cast<std::size_t>(column));
+        }
+        return total;
+    }
+
+    void OutcomeFile::readGroup(std::size_t group, OutcomeBatch &batch, unsigned columns) const {
+        if (group >= groups.size()) {
+            throw std::runtime_error("Outcome row group " + std::to_string(group) + " is out of range (file holds " +
+                                     std::to_string(groups.size()) + ")");
+        }
+        const Group &source = groups[group];
+        std::size_t n = source.rows;
+        batch.rows = n;
+        batch.seeds.clear();
+        batch.playerCounts.clear();
+        batch.roles.clear();
+        batch.winners.clear();
+        batch.turns.clear();
+        batch.coins.clear();
+        batch.coinOffsets.clear();
+        batch.actions.clear();
+
+        auto reader = [&](OutcomeColumn column) {
+            std::size_t c = static_cast<std::size_t>(column);
+            return ChunkReader{source.chunks[c], source.chunks[c] + source.chunkSizes[c]};
+        };
+        auto finish = [&](const ChunkReader &in, OutcomeColumn column) {
+            if (!in.ok || in.p != in.end) {
+                corrupt(group, column);
+            }
+        };
+
+        if (wanted(columns, OutcomeColumn::Seed)) {
+            ChunkReader in = reader(OutcomeColumn::Seed);
+            if (static_cast<std::size_t>(in.end - in.p) != n * 8) {
+                corrupt(group, OutcomeColumn::Seed);
+            }
+            batch.seeds.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                batch.seeds[i] = in.fixed(8);
+            }
+        }
+        if (wanted(columns, OutcomeColumn::PlayerCount)) {
+            ChunkReader in = reader(OutcomeColumn::PlayerCount);
+            batch.playerCounts.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint8_t seats = in.byte();
+                if (seats == 0 || seats > Game::MAX_PLAYERS) {
+                    corrupt(group, OutcomeColumn::PlayerCount);
+                }
+                batch.playerCounts[i] = seats;
+            }
+            finish(in, OutcomeColumn::PlayerCount);
+        }
+        if (wanted(columns, OutcomeColumn::Roles)) {
+            ChunkReader in = reader(OutcomeColumn::Roles);
+            batch.roles.resize(n * Game::MAX_PLAYERS, Role::Governor);
+            for (std::size_t i = 0; i < n && in.ok; ++i) {
+                std::uint64_t packed = in.varint();
+                for (std::size_t seat = 0; seat < Game::MAX_PLAYERS; ++seat, packed >>= ROLE_BITS) {
+                    unsigned role = static_cast<unsigned>(packed & NO_ROLE);
+                    if (role < static_cast<unsigned>(ROLE_COUNT)) {
+                        batch.roles[i * Game::MAX_PLAYERS + seat] = static_cast<Role>(role);
+                    } else if (role != NO_ROLE) {
+                        corrupt(group, OutcomeColumn::Roles);
+                    }
+                }
+            }
+            finish(in, OutcomeColumn::Roles);
+        }
+        if (wanted(columns, OutcomeColumn::Winner)) {
+            ChunkReader in = reader(OutcomeColumn::Winner);
+            batch.winners.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint8_t seat = in.byte();
+                if (seat > Game::MAX_PLAYERS) {
+                    corrupt(group, OutcomeColumn::Winner);
+                }
+                batch.winners[i] = static_cast<std::int8_t>(seat - 1);
+            }
+            finish(in, OutcomeColumn::Winner);
+        }
+        if (wanted(columns, OutcomeColumn::Turns)) {
+            ChunkReader in = reader(OutcomeColumn::Turns);
+            batch.turns.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint64_t turns = in.varint();
+                if (turns > UINT32_MAX) {
+                    corrupt(group, OutcomeColumn::Turns);
+                }
+                batch.turns[i] = static_cast<std::uint32_t>(turns);
+            }
+            finish(in, OutcomeColumn::Turns);
+        }
+        if (wanted(columns, OutcomeColumn::Coins)) {
+            ChunkReader in = reader(OutcomeColumn::Coins);
+            batch.coinOffsets.reserve(n + 1);
+            batch.coinOffsets.push_back(0);
+            for (std::size_t i = 0; i < n && in.ok; ++i) {
+                std::uint64_t coinTurns = in.varint();
+                std::size_t seats = in.byte();
+                // Every turn takes at least its mask byte, which bounds a corrupt turn count
+                if (seats == 0 || seats > Game::MAX_PLAYERS || coinTurns > static_cast<std::size_t>(in.end - in.p)) {
+                    corrupt(group, OutcomeColumn::Coins);
+                }
+                std::int64_t coins[Game::MAX_PLAYERS] = {};
+                for (std::uint64_t turn = 0; turn < coinTurns && in.ok; ++turn) {
+                    std::uint8_t changed = in.byte();
+                    for (std::size_t seat = 0; seat < seats; ++seat) {
+                        if (changed & (1u << seat)) {
+                            coins[seat] += in.signedVarint();
+                            if (coins[seat] < INT16_MIN || coins[seat] > INT16_MAX) {
+                                corrupt(group, OutcomeColumn::Coins);
+                            }
+                        }
+                        batch.coins.push_back(static_cast<std::int16_t>(coins[seat]));
+                    }
+                }
+                batch.coinOffsets.push_back(batch.coins.size());
+            }
+            finish(in, OutcomeColumn::Coins);
+        }
+        if (wanted(columns, OutcomeColumn::Actions)) {
+            ChunkReader in = reader(OutcomeColumn::Actions);
+            batch.actions.resize(n * Game::MAX_PLAYERS * OUTCOME_ACTION_COUNT);
+            for (std::size_t i = 0; i < n && in.ok; ++i) {
+                std::size_t seats = in.byte();
+                if (seats > Game::MAX_PLAYERS) {
+                    corrupt(group, OutcomeColumn::Actions);
+                }
+                for (std::size_t seat = 0; seat < seats && in.ok; ++seat) {
+                    std::uint8_t used = in.byte();
+                    std::uint32_t *counted = &batch.actions[(i * Game::MAX_PLAYERS + seat) * OUTCOME_ACTION_COUNT];
+                    for (std::size_t a = 0; a < OUTCOME_ACTION_COUNT; ++a) {
+                        if (used & (1u << a)) {
+                            std::uint64_t count = in.varint();
+                            if (count > UINT32_MAX) {
+                                corrupt(group, OutcomeColumn::Actions);
+                            }
+                            counted[a] = static_cast<std::uint32_t>(count);
+                        }
+                    }
+                }
+            }
+            finish(in, OutcomeColumn::Actions);
+        }
+    }
+
+}
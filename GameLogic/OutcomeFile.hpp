@@ -0,0 +1,220 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef OUTCOME_FILE_HPP
+#define OUTCOME_FILE_HPP
+
+#include "ActionMetrics.hpp"
+#include "ActionType.hpp"
+#include "Game.hpp"
+#include "Role.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    constexpr std::uint16_t OUTCOME_FILE_VERSION = 1;           ///< Layout version of outcome files
+    constexpr std::size_t OUTCOME_ACTION_COUNT = ACTION_TYPE_COUNT - 1;  ///< Gather..Invest (ActionType minus None)
+    constexpr std::size_t OUTCOME_DEFAULT_GROUP_ROWS = 65536;   ///< Games per row group
+
+    /**
+     * @enum OutcomeColumn
+     * @brief Columns of an outcome file, each stored and read on its own
+     */
+    enum class OutcomeColumn : std::uint8_t {
+        Seed,         ///< Game seed (plain 8 bytes)
+        PlayerCount,  ///< Seats at the table (one byte)
+        Roles,        ///< Role of every seat (3 bits per seat)
+        Winner,       ///< Winning seat, or none (one byte)
+        Turns,        ///< Turns played (varint)
+        Coins,        ///< Coins of every seat after every turn (per-turn change mask and deltas)
+        Actions       ///< Accepted actions per seat and type (non-zero mask and varints)
+    };
+
+    constexpr std::size_t OUTCOME_COLUMN_COUNT = 7;
+
+    /**
+     * @brief Bit of a column in a column mask
+     */
+    constexpr unsigned outcomeColumnBit(OutcomeColumn column) { return 1u << static_cast<unsigned>(column); }
+
+    constexpr unsigned OUTCOME_ALL_COLUMNS = (1u << OUTCOME_COLUMN_COUNT) - 1;
+
+    /**
+     * @brief Stable lowercase name of a column (e.g. "player_count")
+     */
+    const char *outcomeColumnName(OutcomeColumn column);
+
+    /**
+     * @struct GameOutcome
+     * @brief Everything the analytics export keeps about one game
+     */
+    struct GameOutcome {
+        std::uint64_t seed = 0;
+        std::uint8_t playerCount = 0;
+        std::array<Role, Game::MAX_PLAYERS> roles{};   ///< First playerCount are used
+        int winnerSeat = -1;                            ///< -1 if the game was abandoned at the turn cap
+        std::uint32_t turns = 0;
+        std::vector<std::int16_t> coins;                ///< coins[turn * playerCount + seat] after each turn (0 once out)
+        std::array<std::uint32_t, Game::MAX_PLAYERS * OUTCOME_ACTION_COUNT> actions{};  ///< Per seat, then per type
+
+        /**
+         * @brief Accepted actions of one type by a seat (ActionType::None counts nothing)
+         */
+        std::uint32_t actionCount(std::size_t seat, ActionType type) const {
+            return type == ActionType::None ? 0 : actions[seat * OUTCOME_ACTION_COUNT + static_cast<std::size_t>(type) - 1];
+        }
+
+        void countAction(std::size_t seat, ActionType type) {
+            if (type != ActionType::None) {
+                ++actions[seat * OUTCOME_ACTION_COUNT + static_cast<std::size_t>(type) - 1];
+            }
+        }
+    };
+
+    /**
+     * @struct OutcomeBatch
+     * @brief Decoded columns of one row group, one vector per column
+     *
+     * Only the columns that were asked for are filled; the others are left
+     * empty. Fixed-width per-seat columns hold Game::MAX_PLAYERS entries per
+     * row; coins is a list column with an offset per row.
+     */
+    struct OutcomeBatch {
+        std::size_t rows = 0;
+        std::vector<std::uint64_t> seeds;
+        std::vector<std::uint8_t> playerCounts;
+        std::vector<Role> roles;                    ///< rows * MAX_PLAYERS; unused seats hold Role::Governor
+        std::vector<std::int8_t> winners;           ///< Seat, or -1
+        std::vector<std::uint32_t> turns;
+        std::vector<std::int16_t> coins;            ///< All rows' coins, back to back
+        std::vector<std::uint64_t> coinOffsets;     ///< rows + 1 offsets into coins
+        std::vector<std::uint32_t> actions;         ///< rows * MAX_PLAYERS * OUTCOME_ACTION_COUNT
+
+        /**
+         * @brief Rebuild one game (every column must have been read)
+         */
+        GameOutcome row(std::size_t index) const;
+    };
+
+    /**
+     * @class OutcomeWriter
+     * @brief Streams game outcomes into a columnar file of compressed row groups
+     *
+     * Each column is encoded as rows arrive, so memory holds one group's
+     * encoded bytes rather than its rows. A full group is written with one
+     * write() call; a file cut short (a crash mid-run) keeps every complete
+     * group readable.
+     *
+     * Layout: a 32-byte file header, then row groups, each a 16-byte group
+     * header followed by one chunk per column (8-byte chunk header, encoded
+     * bytes). Integers are little-endian.
+     */
+    class OutcomeWriter {
+    private:
+        int fd;
+        std::string path;
+        std::size_t groupRows;
+        std::size_t pendingRows;
+        std::uint64_t rows;
+        std::uint64_t bytes;
+        std::array<std::vector<std::uint8_t>, OUTCOME_COLUMN_COUNT> columns;  ///< Encoded, not written yet
+        std::vector<std::uint8_t> group;                                       ///< Reused write buffer
+
+        void flushGroup();
+
+    public:
+        /**
+         * @brief Create (or replace) an outcome file
+         * @param path File to create
+         * @param groupRows Games per row group (larger groups compress better and read faster)
+         * @throws std::runtime_error if the file cannot be created or groupRows is 0
+         */
+        explicit OutcomeWriter(const std::string &path, std::size_t groupRows = OUTCOME_DEFAULT_GROUP_ROWS);
+        OutcomeWriter(const OutcomeWriter &other) = delete;
+        OutcomeWriter &operator=(const OutcomeWriter &other) = delete;
+
+        /**
+         * @brief Destructor - writes the last group and closes (errors are only reported by close())
+         */
+        ~OutcomeWriter();
+
+        /**
+         * @brief Add a game; a full row group is written out
+         * @throws std::runtime_error if the file is closed, a write fails or the outcome is malformed
+         */
+        void append(const GameOutcome &outcome);
+
+        /**
+         * @brief Write the last (partial) row group and close the file
+         * @throws std::runtime_error if a write fails
+         */
+        void close();
+
+        std::uint64_t size() const { return rows; }
+
+        /**
+         * @brief File bytes written so far (complete groups only)
+         */
+        std::uint64_t bytesWritten() const { return bytes; }
+    };
+
+    /**
+     * @class OutcomeFile
+     * @brief Read-only, memory-mapped view of an outcome file
+     *
+     * Opening maps the file and indexes its row groups; nothing is decoded
+     * until readGroup(), which decodes only the columns asked for, so a
+     * query over two columns skips the bytes of the other five. A trailing
+     * group cut short by a crash is ignored.
+     */
+    class OutcomeFile {
+    private:
+        struct Group {
+            std::size_t rows;
+            std::array<const std::uint8_t *, OUTCOME_COLUMN_COUNT> chunks;
+            std::array<std::size_t, OUTCOME_COLUMN_COUNT> chunkSizes;
+        };
+
+        void *mapping;
+        std::size_t mappedSize;
+        std::vector<Group> groups;
+        std::uint64_t rows;
+
+    public:
+        /**
+         * @brief Map an outcome file and index its row groups
+         * @throws std::runtime_error if the file is missing, of another format or version, or malformed
+         */
+        explicit OutcomeFile(const std::string &path);
+        OutcomeFile(OutcomeFile &&other) noexcept;
+        OutcomeFile &operator=(OutcomeFile &&other) noexcept;
+        OutcomeFile(const OutcomeFile &other) = delete;
+        OutcomeFile &operator=(const OutcomeFile &other) = delete;
+        ~OutcomeFile();
+
+        std::uint64_t size() const { return rows; }
+        std::size_t groupCount() const { return groups.size(); }
+        std::size_t groupRows(std::size_t group) const { return groups.at(group).rows; }
+
+        /**
+         * @brief Encoded bytes of a column across all groups
+         */
+        std::uint64_t columnBytes(OutcomeColumn column) const;
+
+        /**
+         * @brief Decode columns of a row group into batch (reusing its storage)
+         * @param group Row group index
+         * @param batch Receives the group's rows; columns not asked for are cleared
+         * @param columns Mask of outcomeColumnBit() values
+         * @throws std::runtime_error if group is out of range or a chunk is corrupt
+         */
+        void readGroup(std::size_t group, OutcomeBatch &batch, unsigned columns = OUTCOME_ALL_COLUMNS) const;
+    };
+
+}
+
+#endif // OUTCOME_FILE_HPP
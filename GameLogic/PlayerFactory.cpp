@@ -9,51 +9,74 @@
 #include "../Players/Roles/Merchant.hpp"
 #include "Logger.hpp"
 
-#include <random>
 #include <string>
 #include <stdexcept>
+#include <typeinfo>
+#include <utility>
 
 namespace coup {
 
+    Player* createPlayer(Game &game, const std::string &name, Role role) {
+        switch (role) {
+            case Role::Governor: return new Governor(game, name);
+            case Role::Spy: return new Spy(game, name);
+            case Role::Baron: return new Baron(game, name);
+            case Role::General: return new General(game, name);
+            case Role::Judge: return new Judge(game, name);
+            case Role::Merchant: return new Merchant(game, name);
+        }
+        throw std::runtime_error("Invalid role for player creation");
+    }
+
+    Role roleOf(const Player &player) {
+        // Exact type checks: cheaper than a chain of failing dynamic_casts
+        const std::type_info &type = typeid(player);
+        if (type == typeid(Governor)) return Role::Governor;
+        if (type == typeid(Spy)) return Role::Spy;
+        if (type == typeid(Baron)) return Role::Baron;
+        if (type == typeid(General)) return Role::General;
+        if (type == typeid(Judge)) return Role::Judge;
+        if (type == typeid(Merchant)) return Role::Merchant;
+        throw std::runtime_error("Player " + player.getName() + " has no role");
+    }
+
+    InlineVector<Role, Game::MAX_PLAYERS> drawBalancedRoles(Rng &rng, std::size_t count) {
+        if (count > Game::MAX_PLAYERS) {
+            throw std::runtime_error("Cannot draw roles for more than " + std::to_string(Game::MAX_PLAYERS) + " players");
+        }
+
+        static_assert(Game::MAX_PLAYERS <= ROLE_COUNT, "Balanced draw needs a distinct role per player");
+        Role pool[ROLE_COUNT] = {Role::Governor, Role::Spy, Role::Baron,
+                                 Role::General, Role::Judge, Role::Merchant};
+        // Fisher-Yates shuffle, then take the first count roles
+        for (int i = ROLE_COUNT - 1; i > 0; --i) {
+            int j = static_cast<int>(rng.uniform(static_cast<std::uint64_t>(i) + 1));
+            std::swap(pool[i], pool[j]);
+        }
+
+        InlineVector<Role, Game::MAX_PLAYERS> drawn;
+        for (std::size_t i = 0; i < count; ++i) {
+            drawn.push_back(pool[i]);
+        }
+        return drawn;
+    }
+
     Player* randomPlayer(Game &game, const std::string &name) {
+        return randomPlayer(game, name, game.getRng());
+    }
+
+    Player* randomPlayer(Game &game, const std::string &name, Rng &rng) {
         Logger::log("Attempting to add random player: " + name);
 
         if (game.nameExists(name)) {
             throw std::runtime_error("Name '" + name + "' already exists in game");
         }
 
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, 5);
-
-        int num = dis(gen);
-        Player *newPlayer = nullptr;
-
-        switch (num) {
-            case 0:
-                newPlayer = new Governor(game, name);
-                break;
-            case 1:
-                newPlayer = new Spy(game, name);
-                break;
-            case 2:
-                newPlayer = new Baron(game, name);
-                break;
-            case 3:
-                newPlayer = new General(game, name);
-                break;
-            case 4:
-                newPlayer = new Judge(game, name);
-                break;
-            case 5:
-                newPlayer = new Merchant(game, name);
-                break;
-            default:
-                throw std::runtime_error("Invalid index for role selection");
-        }
+        Role role = static_cast<Role>(rng.uniform(ROLE_COUNT));
+        Player *newPlayer = createPlayer(game, name, role);
 
         Logger::log("Added player " + name + " with role: " + newPlayer->getRoleName());
         return newPlayer;
     }
 
-}
\ No newline at end of file
+}
@@ -3,13 +3,53 @@
 #pragma once
 
 #include "Game.hpp"
+#include "Rng.hpp"
+#include "Role.hpp"
+#include <cstddef>
 #include <string>
 
 namespace coup {
 
+    /**
+     * @brief Creates a player with the given role and adds them to the game
+     * 
+     * @param game Reference to the current game
+     * @param name Name for the new player
+     * @param role Role to create
+     * @return Pointer to a newly created Player; the caller takes ownership
+     *         (Game::setup() keeps the players it creates in the game)
+     * @throws std::runtime_error if the game rejects the player
+     */
+    Player* createPlayer(Game& game, const std::string& name, Role role);
+
+    /**
+     * @brief Identifies the role of a player (the inverse of createPlayer)
+     * 
+     * @param player Player to inspect
+     * @return The player's role
+     * @throws std::runtime_error if the player is a plain Player without a role
+     */
+    Role roleOf(const Player& player);
+
+    /**
+     * @brief Draws distinct roles for a table of players
+     * 
+     * Shuffles all roles with the generator and takes the first count, so
+     * no role appears twice at the table.
+     * 
+     * @param rng Generator to shuffle with
+     * @param count Number of roles to draw
+     * @return Inline list of drawn roles
+     * @throws std::runtime_error if count exceeds Game::MAX_PLAYERS
+     */
+    InlineVector<Role, Game::MAX_PLAYERS> drawBalancedRoles(Rng& rng, std::size_t count);
+
     /**
      * @brief Creates a player with a randomly selected role and adds them to the game
      * 
+     * The role is drawn from the game's own random stream, so games created
+     * with the same seed assign the same roles.
+     * 
      * @param game Reference to the current game
      * @param name Desired name for the new player
      * @return Pointer to a newly created Player with a random role
@@ -17,4 +57,15 @@ namespace coup {
      */
     Player* randomPlayer(Game& game, const std::string& name);
 
-}
\ No newline at end of file
+    /**
+     * @brief Creates a player with a role drawn from an explicit generator
+     * 
+     * @param game Reference to the current game
+     * @param name Desired name for the new player
+     * @param rng Generator to draw the role from
+     * @return Pointer to a newly created Player with a random role
+     * @throws std::runtime_error if the name already exists in the game
+     */
+    Player* randomPlayer(Game& game, const std::string& name, Rng& rng);
+
+}
@@ -0,0 +1,79 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef PLAYER_RANGE_HPP
+#define PLAYER_RANGE_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace coup {
+
+    class Player;  // forward declaration
+
+    /**
+     * @class AlivePlayerIterator
+     * @brief Forward iterator over a player slot list that skips eliminated (nullptr) slots
+     */
+    class AlivePlayerIterator {
+    private:
+        Player *const *pos;   ///< Current slot
+        Player *const *last;  ///< One past the final slot
+
+        void skipEliminated() {
+            while (pos != last && *pos == nullptr) {
+                ++pos;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Player *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Player *const *;
+        using reference = Player *;
+
+        AlivePlayerIterator(Player *const *pos, Player *const *last) : pos(pos), last(last) {
+            skipEliminated();
+        }
+
+        Player *operator*() const { return *pos; }
+
+        AlivePlayerIterator &operator++() {
+            ++pos;
+            skipEliminated();
+            return *this;
+        }
+
+        AlivePlayerIterator operator++(int) {
+            AlivePlayerIterator copy = *this;
+            ++(*this);
+            return copy;
+        }
+
+        bool operator==(const AlivePlayerIterator &other) const { return pos == other.pos; }
+        bool operator!=(const AlivePlayerIterator &other) const { return pos != other.pos; }
+    };
+
+    /**
+     * @class AlivePlayerRange
+     * @brief Non-owning view of the alive players in a game
+     *
+     * The view is invalidated when players are added or the game is reset.
+     * Eliminations during iteration are safe: eliminated slots are skipped.
+     */
+    class AlivePlayerRange {
+    private:
+        Player *const *first;  ///< First slot
+        Player *const *last;   ///< One past the final slot
+
+    public:
+        AlivePlayerRange(Player *const *first, Player *const *last) : first(first), last(last) {}
+
+        AlivePlayerIterator begin() const { return AlivePlayerIterator(first, last); }
+        AlivePlayerIterator end() const { return AlivePlayerIterator(last, last); }
+        bool empty() const { return begin() == end(); }
+    };
+
+}
+
+#endif // PLAYER_RANGE_HPP
@@ -0,0 +1,267 @@
+// Email: nitzanwa@gmail.com
+
+#include "PositionStore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace coup {
+
+    namespace {
+        constexpr char STORE_MAGIC[8] = {'C', 'O', 'U', 'P', 'P', 'O', 'S', '1'};
+        constexpr std::uint16_t STORE_VERSION = 1;
+        constexpr std::size_t HEADER_SIZE = 4096;
+
+        std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        std::uint64_t bucketCountFor(std::uint64_t capacity) {
+            std::uint64_t count = 1;
+            while (count < capacity) {
+                count <<= 1;
+            }
+            return count;
+        }
+
+        void *mapFile(int fd, std::size_t size, bool writable, const std::string &path) {
+            int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+            void *data = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                std::string reason = std::strerror(errno);
+                ::close(fd);
+                throw std::runtime_error("Cannot map position store " + path + ": " + reason);
+            }
+            ::close(fd);
+            return data;
+        }
+    }
+
+    /**
+     * First page of a store file
+     */
+    struct PositionStore::Header {
+        char magic[8];
+        std::uint16_t version;
+        std::uint16_t recordSize;
+        std::uint32_t reserved;
+        std::uint64_t capacity;
+        std::uint64_t bucketCount;        ///< Power of two
+        std::uint64_t recordsOffset;
+        std::uint64_t bucketsOffset;
+        std::atomic<std::uint64_t> count;       ///< Records reserved by writers
+        std::atomic<std::uint64_t> nextGameId;
+    };
+
+    std::uint64_t positionKey(const GameSnapshot &position) {
+        GameSnapshot canonical = position;
+        canonical.seed = 0;
+        canonical.rngPosition = 0;
+        for (PlayerSnapshot &player : canonical.players) {
+            std::memset(player.name, 0, sizeof(player.name));
+            player.nameLength = 0;
+        }
+        std::uint64_t words[sizeof(GameSnapshot) / sizeof(std::uint64_t)];
+        std::memcpy(words, &canonical, sizeof(words));
+        std::uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (std::uint64_t word : words) {
+            hash = mix(hash ^ word);
+        }
+        return hash;
+    }
+
+    PositionStore::PositionStore(void *mapping, std::size_t size, bool writable)
+        : mapping(mapping), mappedSize(size), header(static_cast<Header *>(mapping)), writable(writable) {
+        char *base = static_cast<char *>(mapping);
+        records = reinterpret_cast<PositionRecord *>(base + header->recordsOffset);
+        buckets = reinterpret_cast<std::atomic<std::uint64_t> *>(base + header->bucketsOffset);
+        bucketMask = header->bucketCount - 1;
+    }
+
+    PositionStore PositionStore::create(const std::string &path, std::uint64_t capacity) {
+        if (capacity == 0) {
+            throw std::runtime_error("Position store capacity must be positive");
+        }
+        std::uint64_t bucketCount = bucketCountFor(capacity);
+        std::uint64_t bucketsOffset = HEADER_SIZE + capacity * sizeof(PositionRecord);
+        std::size_t size = static_cast<std::size_t>(bucketsOffset + bucketCount * sizeof(std::uint64_t));
+
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create position store " + path + ": " + std::strerror(errno));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(size)) < 0) {
+            std::string reason = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot size position store " + path + ": " + reason);
+        }
+        void *data = mapFile(fd, size, true, path);
+
+        // The file reads as zeros: empty buckets, unpublished records, count 0
+        auto *header = static_cast<Header *>(data);
+        std::memcpy(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+        header->version = STORE_VERSION;
+        header->recordSize = sizeof(PositionRecord);
+        header->capacity = capacity;
+        header->bucketCount = bucketCount;
+        header->recordsOffset = HEADER_SIZE;
+        header->bucketsOffset = bucketsOffset;
+        header->nextGameId.store(1, std::memory_order_relaxed);
+        return PositionStore(data, size, true);
+    }
+
+    PositionStore PositionStore::open(const std::string &path, bool writable) {
+        int fd = ::open(path.c_str(), (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open position store " + path + ": " + std::strerror(errno));
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < HEADER_SIZE) {
+            ::close(fd);
+            throw std::runtime_error("Position store " + path + " is truncated");
+        }
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+        void *data = mapFile(fd, size, writable, path);
+
+        const auto *header = static_cast<const Header *>(data);
+        std::string problem;
+        if (std::memcmp(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0) {
+            problem = "is not a position store";
+        } else if (header->version != STORE_VERSION || header->recordSize != sizeof(PositionRecord)) {
+            problem = "has unsupported version " + std::to_string(header->version);
+        } else if (header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 ||
+                   header->recordsOffset != HEADER_SIZE ||
+                   header->bucketsOffset != HEADER_SIZE + header->capacity * sizeof(PositionRecord) ||
+                   size < header->bucketsOffset + header->bucketCount * sizeof(std::uint64_t)) {
+            problem = "is truncated";
+        } else if (header->count.load(std::memory_order_relaxed) > header->capacity) {
+            problem = "counts more records than it holds";
+        }
+        if (!problem.empty()) {
+            ::munmap(data, size);
+            throw std::runtime_error("Position store " + path + " " + problem);
+        }
+        return PositionStore(data, size, writable);
+    }
+
+    PositionStore::PositionStore(PositionStore &&other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)),
+          header(std::exchange(other.header, nullptr)), records(std::exchange(other.records, nullptr)),
+          buckets(std::exchange(other.buckets, nullptr)), bucketMask(other.bucketMask), writable(other.writable) {}
+
+    PositionStore &PositionStore::operator=(PositionStore &&other) noexcept {
+        if (this != &other) {
+            if (mapping) {
+                ::munmap(mapping, mappedSize);
+            }
+            mapping = std::exchange(other.mapping, nullptr);
+            mappedSize = std::exchange(other.mappedSize, 0);
+            header = std::exchange(other.header, nullptr);
+            records = std::exchange(other.records, nullptr);
+            buckets = std::exchange(other.buckets, nullptr);
+            bucketMask = other.bucketMask;
+            writable = other.writable;
+        }
+        return *this;
+    }
+
+    PositionStore::~PositionStore() {
+        if (mapping) {
+            ::munmap(mapping, mappedSize);
+        }
+    }
+
+    std::atomic<std::uint64_t> &PositionStore::bucketFor(std::uint64_t key) const {
+        return buckets[key & bucketMask];
+    }
+
+    void PositionStore::requireWritable() const {
+        if (!writable) {
+            throw std::runtime_error("Position store is read-only");
+        }
+    }
+
+    std::uint64_t PositionStore::newGameId() {
+        requireWritable();
+        return header->nextGameId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t PositionStore::append(std::uint64_t gameId, const GameSnapshot *positions, std::size_t count,
+                                        std::uint8_t winnerSeat) {
+        requireWritable();
+        std::uint64_t first = header->count.load(std::memory_order_relaxed);
+        do {
+            if (count > header->capacity - first) {
+                throw std::runtime_error("Position store is full (" + std::to_string(header->capacity) +
+                                         " records)");
+            }
+        } while (!header->count.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint64_t index = first + i;
+            PositionRecord &record = records[index];
+            record.position = positions[i];
+            record.key = positionKey(positions[i]);
+            record.gameId = gameId;
+            record.ply = static_cast<std::uint16_t>(i < 0xFFFF ? i : 0xFFFF);
+            record.winnerSeat = winnerSeat;
+
+            // Linked before it is published: readers follow the chain through unpublished records
+            std::atomic<std::uint64_t> &bucket = bucketFor(record.key);
+            std::uint64_t head = bucket.load(std::memory_order_relaxed);
+            do {
+                record.nextInBucket = head;
+            } while (!bucket.compare_exchange_weak(head, index + 1, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+            record.published.store(1, std::memory_order_release);
+        }
+        return first;
+    }
+
+    std::uint64_t PositionStore::size() const {
+        std::uint64_t reserved = header->count.load(std::memory_order_acquire);
+        return reserved < header->capacity ? reserved : header->capacity;
+    }
+
+    std::uint64_t PositionStore::capacity() const {
+        return header->capacity;
+    }
+
+    std::uint64_t PositionStore::lookup(std::uint64_t key) const {
+        for (std::uint64_t link = bucketFor(key).load(std::memory_order_acquire); link != 0;
+             link = records[link - 1].nextInBucket) {
+            std::uint64_t index = link - 1;
+            if (published(index) && records[index].key == key) {
+                return index;
+            }
+        }
+        return POSITION_NONE;
+    }
+
+    std::uint64_t PositionStore::nextWithKey(std::uint64_t index) const {
+        std::uint64_t key = records[index].key;
+        for (std::uint64_t link = records[index].nextInBucket; link != 0; link = records[link - 1].nextInBucket) {
+            std::uint64_t older = link - 1;
+            if (published(older) && records[older].key == key) {
+                return older;
+            }
+        }
+        return POSITION_NONE;
+    }
+
+    void PositionStore::sync() {
+        if (mapping && ::msync(mapping, mappedSize, MS_SYNC) < 0) {
+            throw std::runtime_error(std::string("Cannot sync position store: ") + std::strerror(errno));
+        }
+    }
+
+}
@@ -0,0 +1,157 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef POSITION_STORE_HPP
+#define POSITION_STORE_HPP
+
+#include "Snapshot.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace coup {
+
+    constexpr std::uint64_t POSITION_NONE = ~0ULL;  ///< "No record" index
+
+    /**
+     * @struct PositionRecord
+     * @brief One stored position with its game's outcome, 256 bytes
+     *
+     * Lives only inside a PositionStore mapping. Every field except
+     * published is written once, before the record is published.
+     */
+    struct PositionRecord {
+        GameSnapshot position;              ///< Loadable with Game::loadSnapshot
+        std::uint64_t key;                  ///< positionKey(position)
+        std::uint64_t gameId;               ///< Game the position was reached in
+        std::uint64_t nextInBucket;         ///< 1 + index of an older record in the same index bucket, or 0
+        std::uint16_t ply;                  ///< Turns played before the position
+        std::uint8_t winnerSeat;            ///< Winner of the game, or SNAPSHOT_NO_SEAT
+        std::uint8_t reserved;
+        std::atomic<std::uint32_t> published;  ///< Non-zero once the fields above are complete
+    };
+
+    static_assert(sizeof(PositionRecord) == 256, "PositionRecord layout is part of the file format");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "record flags are shared through a mapping");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "index heads are shared through a mapping");
+
+    /**
+     * @brief Hash of a position's game state, independent of names, seed and Rng position
+     *
+     * Equal tables (roles, coins, statuses, turn, pending action) reached in
+     * different games share a key.
+     */
+    std::uint64_t positionKey(const GameSnapshot &position);
+
+    /**
+     * @class PositionStore
+     * @brief Memory-mapped file of fixed-size position records with a hash index
+     *
+     * Layout: a 4 KiB header, the record array, then one index head per
+     * bucket. The file is sized for its capacity when created (sparse until
+     * written), so records never move and readers use them in place.
+     *
+     * Writers on any number of threads (or processes sharing the file)
+     * reserve a run of records with one compare-and-swap on the header's
+     * count, fill them, push each onto its bucket's chain with another
+     * compare-and-swap, then publish it with a release store. Readers take
+     * no locks: a record is complete once published() is true, and lookup()
+     * walks a bucket chain, skipping records not published yet.
+     */
+    class PositionStore {
+    private:
+        struct Header;
+
+        void *mapping;
+        std::size_t mappedSize;
+        Header *header;
+        PositionRecord *records;
+        std::atomic<std::uint64_t> *buckets;
+        std::uint64_t bucketMask;
+        bool writable;
+
+        PositionStore(void *mapping, std::size_t size, bool writable);
+        std::atomic<std::uint64_t> &bucketFor(std::uint64_t key) const;
+        void requireWritable() const;
+
+    public:
+        /**
+         * @brief Create (or replace) a store
+         * @param path File to create
+         * @param capacity Maximum number of records
+         * @throws std::runtime_error if the file cannot be created or mapped
+         */
+        static PositionStore create(const std::string &path, std::uint64_t capacity);
+
+        /**
+         * @brief Open an existing store
+         * @param path Store file
+         * @param writable Map for appending (otherwise read-only)
+         * @throws std::runtime_error if the file is missing, truncated, inconsistent or not a store of this version
+         */
+        static PositionStore open(const std::string &path, bool writable = false);
+
+        PositionStore(PositionStore &&other) noexcept;
+        PositionStore &operator=(PositionStore &&other) noexcept;
+        PositionStore(const PositionStore &other) = delete;
+        PositionStore &operator=(const PositionStore &other) = delete;
+        ~PositionStore();
+
+        /**
+         * @brief Reserve an id for a game whose positions will be appended (thread-safe)
+         * @throws std::runtime_error if the store is read-only
+         */
+        std::uint64_t newGameId();
+
+        /**
+         * @brief Append the positions of one game (thread-safe, lock-free)
+         * @param gameId Game the positions belong to
+         * @param positions Positions in play order; positions[i] is stored with ply i
+         * @param count Number of positions
+         * @param winnerSeat Winner of the game, or SNAPSHOT_NO_SEAT
+         * @return Index of the first record (the rest follow contiguously)
+         * @throws std::runtime_error if the store is read-only or has no room for count records
+         */
+        std::uint64_t append(std::uint64_t gameId, const GameSnapshot *positions, std::size_t count,
+                             std::uint8_t winnerSeat);
+
+        /**
+         * @brief Records reserved so far; some of the newest may not be published yet
+         */
+        std::uint64_t size() const;
+
+        std::uint64_t capacity() const;
+
+        /**
+         * @brief Whether record index has been completely written
+         */
+        bool published(std::uint64_t index) const {
+            return records[index].published.load(std::memory_order_acquire) != 0;
+        }
+
+        /**
+         * @brief Record at index (check published() for records near size())
+         */
+        const PositionRecord &operator[](std::uint64_t index) const { return records[index]; }
+
+        /**
+         * @brief Newest published record with the given key, or POSITION_NONE
+         */
+        std::uint64_t lookup(std::uint64_t key) const;
+
+        /**
+         * @brief Next older record with the same key as record index, or POSITION_NONE
+         */
+        std::uint64_t nextWithKey(std::uint64_t index) const;
+
+        /**
+         * @brief Flush written records to the file
+         * @throws std::runtime_error if msync fails
+         */
+        void sync();
+    };
+
+}
+
+#endif // POSITION_STORE_HPP
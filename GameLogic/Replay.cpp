@@ -0,0 +1,257 @@
+// Email: nitzanwa@gmail.com
+
+#include "Replay.hpp"
+#include "../Players/Player.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        constexpr const char *RECORDING_MAGIC = "coup-recording";
+        constexpr int RECORDING_VERSION = 1;
+        constexpr const char *ROLE_NAMES[ROLE_COUNT] = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+
+        std::string seatText(std::uint8_t seat) {
+            return seat == JOURNAL_NO_SEAT ? "-" : std::to_string(seat);
+        }
+
+        [[noreturn]] void badLine(const std::string &path, std::size_t line, const std::string &problem) {
+            throw std::runtime_error("Recording " + path + " line " + std::to_string(line) + ": " + problem);
+        }
+
+        std::uint8_t parseSeat(const std::string &text, const std::string &path, std::size_t line) {
+            if (text == "-") {
+                return JOURNAL_NO_SEAT;
+            }
+            std::size_t used = 0;
+            unsigned long seat = 0;
+            try {
+                seat = std::stoul(text, &used);
+            } catch (const std::exception &) {
+                used = 0;
+            }
+            if (used != text.size() || text.empty() || seat >= JOURNAL_NO_SEAT) {
+                badLine(path, line, "bad seat '" + text + "'");
+            }
+            return static_cast<std::uint8_t>(seat);
+        }
+    }
+
+    void GameRecording::gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                                    const std::vector<Role> &roles) {
+        this->seed = seed;
+        this->names = names;
+        this->roles = roles;
+        entries.clear();
+        winnerSeat = -1;
+        ended = false;
+    }
+
+    void GameRecording::record(const JournalEntry &entry) {
+        entries.push_back(entry);
+    }
+
+    void GameRecording::gameEnded(int winnerSeat) {
+        this->winnerSeat = winnerSeat;
+        ended = true;
+    }
+
+    void GameRecording::save(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Cannot create recording " + path);
+        }
+        out << RECORDING_MAGIC << ' ' << RECORDING_VERSION << '\n' << "seed " << seed << '\n';
+        for (std::size_t seat = 0; seat < names.size(); ++seat) {
+            out << "seat " << ROLE_NAMES[static_cast<int>(roles[seat])] << ' ' << names[seat] << '\n';
+        }
+        for (const JournalEntry &entry : entries) {
+            out << journalOpName(entry.op) << ' ' << static_cast<int>(entry.actor) << ' ' << seatText(entry.target)
+                << '\n';
+        }
+        if (ended) {
+            out << "end " << (winnerSeat < 0 ? "-" : std::to_string(winnerSeat)) << '\n';
+        }
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Cannot write recording " + path);
+        }
+    }
+
+    GameRecording GameRecording::load(const std::string &path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open recording " + path);
+        }
+        GameRecording recording;
+        std::string text;
+        std::size_t line = 0;
+        bool sawHeader = false;
+        bool sawSeed = false;
+        while (std::getline(in, text)) {
+            ++line;
+            if (text.empty()) {
+                continue;
+            }
+            std::istringstream fields(text);
+            std::string word;
+            fields >> word;
+            if (!sawHeader) {
+                int version = 0;
+                if (word != RECORDING_MAGIC || !(fields >> version)) {
+                    badLine(path, line, "not a game recording");
+                }
+                if (version != RECORDING_VERSION) {
+                    badLine(path, line, "unsupported version " + std::to_string(version));
+                }
+                sawHeader = true;
+            } else if (recording.ended) {
+                badLine(path, line, "text after the end of the game");
+            } else if (word == "seed") {
+                if (!(fields >> recording.seed)) {
+                    badLine(path, line, "bad seed");
+                }
+                sawSeed = true;
+            } else if (word == "seat") {
+                std::string role;
+                fields >> role;
+                const char *const *found = std::find(ROLE_NAMES, ROLE_NAMES + ROLE_COUNT, role);
+                if (found == ROLE_NAMES + ROLE_COUNT) {
+                    badLine(path, line, "unknown role '" + role + "'");
+                }
+                std::string name;
+                std::getline(fields >> std::ws, name);
+                if (name.empty() || !recording.entries.empty()) {
+                    badLine(path, line, "seats must be named and come before the first operation");
+                }
+                recording.roles.push_back(static_cast<Role>(found - ROLE_NAMES));
+                recording.names.push_back(name);
+            } else if (word == "end") {
+                std::string winner;
+                fields >> winner;
+                std::uint8_t seat = parseSeat(winner, path, line);
+                recording.winnerSeat = seat == JOURNAL_NO_SEAT ? -1 : seat;
+                recording.ended = true;
+            } else {
+                int op = 0;
+                while (op < JOURNAL_OP_COUNT && word != journalOpName(static_cast<JournalOp>(op))) {
+                    ++op;
+                }
+                std::string actor;
+                std::string target;
+                if (op == JOURNAL_OP_COUNT || !(fields >> actor >> target)) {
+                    badLine(path, line, "bad operation '" + text + "'");
+                }
+                recording.entries.push_back(
+                    JournalEntry{static_cast<JournalOp>(op), parseSeat(actor, path, line), parseSeat(target, path, line)});
+            }
+        }
+        if (!sawHeader || !sawSeed || recording.names.size() < 2) {
+            throw std::runtime_error("Recording " + path + " has no complete header");
+        }
+        return recording;
+    }
+
+    ReplayEngine::ReplayEngine(const GameRecording &recording, std::size_t checkpointInterval)
+        : game(recording.seed), names(recording.names), interval(checkpointInterval), current(0), lastCost(0) {
+        if (interval == 0) {
+            throw std::runtime_error("Replay checkpoint interval must be positive");
+        }
+        std::uint32_t unassigned = 0;  // first decision not attached to an operation yet
+        for (const JournalEntry &entry : recording.entries) {
+            if (entry.op == JournalOp::Decision) {
+                decisions.push_back(entry);
+                continue;
+            }
+            std::uint32_t made = static_cast<std::uint32_t>(decisions.size());
+            steps.push_back(Step{entry, unassigned, made - unassigned});
+            unassigned = made;
+        }
+
+        game.setConsoleMode(false);
+        table = game.setup(recording.names, recording.roles);
+        for (Player *player : table) {
+            player->setDecisionPolicy(&answers);
+        }
+        checkpoints.reserve(steps.size() / interval + 1);
+        checkpoints.emplace_back();
+        game.saveSnapshot(checkpoints.back());
+        turnStarts.push_back(0);
+        while (current < steps.size()) {
+            // A turn starts wherever the turn passes, which the turn's own operations may not show
+            // (startTurn is skipped at 10+ coins, a blocked bribe ends the turn inside the engine)
+            Player *mover = game.getCurrentPlayer();
+            apply(current);
+            ++current;
+            if (current < steps.size() && !game.isGameOver() && game.getCurrentPlayer() != mover) {
+                turnStarts.push_back(current);
+            }
+            if (current % interval == 0) {
+                checkpoints.emplace_back();
+                game.saveSnapshot(checkpoints.back());
+            }
+        }
+        lastCost = steps.size();
+    }
+
+    void ReplayEngine::apply(std::size_t position) {
+        const Step &step = steps[position];
+        for (std::uint32_t i = 0; i < step.decisionCount; ++i) {
+            answers.push(decisions[step.firstDecision + i]);
+        }
+        try {
+            performJournalEntry(game, table, step.entry);
+        } catch (const std::runtime_error &e) {
+            throw std::runtime_error("Recording diverges at operation " + std::to_string(position) + " (" +
+                                     journalOpName(step.entry.op) + "): " + e.what());
+        }
+    }
+
+    void ReplayEngine::restore(std::size_t checkpoint) {
+        table = game.loadSnapshot(checkpoints[checkpoint]);
+        answers = ReplayDecisions();
+        for (Player *player : table) {
+            player->setDecisionPolicy(&answers);
+        }
+        current = checkpoint * interval;
+    }
+
+    void ReplayEngine::seek(std::size_t position) {
+        if (position > steps.size()) {
+            throw std::runtime_error("Replay position " + std::to_string(position) + " is past the end (" +
+                                     std::to_string(steps.size()) + ")");
+        }
+        // Step forward when that is no longer than replaying from the nearest checkpoint
+        if (position < current || position - current > position % interval) {
+            restore(position / interval);
+        }
+        lastCost = position - current;
+        while (current < position) {
+            apply(current);
+            ++current;
+        }
+    }
+
+    void ReplayEngine::seekTurn(std::size_t turn) {
+        seek(turnStart(turn));
+    }
+
+    std::size_t ReplayEngine::turnStart(std::size_t turn) const {
+        if (turn > turnStarts.size()) {
+            throw std::runtime_error("Replay turn " + std::to_string(turn) + " is past the end (" +
+                                     std::to_string(turnStarts.size()) + ")");
+        }
+        return turn == turnStarts.size() ? steps.size() : turnStarts[turn];
+    }
+
+    std::size_t ReplayEngine::turnAt(std::size_t position) const {
+        std::size_t started = static_cast<std::size_t>(
+            std::upper_bound(turnStarts.begin(), turnStarts.end(), position) - turnStarts.begin());
+        return started > 0 ? started - 1 : 0;
+    }
+
+}
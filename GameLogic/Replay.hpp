@@ -0,0 +1,183 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "ActionJournal.hpp"
+#include "Game.hpp"
+#include "Role.hpp"
+#include "Snapshot.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @class GameRecording
+     * @brief A whole game as journaled: seed, table and every accepted operation
+     *
+     * Attach as the ActionJournal of a driver (e.g. SimulatedGame) to record
+     * a game, or load one saved earlier. The file format is text, one
+     * operation per line, so a recording can also be read or diffed by hand:
+     *
+     *     coup-recording 1
+     *     seed 42
+     *     seat Governor Alice
+     *     seat Spy Bob
+     *     start_turn 0 -
+     *     arrest 0 1
+     *     decision 1 0
+     *     ...
+     *     end 0
+     */
+    class GameRecording : public ActionJournal {
+    public:
+        std::uint64_t seed = 0;
+        std::vector<std::string> names;      ///< Seat order
+        std::vector<Role> roles;             ///< Seat order
+        std::vector<JournalEntry> entries;   ///< Operations and decisions in the order they happened
+        int winnerSeat = -1;                 ///< Winner, or -1 if there is none (yet)
+        bool ended = false;                  ///< Whether gameEnded() was reported
+
+        void gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                         const std::vector<Role> &roles) override;
+        void record(const JournalEntry &entry) override;
+        void gameEnded(int winnerSeat) override;
+
+        /**
+         * @brief Write the recording as text
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void save(const std::string &path) const;
+
+        /**
+         * @brief Read a recording written by save()
+         * @throws std::runtime_error naming the line of the first problem
+         */
+        static GameRecording load(const std::string &path);
+    };
+
+    /**
+     * @class ReplayEngine
+     * @brief Rebuilds a recorded game and seeks to any point in it
+     *
+     * The recording is replayed once when the engine is built, taking a
+     * GameSnapshot checkpoint every checkpointInterval operations. Seeking
+     * restores the nearest checkpoint at or before the target (unless the
+     * target is a short step forward) and replays the operations between,
+     * so any seek replays fewer than checkpointInterval operations.
+     *
+     * Positions count operations (Decision entries are not positions: they
+     * are fed to the operation they precede). Position 0 is the table as
+     * set up; position size() is the end of the recording.
+     */
+    class ReplayEngine {
+    private:
+        /**
+         * One operation with the decisions made while it ran
+         */
+        struct Step {
+            JournalEntry entry;
+            std::uint32_t firstDecision;   ///< Index into decisions
+            std::uint32_t decisionCount;
+        };
+
+        Game game;
+        Game::PlayerList table;
+        ReplayDecisions answers;
+        std::vector<std::string> names;
+        std::vector<Step> steps;
+        std::vector<JournalEntry> decisions;
+        std::vector<GameSnapshot> checkpoints;   ///< checkpoints[c] is position c * interval
+        std::vector<std::size_t> turnStarts;     ///< Position where each turn begins
+        std::size_t interval;
+        std::size_t current;
+        std::size_t lastCost;
+
+        void apply(std::size_t position);
+        void restore(std::size_t checkpoint);
+
+    public:
+        static constexpr std::size_t DEFAULT_CHECKPOINT_INTERVAL = 32;
+
+        /**
+         * @brief Replay a recording, checkpointing as it goes; the engine ends at size()
+         * @param recording Game to replay (names must fit a snapshot, see SNAPSHOT_NAME_CAPACITY)
+         * @param checkpointInterval Operations between checkpoints (K); seeks replay fewer than K
+         * @throws std::runtime_error if the interval is 0 or the engine rejects a recorded operation
+         */
+        explicit ReplayEngine(const GameRecording &recording,
+                              std::size_t checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL);
+        ReplayEngine(const ReplayEngine &other) = delete;
+        ReplayEngine &operator=(const ReplayEngine &other) = delete;
+
+        /**
+         * @brief Move the game to a position
+         * @throws std::runtime_error if position is past size()
+         */
+        void seek(std::size_t position);
+
+        /**
+         * @brief Move the game to the start of a turn, counted from 0 (turnCount() is the end of the recording)
+         * @throws std::runtime_error if turn is past turnCount()
+         */
+        void seekTurn(std::size_t turn);
+
+        /**
+         * @brief Number of operations in the recording
+         */
+        std::size_t size() const { return steps.size(); }
+
+        /**
+         * @brief Operations applied to the game so far
+         */
+        std::size_t position() const { return current; }
+
+        /**
+         * @brief Number of turns in the recording
+         */
+        std::size_t turnCount() const { return turnStarts.size(); }
+
+        /**
+         * @brief Position where a turn (counted from 0) begins; turnCount() gives size()
+         * @throws std::runtime_error if turn is past turnCount()
+         */
+        std::size_t turnStart(std::size_t turn) const;
+
+        /**
+         * @brief Turn (counted from 0) a position falls in
+         */
+        std::size_t turnAt(std::size_t position) const;
+
+        /**
+         * @brief Operation that moves the game from position to position + 1
+         */
+        const JournalEntry &operationAt(std::size_t position) const { return steps.at(position).entry; }
+
+        const std::string &seatName(std::size_t seat) const { return names.at(seat); }
+
+        std::size_t checkpointInterval() const { return interval; }
+        std::size_t checkpointCount() const { return checkpoints.size(); }
+
+        /**
+         * @brief Operations the last seek replayed (always < checkpointInterval())
+         */
+        std::size_t lastSeekCost() const { return lastCost; }
+
+        /**
+         * @brief The game at position(); its players change when a seek restores a checkpoint
+         */
+        const Game &getGame() const { return game; }
+
+        /**
+         * @brief Players in seat order, eliminated ones included
+         */
+        const Game::PlayerList &getTable() const { return table; }
+    };
+
+}
+
+#endif // REPLAY_HPP
@@ -0,0 +1,106 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace coup {
+
+    /**
+     * @class Rng
+     * @brief Small counter-based random generator (SplitMix64 output function)
+     *
+     * The n-th output is a pure function of (seed, n), so a stream can be
+     * replayed from its seed, skipped ahead in O(1), and split into
+     * independent per-game streams. Each instance is independent; share one
+     * only within a single thread.
+     *
+     * Satisfies UniformRandomBitGenerator, so it also works with <random>
+     * distributions and std::shuffle.
+     */
+    class Rng {
+    private:
+        std::uint64_t seedValue;  ///< Seed the stream was created with
+        std::uint64_t counter;    ///< Number of values drawn so far
+
+        static constexpr std::uint64_t GAMMA = 0x9E3779B97F4A7C15ULL;
+
+        static std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+    public:
+        using result_type = std::uint64_t;
+
+        /**
+         * @brief Constructor
+         * @param seed Stream seed
+         */
+        explicit Rng(std::uint64_t seed = 0) : seedValue(seed), counter(0) {}
+
+        /**
+         * @brief Derive an independent stream from a base seed
+         * @param seed Base seed (e.g. one per simulation run)
+         * @param stream Stream index (e.g. one per game)
+         * @return Generator for the given stream
+         */
+        static Rng forStream(std::uint64_t seed, std::uint64_t stream) {
+            return Rng(mix(seed ^ mix(stream + GAMMA)));
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /**
+         * @brief Draw the next 64-bit value
+         * @return Random value
+         */
+        result_type operator()() {
+            return mix(seedValue + (++counter) * GAMMA);
+        }
+
+        /**
+         * @brief Draw a uniform value in [0, bound) without modulo bias
+         * @param bound Exclusive upper bound
+         * @return Random value below bound
+         * @throws std::runtime_error if bound is zero
+         */
+        std::uint64_t uniform(std::uint64_t bound) {
+            if (bound == 0) {
+                throw std::runtime_error("Random bound must be positive");
+            }
+            const std::uint64_t limit = max() - max() % bound;
+            std::uint64_t value;
+            do {
+                value = (*this)();
+            } while (value >= limit);
+            return value % bound;
+        }
+
+        /**
+         * @brief Skip ahead without generating values
+         * @param count Number of values to skip
+         */
+        void discard(std::uint64_t count) { counter += count; }
+
+        /**
+         * @brief Restart the stream with a new seed
+         * @param seed New seed
+         */
+        void reseed(std::uint64_t seed) {
+            seedValue = seed;
+            counter = 0;
+        }
+
+        std::uint64_t getSeed() const { return seedValue; }
+        std::uint64_t getPosition() const { return counter; }
+    };
+
+}
+
+#endif // RNG_HPP
@@ -0,0 +1,27 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef ROLE_HPP
+#define ROLE_HPP
+
+#include <cstdint>
+
+namespace coup {
+
+    /**
+     * @enum Role
+     * @brief Identifies the playable roles, used for bulk game setup
+     */
+    enum class Role : std::uint8_t {
+        Governor,   ///< Enhanced tax, blocks tax
+        Spy,        ///< Peeks coins, blocks arrest
+        Baron,      ///< Invests coins, compensated on sanction
+        General,    ///< Blocks coup, compensated on arrest
+        Judge,      ///< Blocks bribe, costly to sanction
+        Merchant    ///< Bonus coin when wealthy, pays bank on arrest
+    };
+
+    constexpr int ROLE_COUNT = 6;  ///< Number of playable roles
+
+}
+
+#endif // ROLE_HPP
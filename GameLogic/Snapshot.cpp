@@ -0,0 +1,230 @@
+// Email: nitzanwa@gmail.com
+
+#include "Snapshot.hpp"
+#include "ActionMetrics.hpp"
+#include "../Players/Player.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace coup {
+
+    namespace {
+        constexpr char FILE_MAGIC[8] = {'C', 'O', 'U', 'P', 'S', 'N', 'A', 'P'};
+        constexpr std::size_t WRITE_BATCH = 4096;  // snapshots per write()
+
+        /**
+         * First 32 bytes of a snapshot file; records follow, 8-byte aligned
+         */
+        struct FileHeader {
+            char magic[8];
+            std::uint16_t version;
+            std::uint16_t recordSize;
+            std::uint32_t reserved;
+            std::uint64_t count;
+            std::uint64_t reserved2;
+        };
+
+        static_assert(sizeof(FileHeader) == 32, "FileHeader layout is part of the file format");
+
+        FileHeader makeHeader(std::uint64_t count) {
+            FileHeader header{};
+            std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+            header.version = SNAPSHOT_VERSION;
+            header.recordSize = sizeof(GameSnapshot);
+            header.count = count;
+            return header;
+        }
+
+        void writeAll(int fd, const void *data, std::size_t size, const std::string &path) {
+            const auto *in = static_cast<const char *>(data);
+            while (size > 0) {
+                ssize_t n = ::write(fd, in, size);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    throw std::runtime_error("Cannot write snapshot file " + path + ": " + std::strerror(errno));
+                }
+                in += n;
+                size -= static_cast<std::size_t>(n);
+            }
+        }
+
+        void requireSeat(std::uint8_t seat, const GameSnapshot &snapshot, bool optional, const char *field) {
+            if ((optional && seat == SNAPSHOT_NO_SEAT) || seat < snapshot.playerCount) {
+                return;
+            }
+            throw std::runtime_error(std::string("Snapshot ") + field + " refers to seat " + std::to_string(seat) +
+                                     " of a " + std::to_string(snapshot.playerCount) + "-seat table");
+        }
+    }
+
+    void validateSnapshot(const GameSnapshot &snapshot) {
+        if (snapshot.magic != SNAPSHOT_MAGIC) {
+            throw std::runtime_error("Not a game snapshot");
+        }
+        if (snapshot.version != SNAPSHOT_VERSION) {
+            throw std::runtime_error("Unsupported snapshot version " + std::to_string(snapshot.version));
+        }
+        if (snapshot.playerCount < 2 || snapshot.playerCount > Game::MAX_PLAYERS) {
+            throw std::runtime_error("Snapshot has " + std::to_string(snapshot.playerCount) + " seats");
+        }
+        if (snapshot.bankCoins < 0) {
+            throw std::runtime_error("Snapshot bank holds negative coins");
+        }
+        requireSeat(snapshot.currentSeat, snapshot, false, "current turn");
+        requireSeat(snapshot.pendingActor, snapshot, true, "pending actor");
+        requireSeat(snapshot.pendingTarget, snapshot, true, "pending target");
+        if (snapshot.pendingAction >= ACTION_TYPE_COUNT) {
+            throw std::runtime_error("Snapshot pending action is out of range");
+        }
+        for (std::size_t seat = 0; seat < snapshot.playerCount; ++seat) {
+            const PlayerSnapshot &player = snapshot.players[seat];
+            if (player.role >= ROLE_COUNT || player.nameLength > SNAPSHOT_NAME_CAPACITY ||
+                player.arrestStatus > static_cast<std::uint8_t>(ArrestStatus::Cooldown) ||
+                player.lastAction >= ACTION_TYPE_COUNT) {
+                throw std::runtime_error("Snapshot seat " + std::to_string(seat) + " is malformed");
+            }
+            requireSeat(player.lastActionTarget, snapshot, true, "last action target");
+        }
+    }
+
+    SnapshotWriter::SnapshotWriter(const std::string &path) : fd(-1), path(path), count(0) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create snapshot file " + path + ": " + std::strerror(errno));
+        }
+        FileHeader header = makeHeader(0);  // the count is written by close()
+        writeAll(fd, &header, sizeof(header), path);
+        buffer.reserve(WRITE_BATCH);
+    }
+
+    SnapshotWriter::~SnapshotWriter() {
+        try {
+            close();
+        } catch (const std::runtime_error &) {
+            // Reported only when close() is called explicitly
+        }
+    }
+
+    void SnapshotWriter::flushBuffer() {
+        writeAll(fd, buffer.data(), buffer.size() * sizeof(GameSnapshot), path);
+        buffer.clear();
+    }
+
+    void SnapshotWriter::append(const GameSnapshot &snapshot) {
+        if (fd < 0) {
+            throw std::runtime_error("Snapshot file " + path + " is closed");
+        }
+        buffer.push_back(snapshot);
+        ++count;
+        if (buffer.size() == WRITE_BATCH) {
+            flushBuffer();
+        }
+    }
+
+    void SnapshotWriter::append(const Game &game) {
+        GameSnapshot snapshot;
+        game.saveSnapshot(snapshot);
+        append(snapshot);
+    }
+
+    void SnapshotWriter::close() {
+        if (fd < 0) {
+            return;
+        }
+        int file = fd;
+        fd = -1;
+        try {
+            writeAll(file, buffer.data(), buffer.size() * sizeof(GameSnapshot), path);
+            buffer.clear();
+            FileHeader header = makeHeader(count);
+            if (::pwrite(file, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw std::runtime_error("Cannot finish snapshot file " + path + ": " + std::strerror(errno));
+            }
+        } catch (...) {
+            ::close(file);
+            throw;
+        }
+        if (::close(file) < 0) {
+            throw std::runtime_error("Cannot close snapshot file " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    SnapshotFile::SnapshotFile(const std::string &path)
+        : mapping(nullptr), mappedSize(0), records(nullptr), count(0) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open snapshot file " + path + ": " + std::strerror(errno));
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Snapshot file " + path + " is truncated");
+        }
+        std::size_t size = static_cast<std::size_t>(info.st_size);
+        void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map snapshot file " + path + ": " + std::strerror(errno));
+        }
+        mapping = data;
+        mappedSize = size;
+
+        const auto *header = static_cast<const FileHeader *>(data);
+        std::string problem;
+        if (std::memcmp(header->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            problem = "is not a snapshot file";
+        } else if (header->version != SNAPSHOT_VERSION || header->recordSize != sizeof(GameSnapshot)) {
+            problem = "has unsupported version " + std::to_string(header->version);
+        } else if (header->count > (size - sizeof(FileHeader)) / sizeof(GameSnapshot)) {
+            problem = "is truncated";
+        }
+        if (!problem.empty()) {
+            ::munmap(mapping, mappedSize);
+            throw std::runtime_error("Snapshot file " + path + " " + problem);
+        }
+        records = reinterpret_cast<const GameSnapshot *>(static_cast<const char *>(data) + sizeof(FileHeader));
+        count = static_cast<std::size_t>(header->count);
+    }
+
+    SnapshotFile::SnapshotFile(SnapshotFile &&other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr)), mappedSize(std::exchange(other.mappedSize, 0)),
+          records(std::exchange(other.records, nullptr)), count(std::exchange(other.count, 0)) {}
+
+    SnapshotFile &SnapshotFile::operator=(SnapshotFile &&other) noexcept {
+        if (this != &other) {
+            if (mapping) {
+                ::munmap(mapping, mappedSize);
+            }
+            mapping = std::exchange(other.mapping, nullptr);
+            mappedSize = std::exchange(other.mappedSize, 0);
+            records = std::exchange(other.records, nullptr);
+            count = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+    SnapshotFile::~SnapshotFile() {
+        if (mapping) {
+            ::munmap(mapping, mappedSize);
+        }
+    }
+
+    const GameSnapshot &SnapshotFile::at(std::size_t index) const {
+        if (index >= count) {
+            throw std::runtime_error("Snapshot " + std::to_string(index) + " is out of range (file holds " +
+                                     std::to_string(count) + ")");
+        }
+        return records[index];
+    }
+
+}
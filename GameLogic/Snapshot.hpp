@@ -0,0 +1,193 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "ActionType.hpp"
+#include "Game.hpp"
+#include "Role.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace coup {
+
+    constexpr std::uint32_t SNAPSHOT_MAGIC = 0x504E5343;     ///< "CSNP" in file byte order
+    constexpr std::uint16_t SNAPSHOT_VERSION = 1;            ///< Layout version of GameSnapshot
+    constexpr std::size_t SNAPSHOT_NAME_CAPACITY = 20;       ///< Longest player name a snapshot holds
+    constexpr std::uint8_t SNAPSHOT_NO_SEAT = 0xFF;          ///< "No player" in seat fields
+
+    /**
+     * @brief PlayerSnapshot::flags bits
+     */
+    enum SnapshotPlayerFlag : std::uint8_t {
+        SNAPSHOT_ALIVE = 1 << 0,
+        SNAPSHOT_SANCTIONED = 1 << 1,
+        SNAPSHOT_ACTION_BLOCKED = 1 << 2,
+        SNAPSHOT_ARREST_BLOCKED = 1 << 3,
+        SNAPSHOT_BRIBE_USED = 1 << 4
+    };
+
+    /**
+     * @struct PlayerSnapshot
+     * @brief State of one seat, 32 bytes; players are referenced by seat
+     */
+    struct PlayerSnapshot {
+        char name[SNAPSHOT_NAME_CAPACITY];  ///< Not NUL-terminated when full
+        std::int16_t coins;
+        std::uint8_t nameLength;
+        std::uint8_t role;                  ///< Role
+        std::uint8_t flags;                 ///< SnapshotPlayerFlag bits
+        std::uint8_t arrestStatus;          ///< ArrestStatus
+        std::uint8_t lastAction;            ///< ActionType
+        std::uint8_t lastActionTarget;      ///< Seat, or SNAPSHOT_NO_SEAT
+        std::uint8_t reserved[4];
+
+        std::string_view getName() const { return std::string_view(name, nameLength); }
+        Role getRole() const { return static_cast<Role>(role); }
+        bool has(SnapshotPlayerFlag flag) const { return (flags & flag) != 0; }
+    };
+
+    /**
+     * @struct GameSnapshot
+     * @brief Complete state of a game between actions, in a fixed 224-byte layout
+     *
+     * Plain bytes with no pointers: a snapshot can be written to a file as
+     * is, and a file of them read in place (see SnapshotFile) without
+     * parsing or allocating. Every seat of the table is kept, eliminated
+     * ones included, so seat numbers stay stable. The random stream is
+     * stored as seed and position, so a restored game draws what the
+     * original would have drawn next. Integers are little-endian.
+     */
+    struct GameSnapshot {
+        std::uint32_t magic;             ///< SNAPSHOT_MAGIC
+        std::uint16_t version;           ///< SNAPSHOT_VERSION
+        std::uint8_t playerCount;        ///< Seats in use
+        std::uint8_t currentSeat;        ///< Seat whose turn it is
+        std::uint64_t seed;              ///< Rng seed
+        std::uint64_t rngPosition;       ///< Values drawn from the Rng so far
+        std::int16_t bankCoins;
+        std::uint8_t pendingActor;       ///< Seat, or SNAPSHOT_NO_SEAT
+        std::uint8_t pendingAction;      ///< ActionType
+        std::uint8_t pendingTarget;      ///< Seat, or SNAPSHOT_NO_SEAT
+        std::uint8_t reserved[3];
+        PlayerSnapshot players[Game::MAX_PLAYERS];
+
+        /**
+         * @brief Number of seats still in the game
+         */
+        std::size_t aliveCount() const {
+            std::size_t alive = 0;
+            for (std::size_t seat = 0; seat < playerCount; ++seat) {
+                alive += players[seat].has(SNAPSHOT_ALIVE) ? 1 : 0;
+            }
+            return alive;
+        }
+    };
+
+    static_assert(sizeof(PlayerSnapshot) == 32, "PlayerSnapshot layout is part of the file format");
+    static_assert(sizeof(GameSnapshot) == 224, "GameSnapshot layout is part of the file format");
+    static_assert(std::is_trivially_copyable<GameSnapshot>::value, "snapshots are copied as raw bytes");
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "snapshot files are little-endian");
+
+    /**
+     * @brief Check that a snapshot is well-formed before it is loaded
+     * @throws std::runtime_error naming the first problem (magic, version, seat or enum out of range)
+     */
+    void validateSnapshot(const GameSnapshot &snapshot);
+
+    /**
+     * @class SnapshotWriter
+     * @brief Writes a snapshot file: a 32-byte header, then packed GameSnapshots
+     */
+    class SnapshotWriter {
+    private:
+        int fd;
+        std::string path;
+        std::uint64_t count;
+        std::vector<GameSnapshot> buffer;  ///< Snapshots not written yet
+
+        void flushBuffer();
+
+    public:
+        /**
+         * @brief Create (or replace) a snapshot file
+         * @throws std::runtime_error if the file cannot be created
+         */
+        explicit SnapshotWriter(const std::string &path);
+        SnapshotWriter(const SnapshotWriter &other) = delete;
+        SnapshotWriter &operator=(const SnapshotWriter &other) = delete;
+
+        /**
+         * @brief Destructor - closes the file (errors are only reported by close())
+         */
+        ~SnapshotWriter();
+
+        /**
+         * @brief Append a snapshot (buffered)
+         */
+        void append(const GameSnapshot &snapshot);
+
+        /**
+         * @brief Append the current state of a game
+         */
+        void append(const Game &game);
+
+        /**
+         * @brief Write what is buffered and the final count, then close the file
+         * @throws std::runtime_error if a write fails
+         */
+        void close();
+
+        std::uint64_t size() const { return count; }
+    };
+
+    /**
+     * @class SnapshotFile
+     * @brief Read-only view of a snapshot file mapped into memory
+     *
+     * Records are GameSnapshots in place: indexing returns a reference
+     * into the mapping, so scanning millions of positions costs page
+     * faults only. The header is checked when the file is opened; records
+     * are not (validateSnapshot() or Game::loadSnapshot() check one).
+     */
+    class SnapshotFile {
+    private:
+        void *mapping;
+        std::size_t mappedSize;
+        const GameSnapshot *records;
+        std::size_t count;
+
+    public:
+        /**
+         * @brief Map a snapshot file
+         * @throws std::runtime_error if the file is missing, truncated or of another format or version
+         */
+        explicit SnapshotFile(const std::string &path);
+        SnapshotFile(SnapshotFile &&other) noexcept;
+        SnapshotFile &operator=(SnapshotFile &&other) noexcept;
+        SnapshotFile(const SnapshotFile &other) = delete;
+        SnapshotFile &operator=(const SnapshotFile &other) = delete;
+        ~SnapshotFile();
+
+        std::size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const GameSnapshot &operator[](std::size_t index) const { return records[index]; }
+
+        /**
+         * @brief Bounds-checked access
+         * @throws std::runtime_error if index is out of range
+         */
+        const GameSnapshot &at(std::size_t index) const;
+
+        const GameSnapshot *begin() const { return records; }
+        const GameSnapshot *end() const { return records + count; }
+    };
+
+}
+
+#endif // SNAPSHOT_HPP
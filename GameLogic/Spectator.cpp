@@ -0,0 +1,476 @@
+// Email: nitzanwa@gmail.com
+
+#include "Spectator.hpp"
+#include "Game.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        enum FrameKind : std::uint8_t { KEYFRAME = 1, DELTA = 2 };
+
+        // Delta records: op, seat, then the op's value
+        enum SpectatorOp : std::uint8_t {
+            OP_SEAT_JOINED = 1,     // name, role
+            OP_COINS,               // zigzag varint coin difference
+            OP_SANCTIONED,          // u8 flag
+            OP_ARREST_STATUS,       // u8 ArrestStatus
+            OP_ARREST_BLOCKED,      // u8 flag
+            OP_ELIMINATED,
+            OP_TURN,
+            OP_ACTION,              // u8 ActionType, u8 target seat
+            OP_ACTION_RESOLVED,
+            OP_WINNER
+        };
+
+        enum SeatFlags : std::uint8_t { SEAT_ALIVE = 1, SEAT_SANCTIONED = 2, SEAT_ARREST_BLOCKED = 4 };
+
+        void putU32(std::vector<std::uint8_t> &out, std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        void putVarint(std::vector<std::uint8_t> &out, int value) {
+            std::uint32_t zigzag = (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+            while (zigzag >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(zigzag | 0x80));
+                zigzag >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(zigzag));
+        }
+
+        void putString(std::vector<std::uint8_t> &out, const std::string &text) {
+            std::size_t length = std::min<std::size_t>(text.size(), 255);
+            out.push_back(static_cast<std::uint8_t>(length));
+            out.insert(out.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(length));
+        }
+
+        void beginFrame(std::vector<std::uint8_t> &out, FrameKind kind, std::uint32_t sequence) {
+            putU32(out, 0);  // patched by endFrame()
+            out.push_back(kind);
+            putU32(out, sequence);
+        }
+
+        void endFrame(std::vector<std::uint8_t> &out, std::size_t start) {
+            std::uint32_t length = static_cast<std::uint32_t>(out.size() - start - 4);
+            for (int i = 0; i < 4; ++i) {
+                out[start + i] = static_cast<std::uint8_t>(length >> (8 * i));
+            }
+        }
+
+        std::uint32_t getU32(const std::uint8_t *data) {
+            return static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+                   static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24;
+        }
+
+        /**
+         * Bounds-checked reader over one frame body
+         */
+        class FrameReader {
+        private:
+            const std::uint8_t *pos;
+            const std::uint8_t *end;
+
+        public:
+            FrameReader(const std::uint8_t *begin, const std::uint8_t *end) : pos(begin), end(end) {}
+
+            bool done() const { return pos == end; }
+
+            std::uint8_t byte() {
+                if (pos == end) {
+                    throw std::runtime_error("Malformed spectator frame: truncated");
+                }
+                return *pos++;
+            }
+
+            int varint() {
+                std::uint32_t zigzag = 0;
+                for (int shift = 0; shift < 35; shift += 7) {
+                    std::uint8_t b = byte();
+                    zigzag |= static_cast<std::uint32_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        return static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+                    }
+                }
+                throw std::runtime_error("Malformed spectator frame: bad varint");
+            }
+
+            void string(std::string &out) {
+                std::size_t length = byte();
+                if (static_cast<std::size_t>(end - pos) < length) {
+                    throw std::runtime_error("Malformed spectator frame: truncated");
+                }
+                out.assign(reinterpret_cast<const char *>(pos), length);
+                pos += length;
+            }
+        };
+
+        ArrestStatus toArrestStatus(std::uint8_t value) {
+            if (value > static_cast<std::uint8_t>(ArrestStatus::Cooldown)) {
+                throw std::runtime_error("Malformed spectator frame: bad arrest status");
+            }
+            return static_cast<ArrestStatus>(value);
+        }
+    }
+
+    bool isKeyframe(const std::vector<std::uint8_t> &frame) {
+        return frame.size() >= SPECTATOR_FRAME_HEADER && frame[4] == KEYFRAME;
+    }
+
+    // ========================================
+    // SpectatorState
+    // ========================================
+
+    void SpectatorState::clear() {
+        currentSeat = SPECTATOR_NO_SEAT;
+        winnerSeat = SPECTATOR_NO_SEAT;
+        actorSeat = SPECTATOR_NO_SEAT;
+        action = ActionType::None;
+        targetSeat = SPECTATOR_NO_SEAT;
+        seats.clear();
+    }
+
+    std::size_t SpectatorState::frameSize(const std::uint8_t *data, std::size_t available) {
+        if (available < 4) {
+            return 0;
+        }
+        std::uint32_t length = getU32(data);
+        if (length < SPECTATOR_FRAME_HEADER - 4 || length > (1u << 20)) {
+            throw std::runtime_error("Malformed spectator frame: bad length");
+        }
+        return available - 4 >= length ? length + 4 : 0;
+    }
+
+    void SpectatorState::writeKeyframe(std::vector<std::uint8_t> &out, std::uint32_t frameSequence) const {
+        std::size_t start = out.size();
+        beginFrame(out, KEYFRAME, frameSequence);
+        out.push_back(static_cast<std::uint8_t>(seats.size()));
+        out.push_back(currentSeat);
+        out.push_back(winnerSeat);
+        out.push_back(actorSeat);
+        out.push_back(static_cast<std::uint8_t>(action));
+        out.push_back(targetSeat);
+        for (const SpectatorSeat &seat : seats) {
+            out.push_back(static_cast<std::uint8_t>((seat.alive ? SEAT_ALIVE : 0) |
+                                                    (seat.sanctioned ? SEAT_SANCTIONED : 0) |
+                                                    (seat.arrestBlocked ? SEAT_ARREST_BLOCKED : 0)));
+            out.push_back(static_cast<std::uint8_t>(seat.arrestStatus));
+            putVarint(out, seat.coins);
+            putString(out, seat.name);
+            putString(out, seat.role);
+        }
+        endFrame(out, start);
+    }
+
+    bool SpectatorState::apply(const std::uint8_t *data, std::size_t size) {
+        if (size < SPECTATOR_FRAME_HEADER || getU32(data) != size - 4) {
+            throw std::runtime_error("Malformed spectator frame: bad length");
+        }
+        std::uint8_t kind = data[4];
+        std::uint32_t frameSequence = getU32(data + 5);
+        FrameReader in(data + SPECTATOR_FRAME_HEADER, data + size);
+
+        if (kind == KEYFRAME) {
+            std::size_t count = in.byte();
+            std::uint8_t current = in.byte();
+            std::uint8_t winner = in.byte();
+            std::uint8_t actor = in.byte();
+            std::uint8_t pending = in.byte();
+            std::uint8_t target = in.byte();
+            seats.resize(count);
+            for (SpectatorSeat &seat : seats) {
+                std::uint8_t flags = in.byte();
+                seat.alive = (flags & SEAT_ALIVE) != 0;
+                seat.sanctioned = (flags & SEAT_SANCTIONED) != 0;
+                seat.arrestBlocked = (flags & SEAT_ARREST_BLOCKED) != 0;
+                seat.arrestStatus = toArrestStatus(in.byte());
+                seat.coins = in.varint();
+                in.string(seat.name);
+                in.string(seat.role);
+            }
+            currentSeat = current;
+            winnerSeat = winner;
+            actorSeat = actor;
+            action = static_cast<ActionType>(pending);
+            targetSeat = target;
+            sequence = frameSequence;
+            synced = true;
+            return true;
+        }
+        if (kind != DELTA) {
+            throw std::runtime_error("Malformed spectator frame: unknown kind");
+        }
+        if (!synced || frameSequence != sequence + 1) {
+            return false;  // missed a frame: wait for the next keyframe
+        }
+
+        while (!in.done()) {
+            std::uint8_t op = in.byte();
+            std::uint8_t seat = in.byte();
+            if (op == OP_SEAT_JOINED) {
+                if (seat != seats.size()) {
+                    throw std::runtime_error("Malformed spectator frame: seat out of order");
+                }
+                seats.emplace_back();
+                in.string(seats.back().name);
+                in.string(seats.back().role);
+                if (currentSeat == SPECTATOR_NO_SEAT) {
+                    currentSeat = seat;
+                }
+                continue;
+            }
+            if (op != OP_ACTION_RESOLVED && seat >= seats.size()) {
+                throw std::runtime_error("Malformed spectator frame: unknown seat");
+            }
+            switch (op) {
+                case OP_COINS: seats[seat].coins += in.varint(); break;
+                case OP_SANCTIONED: seats[seat].sanctioned = in.byte() != 0; break;
+                case OP_ARREST_STATUS: seats[seat].arrestStatus = toArrestStatus(in.byte()); break;
+                case OP_ARREST_BLOCKED: seats[seat].arrestBlocked = in.byte() != 0; break;
+                case OP_ELIMINATED: seats[seat].alive = false; break;
+                case OP_TURN: currentSeat = seat; break;
+                case OP_ACTION:
+                    actorSeat = seat;
+                    action = static_cast<ActionType>(in.byte());
+                    targetSeat = in.byte();
+                    break;
+                case OP_ACTION_RESOLVED:
+                    actorSeat = SPECTATOR_NO_SEAT;
+                    action = ActionType::None;
+                    targetSeat = SPECTATOR_NO_SEAT;
+                    break;
+                case OP_WINNER: winnerSeat = seat; break;
+                default: throw std::runtime_error("Malformed spectator frame: unknown op");
+            }
+        }
+        sequence = frameSequence;
+        return true;
+    }
+
+    // ========================================
+    // SpectatorBroadcaster
+    // ========================================
+
+    SpectatorBroadcaster::SpectatorBroadcaster(unsigned keyframeInterval)
+        : attached(nullptr), source(nullptr), announcedSeats(0), sequence(0),
+          keyframeInterval(std::max(keyframeInterval, 1u)), framesSinceKeyframe(0), needKeyframe(true),
+          framesSent(0), keyframesSent(0), bytesEncoded(0) {}
+
+    SpectatorBroadcaster::~SpectatorBroadcaster() {
+        if (attached) {
+            attached->unsubscribe(this);
+        }
+    }
+
+    void SpectatorBroadcaster::attach(Game &game) {
+        detach();
+        attached = &game;
+        game.subscribe(this);
+        restart(game);
+        flush();
+    }
+
+    void SpectatorBroadcaster::detach() {
+        if (attached) {
+            flush();
+            attached->unsubscribe(this);
+            attached = nullptr;
+        }
+    }
+
+    void SpectatorBroadcaster::reset() {
+        flush();
+        source = nullptr;
+    }
+
+    void SpectatorBroadcaster::restart(const Game &game) {
+        source = &game;
+        mirror.clear();
+        seatPlayers = game.getAllAlivePlayers();
+        for (Player *player : seatPlayers) {
+            mirror.seats.emplace_back();
+            SpectatorSeat &seat = mirror.seats.back();
+            seat.name = player->getName();
+            seat.coins = player->getCoins();
+            seat.sanctioned = player->isSanctioned();
+            seat.arrestBlocked = player->isArrestBlocked();
+            seat.arrestStatus = player->getArrestStatus();
+        }
+        mirror.currentSeat = seatOf(game.getCurrentPlayer());
+        announcedSeats = 0;
+        pendingOps.clear();
+        needKeyframe = true;
+    }
+
+    std::uint8_t SpectatorBroadcaster::seatOf(const Player *player) const {
+        for (std::size_t seat = 0; seat < seatPlayers.size(); ++seat) {
+            if (seatPlayers[seat] == player) {
+                return static_cast<std::uint8_t>(seat);
+            }
+        }
+        return SPECTATOR_NO_SEAT;
+    }
+
+    void SpectatorBroadcaster::pushOp(std::uint8_t op, std::uint8_t seat) {
+        pendingOps.push_back(op);
+        pendingOps.push_back(seat);
+    }
+
+    void SpectatorBroadcaster::onGameEvent(Game &game, const GameEvent &event) {
+        std::uint8_t seat = seatOf(event.player);
+        if (&game != source ||
+            (event.type == GameEventType::PlayerJoined && seat == SPECTATOR_NO_SEAT && game.aliveCount() == 1)) {
+            // Another game, or the first player of a game that was reset
+            restart(game);
+            seat = seatOf(event.player);
+        }
+        if (event.type == GameEventType::PlayerJoined) {
+            if (seat == SPECTATOR_NO_SEAT && seatPlayers.size() < SPECTATOR_NO_SEAT) {
+                // Announced at the next flush: the role is not known while the player is constructed
+                seatPlayers.push_back(event.player);
+                mirror.seats.emplace_back();
+                mirror.seats.back().name = event.player->getName();
+                if (mirror.currentSeat == SPECTATOR_NO_SEAT) {
+                    mirror.currentSeat = static_cast<std::uint8_t>(seatPlayers.size() - 1);
+                }
+            }
+            return;
+        }
+        if (seat == SPECTATOR_NO_SEAT && event.type != GameEventType::PendingActionResolved) {
+            return;
+        }
+
+        switch (event.type) {
+            case GameEventType::CoinsChanged: {
+                int diff = event.newValue - mirror.seats[seat].coins;
+                if (diff != 0) {
+                    pushOp(OP_COINS, seat);
+                    putVarint(pendingOps, diff);
+                    mirror.seats[seat].coins = event.newValue;
+                }
+                break;
+            }
+            case GameEventType::SanctionChanged:
+                pushOp(OP_SANCTIONED, seat);
+                pendingOps.push_back(event.newValue != 0);
+                mirror.seats[seat].sanctioned = event.newValue != 0;
+                break;
+            case GameEventType::ArrestStatusChanged:
+                pushOp(OP_ARREST_STATUS, seat);
+                pendingOps.push_back(static_cast<std::uint8_t>(event.newValue));
+                mirror.seats[seat].arrestStatus = static_cast<ArrestStatus>(event.newValue);
+                break;
+            case GameEventType::ArrestBlockedChanged:
+                pushOp(OP_ARREST_BLOCKED, seat);
+                pendingOps.push_back(event.newValue != 0);
+                mirror.seats[seat].arrestBlocked = event.newValue != 0;
+                break;
+            case GameEventType::PlayerEliminated:
+                pushOp(OP_ELIMINATED, seat);
+                mirror.seats[seat].alive = false;
+                break;
+            case GameEventType::TurnAdvanced:
+                pushOp(OP_TURN, seat);
+                mirror.currentSeat = seat;
+                flush();
+                break;
+            case GameEventType::PendingActionSet:
+                pushOp(OP_ACTION, seat);
+                pendingOps.push_back(static_cast<std::uint8_t>(event.action));
+                pendingOps.push_back(seatOf(event.target));
+                mirror.actorSeat = seat;
+                mirror.action = event.action;
+                mirror.targetSeat = seatOf(event.target);
+                break;
+            case GameEventType::PendingActionResolved:
+                pushOp(OP_ACTION_RESOLVED, SPECTATOR_NO_SEAT);
+                mirror.actorSeat = SPECTATOR_NO_SEAT;
+                mirror.action = ActionType::None;
+                mirror.targetSeat = SPECTATOR_NO_SEAT;
+                break;
+            case GameEventType::GameOver:
+                pushOp(OP_WINNER, seat);
+                mirror.winnerSeat = seat;
+                flush();
+                break;
+            default:
+                break;
+        }
+    }
+
+    void SpectatorBroadcaster::flush() {
+        if (!source || (!needKeyframe && pendingOps.empty() && announcedSeats == seatPlayers.size())) {
+            return;
+        }
+        for (std::size_t seat = announcedSeats; seat < seatPlayers.size(); ++seat) {
+            mirror.seats[seat].role = seatPlayers[seat]->getRoleName();
+        }
+
+        std::vector<std::uint8_t> frame;
+        bool keyframe = needKeyframe || framesSinceKeyframe + 1 >= keyframeInterval;
+        ++sequence;
+        if (keyframe) {
+            mirror.writeKeyframe(frame, sequence);
+        } else {
+            frame.reserve(SPECTATOR_FRAME_HEADER + pendingOps.size());
+            beginFrame(frame, DELTA, sequence);
+            for (std::size_t seat = announcedSeats; seat < seatPlayers.size(); ++seat) {
+                frame.push_back(OP_SEAT_JOINED);
+                frame.push_back(static_cast<std::uint8_t>(seat));
+                putString(frame, mirror.seats[seat].name);
+                putString(frame, mirror.seats[seat].role);
+            }
+            frame.insert(frame.end(), pendingOps.begin(), pendingOps.end());
+            endFrame(frame, 0);
+        }
+        announcedSeats = seatPlayers.size();
+        pendingOps.clear();
+        needKeyframe = false;
+        emit(std::move(frame), keyframe);
+    }
+
+    void SpectatorBroadcaster::sendKeyframe() {
+        flush();
+        if (source) {
+            needKeyframe = true;
+            flush();
+        }
+    }
+
+    void SpectatorBroadcaster::emit(std::vector<std::uint8_t> &&frame, bool keyframe) {
+        mirror.sequence = sequence;
+        mirror.synced = true;
+        ++framesSent;
+        if (keyframe) {
+            ++keyframesSent;
+            framesSinceKeyframe = 0;
+        } else {
+            ++framesSinceKeyframe;
+        }
+        bytesEncoded += frame.size();
+
+        // Encoded once; every sink shares the same buffer
+        SpectatorFrame shared = std::make_shared<const std::vector<std::uint8_t>>(std::move(frame));
+        for (SpectatorSink *sink : sinks) {
+            sink->deliver(shared);
+        }
+    }
+
+    void SpectatorBroadcaster::addSink(SpectatorSink *sink) {
+        flush();
+        sinks.push_back(sink);
+        if (source && mirror.synced) {
+            std::vector<std::uint8_t> frame;
+            mirror.writeKeyframe(frame, sequence);
+            sink->deliver(std::make_shared<const std::vector<std::uint8_t>>(std::move(frame)));
+        }
+    }
+
+    void SpectatorBroadcaster::removeSink(SpectatorSink *sink) {
+        sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+    }
+
+}
@@ -0,0 +1,209 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef SPECTATOR_HPP
+#define SPECTATOR_HPP
+
+#include "GameEvents.hpp"
+#include "../Players/Player.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @brief One encoded spectator frame, shared by every spectator it is sent to
+     *
+     * Wire layout (little endian): u32 length of the rest, u8 kind
+     * (keyframe/delta), u32 sequence number, then the body. A keyframe holds
+     * the whole table; a delta holds the changes of one turn as
+     * (op, seat, value) records, coins as signed differences.
+     */
+    using SpectatorFrame = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+    constexpr std::size_t SPECTATOR_FRAME_HEADER = 9;  ///< Length, kind and sequence bytes
+    constexpr std::uint8_t SPECTATOR_NO_SEAT = 0xFF;   ///< Seat value meaning "nobody"
+
+    /**
+     * @brief Whether an encoded frame is a keyframe
+     */
+    bool isKeyframe(const std::vector<std::uint8_t> &frame);
+
+    /**
+     * @struct SpectatorSeat
+     * @brief What a spectator sees of one player
+     */
+    struct SpectatorSeat {
+        std::string name;
+        std::string role;
+        int coins = 0;
+        bool alive = true;
+        bool sanctioned = false;
+        bool arrestBlocked = false;
+        ArrestStatus arrestStatus = ArrestStatus::Available;
+    };
+
+    /**
+     * @class SpectatorState
+     * @brief A table as reconstructed from spectator frames
+     *
+     * Spectators feed every received frame to apply(). Keyframes replace the
+     * state; a delta is applied only if it directly follows the last frame,
+     * otherwise the state waits for the next keyframe.
+     */
+    class SpectatorState {
+    public:
+        std::uint32_t sequence = 0;                 ///< Sequence of the last applied frame
+        bool synced = false;                        ///< Whether a keyframe has been applied
+        std::uint8_t currentSeat = SPECTATOR_NO_SEAT;
+        std::uint8_t winnerSeat = SPECTATOR_NO_SEAT;
+        std::uint8_t actorSeat = SPECTATOR_NO_SEAT;  ///< Seat with a pending action
+        ActionType action = ActionType::None;        ///< Pending action
+        std::uint8_t targetSeat = SPECTATOR_NO_SEAT; ///< Target of the pending action
+        std::vector<SpectatorSeat> seats;
+
+        /**
+         * @brief Apply one complete frame
+         * @return false if the frame is a delta that does not follow this state
+         * @throws std::runtime_error if the frame is malformed
+         */
+        bool apply(const std::uint8_t *data, std::size_t size);
+
+        /**
+         * @brief Encode this state as a keyframe
+         * @param out Buffer the frame is appended to
+         * @param frameSequence Sequence number written into the frame
+         */
+        void writeKeyframe(std::vector<std::uint8_t> &out, std::uint32_t frameSequence) const;
+
+        /**
+         * @brief Forget the table (no seats, nobody to move)
+         */
+        void clear();
+
+        /**
+         * @brief Size of the frame at the start of a byte stream
+         * @return Frame size in bytes, or 0 if more bytes are needed
+         * @throws std::runtime_error if the length prefix is invalid
+         */
+        static std::size_t frameSize(const std::uint8_t *data, std::size_t available);
+    };
+
+    /**
+     * @class SpectatorSink
+     * @brief Destination of encoded frames (a socket server, a recorder, ...)
+     */
+    class SpectatorSink {
+    public:
+        virtual ~SpectatorSink() = default;
+
+        /**
+         * @brief Called once per frame; the buffer may be kept and shared
+         */
+        virtual void deliver(const SpectatorFrame &frame) = 0;
+    };
+
+    /**
+     * @class SpectatorBroadcaster
+     * @brief Turns a game's change events into spectator frames
+     *
+     * Changes are collected as the turn plays out and sent as one delta when
+     * the turn advances or the game ends (or on flush()). Every
+     * keyframeInterval-th frame is a keyframe so spectators that fell behind
+     * resynchronise quickly. Each frame is encoded once and the same buffer
+     * is handed to every sink.
+     *
+     * The broadcaster follows whichever game its events come from: events
+     * from a different game restart the stream with a keyframe. Call reset()
+     * between games that may reuse the same address.
+     */
+    class SpectatorBroadcaster : public GameObserver {
+    private:
+        Game *attached;                     ///< Game subscribed through attach()
+        const Game *source;                 ///< Game the current stream describes
+        std::vector<Player *> seatPlayers;  ///< Player of each seat
+        std::size_t announcedSeats;         ///< Seats already sent (their role is known)
+        SpectatorState mirror;              ///< State after all recorded changes
+        std::vector<std::uint8_t> pendingOps;
+        std::uint32_t sequence;
+        unsigned keyframeInterval;
+        unsigned framesSinceKeyframe;
+        bool needKeyframe;
+        std::vector<SpectatorSink *> sinks;
+        std::uint64_t framesSent;
+        std::uint64_t keyframesSent;
+        std::uint64_t bytesEncoded;
+
+        void restart(const Game &game);
+        std::uint8_t seatOf(const Player *player) const;
+        void pushOp(std::uint8_t op, std::uint8_t seat);
+        void emit(std::vector<std::uint8_t> &&frame, bool keyframe);
+
+    public:
+        /**
+         * @brief Constructor
+         * @param keyframeInterval A keyframe replaces every keyframeInterval-th frame
+         */
+        explicit SpectatorBroadcaster(unsigned keyframeInterval = 32);
+        SpectatorBroadcaster(const SpectatorBroadcaster &other) = delete;
+        SpectatorBroadcaster &operator=(const SpectatorBroadcaster &other) = delete;
+
+        /**
+         * @brief Destructor - unsubscribes from an attached game
+         */
+        ~SpectatorBroadcaster() override;
+
+        /**
+         * @brief Subscribe to a game and restart the stream from its current state
+         */
+        void attach(Game &game);
+
+        /**
+         * @brief Unsubscribe from the attached game (pending changes are flushed)
+         */
+        void detach();
+
+        /**
+         * @brief Forget the current game; the next event starts a new stream
+         */
+        void reset();
+
+        /**
+         * @brief Add a sink; it immediately receives a keyframe of the current state
+         */
+        void addSink(SpectatorSink *sink);
+
+        /**
+         * @brief Remove a sink
+         */
+        void removeSink(SpectatorSink *sink);
+
+        /**
+         * @brief Send the changes recorded since the last frame
+         */
+        void flush();
+
+        /**
+         * @brief Flush, then send a keyframe to every sink
+         */
+        void sendKeyframe();
+
+        /**
+         * @brief Reconstructed state after all recorded changes
+         */
+        const SpectatorState &state() const { return mirror; }
+
+        std::uint32_t getSequence() const { return sequence; }
+        std::uint64_t getFramesSent() const { return framesSent; }
+        std::uint64_t getKeyframesSent() const { return keyframesSent; }
+        std::uint64_t getBytesEncoded() const { return bytesEncoded; }
+
+        void onGameEvent(Game &game, const GameEvent &event) override;
+    };
+
+}
+
+#endif // SPECTATOR_HPP
@@ -0,0 +1,277 @@
+// Email: nitzanwa@gmail.com
+
+#include "SpectatorServer.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        constexpr int MAX_IOVECS = 64;  // frames per gathered write
+    }
+
+    SpectatorServer::SpectatorServer(std::size_t maxQueuedFrames)
+        : listenFd(-1), wakeFds{-1, -1}, maxQueuedFrames(maxQueuedFrames), stopping(false), clientCount(0),
+          bytesSent(0), resyncs(0) {}
+
+    SpectatorServer::~SpectatorServer() {
+        stop();
+    }
+
+    void SpectatorServer::listen(const std::string &path) {
+        if (listenFd >= 0) {
+            throw std::runtime_error("Spectator server is already listening");
+        }
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Spectator socket path is too long: " + path);
+        }
+        // Create the wake pipe first so a failure after bind() can only come from listen()
+        if (::pipe2(wakeFds, O_NONBLOCK | O_CLOEXEC) < 0) {
+            throw std::runtime_error("Cannot create spectator wake pipe: " + std::string(std::strerror(errno)));
+        }
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            std::string reason = std::strerror(errno);
+            ::close(wakeFds[0]);
+            ::close(wakeFds[1]);
+            wakeFds[0] = wakeFds[1] = -1;
+            throw std::runtime_error("Cannot create spectator socket: " + reason);
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str());
+        bool bound = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+        if (!bound || ::listen(fd, SOMAXCONN) < 0) {
+            std::string reason = std::strerror(errno);
+            ::close(fd);
+            if (bound) {
+                ::unlink(path.c_str());
+            }
+            ::close(wakeFds[0]);
+            ::close(wakeFds[1]);
+            wakeFds[0] = wakeFds[1] = -1;
+            throw std::runtime_error("Cannot listen on spectator socket " + path + ": " + reason);
+        }
+        listenFd = fd;
+        socketPath = path;
+        stopping.store(false);
+        // deliver() only wakes on an empty inbox, so frames that arrived before now need a wake of their own
+        bool pending;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            pending = !inbox.empty();
+        }
+        if (pending) {
+            char wake = 1;
+            (void)!::write(wakeFds[1], &wake, 1);
+        }
+        worker = std::thread(&SpectatorServer::run, this);
+    }
+
+    void SpectatorServer::stop() {
+        if (listenFd < 0) {
+            return;
+        }
+        stopping.store(true);
+        char wake = 1;
+        (void)!::write(wakeFds[1], &wake, 1);
+        worker.join();
+
+        for (Client &client : clients) {
+            ::close(client.fd);
+        }
+        clients.clear();
+        clientCount.store(0);
+        ::close(listenFd);
+        ::close(wakeFds[0]);
+        ::close(wakeFds[1]);
+        listenFd = wakeFds[0] = wakeFds[1] = -1;
+        ::unlink(socketPath.c_str());
+        lastKeyframe.reset();
+        sinceKeyframe.clear();
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            inbox.clear();
+        }
+    }
+
+    void SpectatorServer::deliver(const SpectatorFrame &frame) {
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            wasEmpty = inbox.empty();
+            inbox.push_back(frame);
+        }
+        if (wasEmpty && wakeFds[1] >= 0) {
+            char wake = 1;
+            (void)!::write(wakeFds[1], &wake, 1);
+        }
+    }
+
+    void SpectatorServer::catchUp(Client &client) {
+        // Keep a partly written frame so the byte stream stays aligned
+        while (client.queue.size() > (client.offset > 0 ? 1u : 0u)) {
+            client.queue.pop_back();
+        }
+        if (lastKeyframe) {
+            client.queue.push_back(lastKeyframe);
+            client.queue.insert(client.queue.end(), sinceKeyframe.begin(), sinceKeyframe.end());
+        }
+    }
+
+    void SpectatorServer::queueFrames(std::vector<SpectatorFrame> &frames) {
+        for (const SpectatorFrame &frame : frames) {
+            if (isKeyframe(*frame)) {
+                lastKeyframe = frame;
+                sinceKeyframe.clear();
+            } else if (lastKeyframe) {
+                sinceKeyframe.push_back(frame);
+            }
+        }
+        for (Client &client : clients) {
+            if (client.queue.size() + frames.size() <= maxQueuedFrames) {
+                client.queue.insert(client.queue.end(), frames.begin(), frames.end());
+            } else {
+                catchUp(client);  // already ends with the newest frame
+                resyncs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        frames.clear();
+    }
+
+    void SpectatorServer::acceptClients() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                break;  // EAGAIN, or out of descriptors until a client leaves
+            }
+            clients.push_back(Client{fd, {}, 0});
+            catchUp(clients.back());
+        }
+        clientCount.store(clients.size(), std::memory_order_relaxed);
+    }
+
+    bool SpectatorServer::writeClient(Client &client) {
+        while (!client.queue.empty()) {
+            iovec iov[MAX_IOVECS];
+            int count = 0;
+            for (const SpectatorFrame &frame : client.queue) {
+                if (count == MAX_IOVECS) {
+                    break;
+                }
+                std::size_t skip = count == 0 ? client.offset : 0;
+                iov[count].iov_base = const_cast<std::uint8_t *>(frame->data() + skip);
+                iov[count].iov_len = frame->size() - skip;
+                ++count;
+            }
+            msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = static_cast<std::size_t>(count);
+            ssize_t n = ::sendmsg(client.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            bytesSent.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+
+            std::size_t written = static_cast<std::size_t>(n);
+            while (written > 0) {
+                std::size_t left = client.queue.front()->size() - client.offset;
+                if (written < left) {
+                    client.offset += written;
+                    return true;  // socket buffer full
+                }
+                written -= left;
+                client.queue.pop_front();
+                client.offset = 0;
+            }
+        }
+        return true;
+    }
+
+    void SpectatorServer::run() {
+        std::vector<pollfd> fds;
+        std::vector<SpectatorFrame> incoming;
+        char scratch[256];
+
+        while (!stopping.load()) {
+            fds.clear();
+            fds.push_back(pollfd{listenFd, POLLIN, 0});
+            fds.push_back(pollfd{wakeFds[0], POLLIN, 0});
+            for (const Client &client : clients) {
+                fds.push_back(pollfd{client.fd, static_cast<short>(POLLIN | (client.queue.empty() ? 0 : POLLOUT)), 0});
+            }
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            // Clients first: fds[] matches clients[] only until new ones are accepted
+            bool dropped = false;
+            for (std::size_t i = 0; i < clients.size(); ++i) {
+                short events = fds[i + 2].revents;
+                Client &client = clients[i];
+                bool alive = !(events & (POLLERR | POLLNVAL));
+                if (alive && (events & (POLLIN | POLLHUP))) {
+                    ssize_t n = ::recv(client.fd, scratch, sizeof(scratch), MSG_DONTWAIT);
+                    alive = n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR));
+                }
+                if (alive && (events & POLLOUT)) {
+                    alive = writeClient(client);
+                }
+                if (!alive) {
+                    ::close(client.fd);
+                    client.fd = -1;
+                    dropped = true;
+                }
+            }
+            if (dropped) {
+                std::size_t kept = 0;
+                for (Client &client : clients) {
+                    if (client.fd >= 0) {
+                        clients[kept++] = std::move(client);
+                    }
+                }
+                clients.resize(kept);
+                clientCount.store(clients.size(), std::memory_order_relaxed);
+            }
+
+            if (fds[1].revents & POLLIN) {
+                while (::read(wakeFds[0], scratch, sizeof(scratch)) > 0) {
+                }
+                {
+                    std::lock_guard<std::mutex> lock(inboxMutex);
+                    incoming.swap(inbox);
+                }
+                queueFrames(incoming);
+            }
+            if (fds[0].revents & POLLIN) {
+                acceptClients();
+            }
+
+            // Sockets are usually writable: try now instead of waiting for POLLOUT
+            for (Client &client : clients) {
+                if (!client.queue.empty() && !writeClient(client)) {
+                    ::shutdown(client.fd, SHUT_RDWR);  // reported as POLLHUP and removed next round
+                    client.queue.clear();
+                    client.offset = 0;
+                }
+            }
+        }
+    }
+
+}
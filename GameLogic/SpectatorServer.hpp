@@ -0,0 +1,104 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef SPECTATOR_SERVER_HPP
+#define SPECTATOR_SERVER_HPP
+
+#include "Spectator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @class SpectatorServer
+     * @brief Streams spectator frames to every client of a Unix domain socket
+     *
+     * deliver() only queues the shared frame for a background thread, which
+     * accepts clients and writes each frame to all of them with non-blocking
+     * gathered writes; the frame bytes are never copied per client. A client
+     * that connects late, or falls more than maxQueuedFrames behind, is sent
+     * the last keyframe and the deltas after it instead of its backlog.
+     * Clients only read; anything they send is discarded.
+     */
+    class SpectatorServer : public SpectatorSink {
+    private:
+        struct Client {
+            int fd;
+            std::deque<SpectatorFrame> queue;  ///< Frames not fully written yet
+            std::size_t offset;                ///< Bytes of queue.front() already written
+        };
+
+        int listenFd;
+        int wakeFds[2];                        ///< Pipe that interrupts poll() for new frames
+        std::string socketPath;
+        std::size_t maxQueuedFrames;
+        std::atomic<bool> stopping;
+        std::thread worker;
+
+        std::mutex inboxMutex;
+        std::vector<SpectatorFrame> inbox;     ///< Frames delivered but not yet queued
+
+        // Owned by the worker thread
+        std::vector<Client> clients;
+        SpectatorFrame lastKeyframe;
+        std::vector<SpectatorFrame> sinceKeyframe;
+
+        std::atomic<std::size_t> clientCount;
+        std::atomic<std::uint64_t> bytesSent;
+        std::atomic<std::uint64_t> resyncs;
+
+        void run();
+        void acceptClients();
+        void queueFrames(std::vector<SpectatorFrame> &frames);
+        void catchUp(Client &client);
+        bool writeClient(Client &client);
+
+    public:
+        /**
+         * @brief Constructor
+         * @param maxQueuedFrames Backlog after which a client is resynchronised
+         *        (keep it above the broadcaster's keyframe interval)
+         */
+        explicit SpectatorServer(std::size_t maxQueuedFrames = 256);
+        SpectatorServer(const SpectatorServer &other) = delete;
+        SpectatorServer &operator=(const SpectatorServer &other) = delete;
+
+        /**
+         * @brief Destructor - disconnects every client and removes the socket file
+         */
+        ~SpectatorServer() override;
+
+        /**
+         * @brief Start accepting spectators (frames delivered before this are streamed too)
+         * @param path Filesystem path of the socket (replaced if it exists)
+         * @throws std::runtime_error if the socket cannot be bound
+         */
+        void listen(const std::string &path);
+
+        /**
+         * @brief Stop the background thread and disconnect every client
+         *
+         * Undelivered frames are dropped; after listen() again spectators
+         * sync from the next keyframe.
+         */
+        void stop();
+
+        /**
+         * @brief Queue a frame for every client (thread-safe, never blocks on clients)
+         */
+        void deliver(const SpectatorFrame &frame) override;
+
+        std::size_t spectatorCount() const { return clientCount.load(std::memory_order_relaxed); }
+        std::uint64_t getBytesSent() const { return bytesSent.load(std::memory_order_relaxed); }
+        std::uint64_t getResyncs() const { return resyncs.load(std::memory_order_relaxed); }
+    };
+
+}
+
+#endif // SPECTATOR_SERVER_HPP
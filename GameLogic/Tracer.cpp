@@ -0,0 +1,138 @@
+// Email: nitzanwa@gmail.com
+
+#include "Tracer.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace coup {
+
+    std::atomic<bool> Tracer::enabled(false);
+
+    namespace {
+
+        struct TraceEvent {
+            const char *name;
+            const char *category;
+            const char *detail;
+            std::uint64_t startNs;
+            std::uint64_t durationNs;
+        };
+
+        /**
+         * Spans of one thread. Only the owning thread writes; count is
+         * published with release so dumps from other threads see complete
+         * events.
+         */
+        struct ThreadBuffer {
+            std::unique_ptr<TraceEvent[]> events;
+            std::atomic<std::size_t> count;
+            std::atomic<std::size_t> dropped;
+            int threadId;
+
+            explicit ThreadBuffer(int threadId)
+                : events(new TraceEvent[Tracer::EVENTS_PER_THREAD]), count(0), dropped(0), threadId(threadId) {}
+        };
+
+        // Buffers outlive their threads so spans survive until dumped
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> registry;
+        thread_local ThreadBuffer *localBuffer = nullptr;
+
+        ThreadBuffer &bufferForThisThread() {
+            if (!localBuffer) {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                registry.emplace_back(new ThreadBuffer(static_cast<int>(registry.size()) + 1));
+                localBuffer = registry.back().get();
+            }
+            return *localBuffer;
+        }
+
+    }
+
+    void Tracer::record(const char *name, const char *category, std::uint64_t startNs,
+                        std::uint64_t endNs, const char *detail) {
+        ThreadBuffer &buffer = bufferForThisThread();
+        std::size_t index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= EVENTS_PER_THREAD) {
+            buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        buffer.events[index] = TraceEvent{name, category, detail, startNs, endNs - startNs};
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    void Tracer::writeChromeTrace(std::ostream &out) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        out << std::fixed << std::setprecision(3);
+        bool first = true;
+        for (const auto &buffer : registry) {
+            std::size_t count = buffer->count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; ++i) {
+                const TraceEvent &e = buffer->events[i];
+                out << (first ? "\n" : ",\n")
+                    << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0;
+                if (e.detail) {
+                    out << ",\"args\":{\"outcome\":\"" << e.detail << "\"}";
+                }
+                out << "}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    void Tracer::writeChromeTrace(const std::string &path) {
+        std::ofstream out(path);
+        if (!out) {
+            throw std::runtime_error("Cannot write trace file " + path);
+        }
+        writeChromeTrace(out);
+    }
+
+    std::string Tracer::environmentPath() {
+        const char *path = std::getenv("COUP_TRACE");
+        return path ? path : "";
+    }
+
+    std::size_t Tracer::eventCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::size_t total = 0;
+        for (const auto &buffer : registry) {
+            total += buffer->count.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    std::size_t Tracer::droppedCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::size_t total = 0;
+        for (const auto &buffer : registry) {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void Tracer::clear() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto &buffer : registry) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void TraceSpan::finish() {
+        Tracer::record(name, category, startNs, metricsClockNs());
+    }
+
+}
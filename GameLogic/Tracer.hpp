@@ -0,0 +1,126 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "ActionMetrics.hpp"
+
+namespace coup {
+
+    /**
+     * @class Tracer
+     * @brief Timeline recorder that exports Chrome trace / Perfetto JSON
+     *
+     * Spans are appended to a fixed-size buffer owned by the recording
+     * thread, so recording takes no locks. While tracing is off, opening a
+     * span costs one test of a global flag. Span names and categories must
+     * be string literals (they are stored as pointers).
+     *
+     * Usage: Tracer::setEnabled(true); ... Tracer::writeChromeTrace("trace.json");
+     * then load the file in chrome://tracing or ui.perfetto.dev.
+     */
+    class Tracer {
+    private:
+        static std::atomic<bool> enabled;  ///< Whether spans are recorded (toggled from any thread)
+
+    public:
+        static constexpr std::size_t EVENTS_PER_THREAD = 1 << 18;  ///< Buffer size; later spans are dropped
+
+        /**
+         * @brief Turn span recording on or off
+         * @param on true to record
+         */
+        static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+        /**
+         * @brief Check whether spans are recorded
+         * @return true if tracing is on
+         */
+        static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Record a finished span on the calling thread
+         * @param name Span name (string literal)
+         * @param category Span category (string literal)
+         * @param startNs Start time from metricsClockNs()
+         * @param endNs End time from metricsClockNs()
+         * @param detail Optional outcome shown in the span's args (string literal or nullptr)
+         */
+        static void record(const char *name, const char *category, std::uint64_t startNs,
+                           std::uint64_t endNs, const char *detail = nullptr);
+
+        /**
+         * @brief Write all recorded spans as Chrome trace JSON
+         * @param out Destination stream
+         *
+         * Safe while other threads keep recording; spans they finish during
+         * the dump may be left out.
+         */
+        static void writeChromeTrace(std::ostream &out);
+
+        /**
+         * @brief Write all recorded spans to a file
+         * @param path Output path
+         * @throws std::runtime_error if the file cannot be written
+         */
+        static void writeChromeTrace(const std::string &path);
+
+        /**
+         * @brief Trace file requested through the COUP_TRACE environment variable
+         * @return The path, or an empty string if tracing was not requested
+         */
+        static std::string environmentPath();
+
+        /**
+         * @brief Number of spans currently held across all threads
+         */
+        static std::size_t eventCount();
+
+        /**
+         * @brief Number of spans lost because a thread's buffer was full
+         */
+        static std::size_t droppedCount();
+
+        /**
+         * @brief Discard recorded spans (call while no thread is recording)
+         */
+        static void clear();
+    };
+
+    /**
+     * @class TraceSpan
+     * @brief RAII span from construction to destruction
+     *
+     * Do not use on paths that routinely throw: the destructor adds an
+     * unwinding landing pad. Player actions are traced through ActionTimer
+     * instead.
+     */
+    class TraceSpan {
+    private:
+        const char *name;
+        const char *category;
+        std::uint64_t startNs;  ///< 0 when tracing was off at construction
+
+    public:
+        TraceSpan(const char *name, const char *category)
+            : name(name), category(category), startNs(Tracer::isEnabled() ? metricsClockNs() : 0) {}
+        ~TraceSpan() {
+            if (startNs) {
+                finish();
+            }
+        }
+        TraceSpan(const TraceSpan &other) = delete;
+        TraceSpan &operator=(const TraceSpan &other) = delete;
+
+    private:
+        void finish();
+    };
+
+}
+
+#endif // TRACER_HPP
@@ -0,0 +1,522 @@
+// Email: nitzanwa@gmail.com
+
+#include "WriteAheadLog.hpp"
+#include "../Players/Player.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace coup {
+
+    namespace {
+        constexpr std::size_t HEADER_SIZE = 8;              // u32 body length + u32 CRC-32
+        constexpr std::uint32_t MAX_BODY_SIZE = 1u << 24;   // larger lengths can only be garbage
+        constexpr std::uint64_t PAGE_SIZE = 4096;
+
+        const std::array<std::uint32_t, 256> &crcTable() {
+            static const std::array<std::uint32_t, 256> table = [] {
+                std::array<std::uint32_t, 256> t{};
+                for (std::uint32_t i = 0; i < 256; ++i) {
+                    std::uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) {
+                        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    }
+                    t[i] = c;
+                }
+                return t;
+            }();
+            return table;
+        }
+
+        // Running CRC-32 (IEEE); start and finish with ~0
+        std::uint32_t crcUpdate(std::uint32_t crc, const std::uint8_t *data, std::size_t size) {
+            const std::array<std::uint32_t, 256> &table = crcTable();
+            for (std::size_t i = 0; i < size; ++i) {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+            return crc;
+        }
+
+        std::size_t putVarint(std::uint8_t *out, std::uint64_t value) {
+            std::size_t n = 0;
+            while (value >= 0x80) {
+                out[n++] = static_cast<std::uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+            out[n++] = static_cast<std::uint8_t>(value);
+            return n;
+        }
+
+        void putU32(std::uint8_t *out, std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+            }
+        }
+
+        std::uint32_t getU32(const std::uint8_t *in) {
+            std::uint32_t value = 0;
+            for (int i = 0; i < 4; ++i) {
+                value |= static_cast<std::uint32_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        /**
+         * Bounds-checked reader over one record body
+         */
+        struct BodyReader {
+            const std::uint8_t *p;
+            const std::uint8_t *end;
+            bool ok = true;
+
+            std::uint8_t byte() {
+                if (p == end) {
+                    ok = false;
+                    return 0;
+                }
+                return *p++;
+            }
+
+            std::uint64_t varint() {
+                std::uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    std::uint8_t b = byte();
+                    value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        return value;
+                    }
+                }
+                ok = false;
+                return 0;
+            }
+
+            std::size_t left() const { return static_cast<std::size_t>(end - p); }
+        };
+
+        /**
+         * Everything the log holds about one game
+         */
+        struct LoggedGame {
+            std::uint64_t seed = 0;
+            std::vector<std::string> names;
+            std::vector<Role> roles;
+            std::vector<JournalEntry> entries;
+            bool ended = false;
+        };
+
+        bool parseBegin(BodyReader &in, LoggedGame &game) {
+            for (int i = 0; i < 8; ++i) {
+                game.seed |= static_cast<std::uint64_t>(in.byte()) << (8 * i);
+            }
+            std::size_t count = in.byte();
+            for (std::size_t i = 0; i < count && in.ok; ++i) {
+                std::uint8_t role = in.byte();
+                std::size_t length = in.byte();
+                if (role >= ROLE_COUNT || length > in.left()) {
+                    return false;
+                }
+                game.roles.push_back(static_cast<Role>(role));
+                game.names.emplace_back(reinterpret_cast<const char *>(in.p), length);
+                in.p += length;
+            }
+            return in.ok && in.left() == 0;
+        }
+
+        bool parseEntries(BodyReader &in, LoggedGame &game) {
+            if (in.left() % 3 != 0) {
+                return false;
+            }
+            while (in.left() > 0) {
+                std::uint8_t op = in.byte();
+                std::uint8_t actor = in.byte();
+                std::uint8_t target = in.byte();
+                if (op >= JOURNAL_OP_COUNT) {
+                    return false;
+                }
+                game.entries.push_back(JournalEntry{static_cast<JournalOp>(op), actor, target});
+            }
+            return true;
+        }
+
+        std::vector<std::uint8_t> readFile(const std::string &path) {
+            std::vector<std::uint8_t> data;
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                if (errno == ENOENT) {
+                    return data;
+                }
+                throw std::runtime_error("Cannot open write-ahead log " + path + ": " + std::strerror(errno));
+            }
+            struct stat info{};
+            if (::fstat(fd, &info) == 0) {
+                data.reserve(static_cast<std::size_t>(info.st_size));
+            }
+            std::uint8_t chunk[1 << 16];
+            while (true) {
+                ssize_t n = ::read(fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    std::string reason = std::strerror(errno);
+                    ::close(fd);
+                    throw std::runtime_error("Cannot read write-ahead log " + path + ": " + reason);
+                }
+                if (n == 0) {
+                    break;
+                }
+                data.insert(data.end(), chunk, chunk + n);
+            }
+            ::close(fd);
+            return data;
+        }
+
+        // A new file's directory entry is only durable once the directory itself is synced
+        void syncParentDirectory(const std::string &path) {
+            std::string::size_type slash = path.rfind('/');
+            std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+            int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0 || ::fsync(fd) < 0) {
+                std::string reason = std::strerror(errno);
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                throw std::runtime_error("Cannot sync directory of write-ahead log " + path + ": " + reason);
+            }
+            ::close(fd);
+        }
+    }
+
+    WriteAheadLog::WriteAheadLog(const std::string &path, std::uint64_t firstGameId, int commitDelayMicros,
+                                 std::size_t maxBatchBytes)
+        : fd(-1), path(path), commitDelayMicros(commitDelayMicros), maxBatchBytes(maxBatchBytes), appendedBytes(0),
+          nextGameId(firstGameId == 0 ? 1 : firstGameId), flushRequested(false), stopping(false), failed(false) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC, 0644);
+        bool created = fd >= 0;
+        if (!created && errno == EEXIST) {
+            fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open write-ahead log " + path + ": " + std::strerror(errno));
+        }
+        if (created) {
+            try {
+                syncParentDirectory(path);
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+        }
+        struct stat info{};
+        if (::fstat(fd, &info) == 0) {
+            appendedBytes = static_cast<std::uint64_t>(info.st_size);
+        }
+        stats.durableBytes = appendedBytes;
+        batch.reserve(maxBatchBytes);
+        committer = std::thread(&WriteAheadLog::run, this);
+    }
+
+    WriteAheadLog::~WriteAheadLog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        batchReady.notify_one();
+        committer.join();
+        ::close(fd);
+    }
+
+    std::uint64_t WriteAheadLog::newGameId() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nextGameId++;
+    }
+
+    std::uint64_t WriteAheadLog::append(std::uint64_t gameId, WalRecordType type, const std::uint8_t *payload,
+                                        std::size_t size, std::size_t entries) {
+        std::uint8_t prefix[11];
+        std::size_t prefixSize = putVarint(prefix, gameId);
+        prefix[prefixSize++] = static_cast<std::uint8_t>(type);
+        std::uint32_t crc = ~crcUpdate(crcUpdate(~0u, prefix, prefixSize), payload, size);
+        std::uint32_t bodySize = static_cast<std::uint32_t>(prefixSize + size);
+
+        std::uint64_t lsn;
+        bool wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failed) {
+                throw std::runtime_error("Write-ahead log " + path + " failed: " + failure);
+            }
+            wake = batch.empty();
+            std::size_t at = batch.size();
+            batch.resize(at + HEADER_SIZE + bodySize);
+            putU32(&batch[at], bodySize);
+            putU32(&batch[at + 4], crc);
+            std::memcpy(&batch[at + HEADER_SIZE], prefix, prefixSize);
+            if (size > 0) {
+                std::memcpy(&batch[at + HEADER_SIZE + prefixSize], payload, size);
+            }
+            appendedBytes += HEADER_SIZE + bodySize;
+            lsn = appendedBytes;
+            ++stats.records;
+            stats.entries += entries;
+            stats.logicalBytes += size;
+            wake = wake || batch.size() >= maxBatchBytes;
+        }
+        if (wake) {
+            batchReady.notify_one();
+        }
+        return lsn;
+    }
+
+    void WriteAheadLog::waitDurable(std::uint64_t lsn) {
+        std::unique_lock<std::mutex> lock(mutex);
+        committed.wait(lock, [&] { return failed || stats.durableBytes >= lsn; });
+        if (stats.durableBytes < lsn) {
+            throw std::runtime_error("Write-ahead log " + path + " failed: " + failure);
+        }
+    }
+
+    void WriteAheadLog::sync() {
+        std::uint64_t lsn;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lsn = appendedBytes;
+            flushRequested = true;
+        }
+        batchReady.notify_one();
+        waitDurable(lsn);
+    }
+
+    WalStats WriteAheadLog::getStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+    void WriteAheadLog::run() {
+        std::vector<std::uint8_t> writing;
+        writing.reserve(maxBatchBytes);
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            batchReady.wait(lock, [&] { return stopping || !batch.empty(); });
+            if (batch.empty()) {
+                break;  // stopping with nothing left to commit
+            }
+            // Give other games a moment to join this commit
+            if (commitDelayMicros > 0 && !flushRequested && !stopping && batch.size() < maxBatchBytes) {
+                batchReady.wait_for(lock, std::chrono::microseconds(commitDelayMicros),
+                                    [&] { return stopping || flushRequested || batch.size() >= maxBatchBytes; });
+            }
+            flushRequested = false;
+            writing.swap(batch);
+            std::uint64_t end = appendedBytes;
+            std::uint64_t start = end - writing.size();
+            lock.unlock();
+
+            std::string error;
+            std::size_t done = 0;
+            while (done < writing.size() && error.empty()) {
+                ssize_t n = ::write(fd, writing.data() + done, writing.size() - done);
+                if (n < 0 && errno != EINTR) {
+                    error = std::string("write: ") + std::strerror(errno);
+                } else if (n > 0) {
+                    done += static_cast<std::size_t>(n);
+                }
+            }
+            if (error.empty() && ::fdatasync(fd) < 0) {
+                error = std::string("fdatasync: ") + std::strerror(errno);
+            }
+            writing.clear();
+
+            lock.lock();
+            if (!error.empty()) {
+                failed = true;
+                failure = error;
+                committed.notify_all();
+                break;
+            }
+            ++stats.commits;
+            stats.logBytes += end - start;
+            stats.pageBytes += ((end + PAGE_SIZE - 1) / PAGE_SIZE - start / PAGE_SIZE) * PAGE_SIZE;
+            stats.durableBytes = end;
+            committed.notify_all();
+        }
+    }
+
+    WalRecovery WriteAheadLog::recover(const std::string &path, bool truncateTornTail) {
+        WalRecovery result;
+        std::vector<std::uint8_t> data = readFile(path);
+
+        // Read records up to the first one the crash cut short
+        std::map<std::uint64_t, LoggedGame> logged;
+        std::vector<std::uint64_t> order;
+        std::uint64_t maxGameId = 0;
+        std::size_t offset = 0;
+        while (data.size() - offset >= HEADER_SIZE) {
+            std::uint32_t bodySize = getU32(&data[offset]);
+            std::uint32_t crc = getU32(&data[offset + 4]);
+            if (bodySize == 0 || bodySize > MAX_BODY_SIZE || bodySize > data.size() - offset - HEADER_SIZE) {
+                break;
+            }
+            const std::uint8_t *body = &data[offset + HEADER_SIZE];
+            if (~crcUpdate(~0u, body, bodySize) != crc) {
+                break;
+            }
+            BodyReader in{body, body + bodySize};
+            std::uint64_t gameId = in.varint();
+            std::uint8_t type = in.byte();
+            if (!in.ok) {
+                break;
+            }
+
+            bool known = logged.count(gameId) != 0;
+            bool valid = true;
+            switch (static_cast<WalRecordType>(type)) {
+                case WalRecordType::Begin:
+                    if (!known) {
+                        order.push_back(gameId);
+                        valid = parseBegin(in, logged[gameId]);
+                    }
+                    break;
+                case WalRecordType::Entries:
+                    valid = !known || parseEntries(in, logged[gameId]);
+                    break;
+                case WalRecordType::End:
+                    if (known) {
+                        logged[gameId].ended = true;
+                    }
+                    break;
+                default:
+                    valid = false;
+                    break;
+            }
+            if (!valid) {
+                break;
+            }
+            maxGameId = std::max(maxGameId, gameId);
+            offset += HEADER_SIZE + bodySize;
+            ++result.records;
+        }
+        result.validBytes = offset;
+        result.tornBytes = data.size() - offset;
+        result.nextGameId = maxGameId + 1;
+
+        if (truncateTornTail && result.tornBytes > 0 && ::truncate(path.c_str(), static_cast<off_t>(offset)) < 0) {
+            throw std::runtime_error("Cannot truncate write-ahead log " + path + ": " + std::strerror(errno));
+        }
+
+        // Replay every game that had not ended
+        for (std::uint64_t gameId : order) {
+            LoggedGame &source = logged[gameId];
+            if (source.ended) {
+                ++result.endedGames;
+                continue;
+            }
+            RecoveredGame recovered{gameId, std::make_unique<Game>(source.seed), {}, 0};
+            ReplayDecisions decisions;
+            bool ok = true;
+            try {
+                recovered.game->setConsoleMode(false);
+                recovered.table = recovered.game->setup(source.names, source.roles);
+                for (Player *player : recovered.table) {
+                    player->setDecisionPolicy(&decisions);
+                }
+                for (const JournalEntry &entry : source.entries) {
+                    if (entry.op == JournalOp::Decision) {
+                        decisions.push(entry);
+                    } else {
+                        performJournalEntry(*recovered.game, recovered.table, entry);
+                    }
+                    ++recovered.replayed;
+                }
+                ok = decisions.pending() == 0;
+            } catch (const std::exception &) {
+                ok = false;
+            }
+            for (Player *player : recovered.table) {
+                player->setDecisionPolicy(nullptr);
+            }
+            if (ok) {
+                result.games.push_back(std::move(recovered));
+            } else {
+                ++result.failedGames;
+            }
+        }
+        return result;
+    }
+
+    WalGameWriter::WalGameWriter(WriteAheadLog &log) : log(log), gameId(0), lastLsn(0), pendingEntries(0) {}
+
+    void WalGameWriter::resume(std::uint64_t recoveredGameId) {
+        gameId = recoveredGameId;
+        pending.clear();
+        pendingEntries = 0;
+    }
+
+    void WalGameWriter::gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                                    const std::vector<Role> &roles) {
+        if (names.size() != roles.size() || names.size() > Game::MAX_PLAYERS) {
+            throw std::runtime_error("Cannot log a table of " + std::to_string(names.size()) + " names and " +
+                                     std::to_string(roles.size()) + " roles");
+        }
+        gameId = log.newGameId();
+        pending.clear();
+        pendingEntries = 0;
+
+        std::vector<std::uint8_t> payload;
+        for (int i = 0; i < 8; ++i) {
+            payload.push_back(static_cast<std::uint8_t>(seed >> (8 * i)));
+        }
+        payload.push_back(static_cast<std::uint8_t>(names.size()));
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            if (names[i].size() > 255) {
+                throw std::runtime_error("Cannot log a player name longer than 255 bytes");
+            }
+            payload.push_back(static_cast<std::uint8_t>(roles[i]));
+            payload.push_back(static_cast<std::uint8_t>(names[i].size()));
+            payload.insert(payload.end(), names[i].begin(), names[i].end());
+        }
+        lastLsn = log.append(gameId, WalRecordType::Begin, payload.data(), payload.size());
+    }
+
+    void WalGameWriter::record(const JournalEntry &entry) {
+        if (gameId == 0) {
+            throw std::runtime_error("Journal entry logged before the game started");
+        }
+        pending.push_back(static_cast<std::uint8_t>(entry.op));
+        pending.push_back(entry.actor);
+        pending.push_back(entry.target);
+        ++pendingEntries;
+        if (entry.op == JournalOp::EndTurn) {
+            flushEntries();
+        }
+    }
+
+    void WalGameWriter::flushEntries() {
+        if (pendingEntries == 0) {
+            return;
+        }
+        lastLsn = log.append(gameId, WalRecordType::Entries, pending.data(), pending.size(), pendingEntries);
+        pending.clear();
+        pendingEntries = 0;
+    }
+
+    void WalGameWriter::gameEnded(int winnerSeat) {
+        if (gameId == 0) {
+            return;
+        }
+        flushEntries();
+        std::uint8_t seat = winnerSeat < 0 ? JOURNAL_NO_SEAT : static_cast<std::uint8_t>(winnerSeat);
+        lastLsn = log.append(gameId, WalRecordType::End, &seat, 1);
+        gameId = 0;
+    }
+
+}
@@ -0,0 +1,216 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include "ActionJournal.hpp"
+#include "Game.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coup {
+
+    /**
+     * @enum WalRecordType
+     * @brief Kinds of write-ahead log records
+     */
+    enum class WalRecordType : std::uint8_t {
+        Begin = 1,    ///< seed, names and roles of a new game
+        Entries = 2,  ///< journal entries of one turn (or the tail of a game)
+        End = 3       ///< the game finished or was abandoned; nothing to recover
+    };
+
+    /**
+     * @struct WalStats
+     * @brief Write volume of a log, for write-amplification reports
+     */
+    struct WalStats {
+        std::uint64_t records = 0;       ///< Records appended
+        std::uint64_t entries = 0;       ///< Journal entries inside them
+        std::uint64_t logicalBytes = 0;  ///< Record bodies (what the games asked to log)
+        std::uint64_t logBytes = 0;      ///< Bytes written to the file, framing included
+        std::uint64_t pageBytes = 0;     ///< 4 KiB pages each commit dirtied, in bytes
+        std::uint64_t commits = 0;       ///< Group commits (one write + one fdatasync each)
+        std::uint64_t durableBytes = 0;  ///< Log offset known to be on disk
+    };
+
+    /**
+     * @struct RecoveredGame
+     * @brief A game rebuilt from the log, ready to be played on
+     */
+    struct RecoveredGame {
+        std::uint64_t gameId;
+        std::unique_ptr<Game> game;
+        Game::PlayerList table;   ///< Players in seat order, as setup() returned them
+        std::size_t replayed;     ///< Journal entries replayed (decisions included)
+    };
+
+    /**
+     * @struct WalRecovery
+     * @brief Outcome of WriteAheadLog::recover
+     */
+    struct WalRecovery {
+        std::vector<RecoveredGame> games;  ///< In-flight games, in the order they began
+        std::uint64_t nextGameId = 1;      ///< First id a reopened log should assign
+        std::size_t records = 0;           ///< Valid records read
+        std::size_t endedGames = 0;        ///< Games skipped because they ended
+        std::size_t failedGames = 0;       ///< Games whose replay was rejected by the engine
+        std::uint64_t validBytes = 0;      ///< Length of the intact prefix of the log
+        std::uint64_t tornBytes = 0;       ///< Bytes after it (a write cut short by the crash)
+    };
+
+    /**
+     * @class WriteAheadLog
+     * @brief Append-only log of game journals with group commit
+     *
+     * Any number of threads append framed records to an in-memory batch; a
+     * commit thread writes each batch with one write() and one fdatasync(),
+     * so games share the cost of an fsync instead of paying one per action.
+     * append() returns the record's end offset (its LSN) without waiting;
+     * callers that must not lose the record wait with waitDurable().
+     *
+     * Each record is: u32 body length, u32 CRC-32 of the body, then the body
+     * (varint game id, u8 WalRecordType, payload). A crash can only tear the
+     * last batch, which recover() detects by its length or checksum.
+     */
+    class WriteAheadLog {
+    private:
+        int fd;
+        std::string path;
+        int commitDelayMicros;
+        std::size_t maxBatchBytes;
+
+        std::mutex mutex;
+        std::condition_variable batchReady;
+        std::condition_variable committed;
+        std::vector<std::uint8_t> batch;    ///< Records appended since the last commit
+        std::uint64_t appendedBytes;        ///< LSN of the newest appended record
+        std::uint64_t nextGameId;
+        bool flushRequested;
+        bool stopping;
+        bool failed;
+        std::string failure;
+        WalStats stats;
+        std::thread committer;
+
+        void run();
+
+    public:
+        static constexpr int DEFAULT_COMMIT_DELAY_MICROS = 200;
+        static constexpr std::size_t DEFAULT_MAX_BATCH_BYTES = 1 << 20;
+
+        /**
+         * @brief Open (or create) a log for appending
+         * @param path Log file; existing records are kept
+         * @param firstGameId Id of the first game started (WalRecovery::nextGameId after a crash)
+         * @param commitDelayMicros How long a commit waits for more records to join it
+         * @param maxBatchBytes Batch size that is committed without waiting
+         * @throws std::runtime_error if the file cannot be opened, or a new file cannot be made durable
+         */
+        explicit WriteAheadLog(const std::string &path, std::uint64_t firstGameId = 1,
+                               int commitDelayMicros = DEFAULT_COMMIT_DELAY_MICROS,
+                               std::size_t maxBatchBytes = DEFAULT_MAX_BATCH_BYTES);
+        WriteAheadLog(const WriteAheadLog &other) = delete;
+        WriteAheadLog &operator=(const WriteAheadLog &other) = delete;
+
+        /**
+         * @brief Destructor - commits what is pending and closes the file
+         */
+        ~WriteAheadLog();
+
+        /**
+         * @brief Reserve an id for a new game (thread-safe)
+         */
+        std::uint64_t newGameId();
+
+        /**
+         * @brief Append one record (thread-safe, does not wait for the disk)
+         * @param gameId Game the record belongs to
+         * @param type Record type
+         * @param payload Record payload
+         * @param size Payload size in bytes
+         * @param entries Journal entries in the payload (for statistics)
+         * @return LSN to pass to waitDurable()
+         * @throws std::runtime_error if an earlier commit failed
+         */
+        std::uint64_t append(std::uint64_t gameId, WalRecordType type, const std::uint8_t *payload,
+                             std::size_t size, std::size_t entries = 0);
+
+        /**
+         * @brief Block until every record up to lsn is on disk
+         * @throws std::runtime_error if the commit failed
+         */
+        void waitDurable(std::uint64_t lsn);
+
+        /**
+         * @brief Commit everything appended so far and wait for it
+         */
+        void sync();
+
+        WalStats getStats();
+        const std::string &getPath() const { return path; }
+
+        /**
+         * @brief Rebuild every game that had not ended when the log was last written
+         *
+         * Each game is set up again with its logged seed, names and roles and
+         * its journal is replayed through the engine; ReplayDecisions answers
+         * the bribe/block questions and is detached afterwards.
+         *
+         * @param path Log file
+         * @param truncateTornTail Cut a torn tail off the file so appends continue after the intact prefix
+         * @return Recovered games and log statistics (an absent file recovers nothing)
+         */
+        static WalRecovery recover(const std::string &path, bool truncateTornTail = true);
+    };
+
+    /**
+     * @class WalGameWriter
+     * @brief ActionJournal that logs one game to a WriteAheadLog
+     *
+     * Entries are buffered and appended as one record per turn (at EndTurn),
+     * so the log grows by one record per turn rather than per action. Use
+     * one writer per game; writers of different games may run on different
+     * threads.
+     */
+    class WalGameWriter : public ActionJournal {
+    private:
+        WriteAheadLog &log;
+        std::uint64_t gameId;
+        std::uint64_t lastLsn;
+        std::vector<std::uint8_t> pending;  ///< Entry bytes of the current turn
+        std::size_t pendingEntries;
+
+        void flushEntries();
+
+    public:
+        explicit WalGameWriter(WriteAheadLog &log);
+
+        /**
+         * @brief Continue logging a recovered game instead of starting a new one
+         */
+        void resume(std::uint64_t recoveredGameId);
+
+        void gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                         const std::vector<Role> &roles) override;
+        void record(const JournalEntry &entry) override;
+        void gameEnded(int winnerSeat) override;
+
+        std::uint64_t getGameId() const { return gameId; }
+
+        /**
+         * @brief LSN of the last record appended for this game
+         */
+        std::uint64_t getLastLsn() const { return lastLsn; }
+    };
+
+}
+
+#endif // WRITE_AHEAD_LOG_HPP
@@ -0,0 +1,79 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef DECISION_POLICY_HPP
+#define DECISION_POLICY_HPP
+
+#include "../GameLogic/ActionType.hpp"
+
+namespace coup {
+
+    class Player;  // forward declaration
+
+    /**
+     * @class DecisionPolicy
+     * @brief Interface for automated bribe and block decisions
+     *
+     * A player holds a non-owning pointer to a policy; the policy object must
+     * outlive every player it is attached to. One policy instance may be
+     * shared by any number of players.
+     */
+    class DecisionPolicy {
+    public:
+        /**
+         * @brief Virtual destructor
+         */
+        virtual ~DecisionPolicy() = default;
+
+        /**
+         * @brief Decide whether a player uses a bribe
+         * @param player Player being asked
+         * @return true if player wants to bribe
+         */
+        virtual bool shouldBribe(Player &player) = 0;
+
+        /**
+         * @brief Decide whether a player blocks an action
+         * @param blocker Player being asked
+         * @param action Action to potentially block
+         * @param actor Player performing action
+         * @param target Target of action (may be nullptr)
+         * @return true if blocker wants to block
+         */
+        virtual bool shouldBlock(Player &blocker, ActionType action, Player *actor, Player *target) = 0;
+    };
+
+    /**
+     * @class StaticPolicy
+     * @brief Adapts a plain decision type to the DecisionPolicy interface
+     *
+     * Impl must provide shouldBribe(Player&) and
+     * shouldBlock(Player&, ActionType, Player*, Player*). Its calls are
+     * resolved at compile time, so simulator bots get inlined decision logic
+     * behind a single virtual dispatch.
+     *
+     * @tparam Impl Decision logic type
+     */
+    template <typename Impl>
+    class StaticPolicy final : public DecisionPolicy {
+    public:
+        /**
+         * @brief Constructor
+         * @param impl Decision logic instance
+         */
+        explicit StaticPolicy(Impl impl = Impl()) : impl(impl) {}
+
+        bool shouldBribe(Player &player) override {
+            return impl.shouldBribe(player);
+        }
+
+        bool shouldBlock(Player &blocker, ActionType action, Player *actor, Player *target) override {
+            return impl.shouldBlock(blocker, action, actor, target);
+        }
+
+    private:
+        Impl impl;
+    };
+
+}
+
+#endif // DECISION_POLICY_HPP
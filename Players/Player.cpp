@@ -4,16 +4,18 @@
 #include "../Players/Roles/General.hpp"
 #include "../GameLogic/BankManager.hpp"
 #include "../GameLogic/Logger.hpp"
+#include "../GameLogic/PlayerFactory.hpp"
+#include "../GameLogic/Snapshot.hpp"
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
 namespace coup {
 
     Player::Player(Game &game, const std::string &name)
-        : game(game), name(name), coins(0), sanctioned(false), arrestStatus(ArrestStatus::Available),
-          lastAction(ActionType::None), lastActionTarget(nullptr),
+        : game(game), name(name), lastActionTarget(nullptr), decisionPolicy(nullptr), coins(0),
+          arrestStatus(ArrestStatus::Available), lastAction(ActionType::None), sanctioned(false),
           actionBlocked(false), arrestBlocked(false), bribeUsedThisTurn(false) {
-        Logger::log("Initializing player: " + name);
         game.addPlayer(this);
     }
 
@@ -31,11 +33,16 @@ namespace coup {
         }
     }
 
+    std::runtime_error Player::rejection(RejectReason reason, const std::string &message) const {
+        game.getMetrics().recordRejection(reason);
+        return std::runtime_error(message);
+    }
+
     void Player::requireTurn() const {
         Logger::log("Checking turn for " + name);
         if (game.turn() != name) {
             Logger::log("Turn check failed for " + name);
-            throw std::runtime_error("Not " + name + "'s turn");
+            throw rejection(RejectReason::NotYourTurn, "Not " + name + "'s turn");
         }
         Logger::log("Turn check passed for " + name);
     }
@@ -44,7 +51,7 @@ namespace coup {
         Logger::log("Checking if " + target.getName() + " is alive");
         if (!game.isAlive(target)) {
             Logger::log("Player " + target.getName() + " is not alive");
-            throw std::runtime_error(target.getName() + " is not alive");
+            throw rejection(RejectReason::InvalidTarget, target.getName() + " is not alive");
         }
     }
 
@@ -52,7 +59,7 @@ namespace coup {
         Logger::log("Checking if " + name + " is trying to " + action + " themselves");
         if (&target_player == this) {
             Logger::log("Self-action detected: cannot " + action + " yourself");
-            throw std::runtime_error("Cannot " + action + " yourself");
+            throw rejection(RejectReason::InvalidTarget, "Cannot " + action + " yourself");
         }
     }
 
@@ -60,7 +67,7 @@ namespace coup {
         Logger::log("Checking if " + target.getName() + " can be sanctioned");
         if (target.isSanctioned()) {
             Logger::log("Player " + target.getName() + " is already sanctioned");
-            throw std::runtime_error(target.getName() + " is already sanctioned");
+            throw rejection(RejectReason::InvalidTarget, target.getName() + " is already sanctioned");
         }
     }
 
@@ -68,19 +75,19 @@ namespace coup {
         Logger::log("Checking if " + target.getName() + " can be arrested");
         if (target.getArrestStatus() == ArrestStatus::ArrestedNow) {
             Logger::log("Player " + target.getName() + " was just arrested and cannot be arrested again");
-            throw std::runtime_error(target.getName() + " was just arrested and cannot be arrested again this turn");
+            throw rejection(RejectReason::ArrestUnavailable, target.getName() + " was just arrested and cannot be arrested again this turn");
         }
         if (target.getArrestStatus() == ArrestStatus::Cooldown) {
             Logger::log("Player " + target.getName() + " is in arrest cooldown");
-            throw std::runtime_error(target.getName() + " is in arrest cooldown and cannot be arrested");
+            throw rejection(RejectReason::ArrestUnavailable, target.getName() + " is in arrest cooldown and cannot be arrested");
         }
         if (this->isArrestBlocked()) {
             Logger::log("Player " + name + " is blocked from arrest by Spy");
-            throw std::runtime_error(name + " is blocked from arrest by Spy");
+            throw rejection(RejectReason::ArrestUnavailable, name + " is blocked from arrest by Spy");
         }
         if (target.getCoins() == 0) {
             Logger::log("Player " + target.getName() + " has no coins to be arrested");
-            throw std::runtime_error(target.getName() + " has no coins to arrest");
+            throw rejection(RejectReason::InvalidTarget, target.getName() + " has no coins to arrest");
         }
     }
 
@@ -101,76 +108,82 @@ namespace coup {
 
         if (arrestStatus == ArrestStatus::ArrestedNow) {
             Logger::log(name + "'s arrest status changing to Cooldown");
-            arrestStatus = ArrestStatus::Cooldown;
+            setArrestStatus(ArrestStatus::Cooldown);
         } else if (arrestStatus == ArrestStatus::Cooldown) {
             Logger::log(name + "'s arrest status changing to Available");
-            arrestStatus = ArrestStatus::Available;
+            setArrestStatus(ArrestStatus::Available);
         }
 
         // Clear turn flags
         bribeUsedThisTurn = false;
         actionBlocked = false;
-        arrestBlocked = false;
-        sanctioned = false; // Clear sanctions at end of turn
+        setArrestBlocked(false);
+        setSanctioned(false); // Clear sanctions at end of turn
 
         game.resolvePendingAction();
         game.nextTurn();
     }
 
     void Player::gather() {
+        ActionTimer timer(game.getMetrics(), ActionType::Gather);
         Logger::log(name + " is attempting to gather coins");
         requireTurn();
         
         if (sanctioned) {
             Logger::log(name + " is sanctioned and cannot use economic actions");
-            throw std::runtime_error(name + " is sanctioned and cannot gather");
+            throw rejection(RejectReason::Sanctioned, name + " is sanctioned and cannot gather");
         }
         
         BankManager::transferFromBank(*this, game, 1);
         Logger::log(name + " gathered 1 coin from bank");
         lastAction = ActionType::Gather;
         game.setPendingAction(this, ActionType::Gather);
+        timer.succeed();
     }
 
     void Player::tax() {
+        ActionTimer timer(game.getMetrics(), ActionType::Tax);
         Logger::log(name + " is collecting tax");
         requireTurn();
         
         if (sanctioned) {
             Logger::log(name + " is sanctioned and cannot use economic actions");
-            throw std::runtime_error(name + " is sanctioned and cannot tax");
+            throw rejection(RejectReason::Sanctioned, name + " is sanctioned and cannot tax");
         }
         
         // Check for blocking BEFORE taking the money!
         game.setPendingAction(this, ActionType::Tax);
         if (game.checkForBlocking(this, ActionType::Tax)) {
             Logger::log(name + "'s tax was blocked");
+            timer.finish();
             return; // Don't take the money
         }
         
         BankManager::transferFromBank(*this, game, taxAmount());
         Logger::log(name + " collected tax of " + std::to_string(taxAmount()) + " coins");
         lastAction = ActionType::Tax;
+        timer.succeed();
     }
 
     void Player::bribe() {
+        ActionTimer timer(game.getMetrics(), ActionType::Bribe);
         Logger::log(name + " is attempting a bribe");
         requireTurn();
         if (lastAction == ActionType::None) {
             Logger::log("Cannot bribe without a previous action");
-            throw std::runtime_error("Bribe can only follow a regular action");
+            throw rejection(RejectReason::BribeUnavailable, "Bribe can only follow a regular action");
         }
         if (lastAction == ActionType::Bribe) {
             Logger::log("Cannot bribe twice in a row");
-            throw std::runtime_error("Cannot bribe twice in a row");
+            throw rejection(RejectReason::BribeUnavailable, "Cannot bribe twice in a row");
         }
         if (bribeUsedThisTurn) {
             Logger::log("Bribe already used this turn");
-            throw std::runtime_error("Already used bribe this turn");
+            throw rejection(RejectReason::BribeUnavailable, "Already used bribe this turn");
         }
         if (coins < 4) {
             Logger::log("Not enough coins to bribe");
-            throw std::runtime_error("Need 4 coins for bribe");
+            throw rejection(RejectReason::NotEnoughCoins, "Need 4 coins for bribe");
         }
 
         BankManager::transferToBank(*this, game, 4);
@@ -179,15 +192,18 @@ namespace coup {
 
         if (actionBlocked) {
             Logger::log(name + "'s bribe was blocked");
+            timer.finish();
             endTurn();
             return;
         }
 
         lastAction = ActionType::Bribe;
         bribeUsedThisTurn = true;
+        timer.succeed();
     }
 
     void Player::arrest(Player &target) {
+        ActionTimer timer(game.getMetrics(), ActionType::Arrest);
         Logger::log(name + " is attempting to arrest " + target.getName());
         requireTurn();
         requireAlive(target);
@@ -196,13 +212,13 @@ namespace coup {
 
         if (coins < 1) {
             Logger::log("Not enough coins to arrest");
-            throw std::runtime_error("Need at least 1 coin to arrest");
+            throw rejection(RejectReason::NotEnoughCoins, "Need at least 1 coin to arrest");
         }
 
         // Handle Merchant special case BEFORE transferring coins
         if (target.getRoleName() == "Merchant") {
             if (target.getCoins() < 2) {
-                throw std::runtime_error("Merchant does not have 2 coins for arrest penalty");
+                throw rejection(RejectReason::InvalidTarget, "Merchant does not have 2 coins for arrest penalty");
             }
             BankManager::transferToBank(target, game, 2);
             Logger::log(target.getName() + " is a Merchant and pays 2 coins to bank instead of to attacker");
@@ -221,12 +237,14 @@ namespace coup {
         lastAction = ActionType::Arrest;
         lastActionTarget = &target;
 
-        target.arrestStatus = ArrestStatus::ArrestedNow;
+        target.setArrestStatus(ArrestStatus::ArrestedNow);
 
         game.setPendingAction(this, ActionType::Arrest, &target);
+        timer.succeed();
     }
 
     void Player::sanction(Player &target) {
+        ActionTimer timer(game.getMetrics(), ActionType::Sanction);
         Logger::log(name + " is attempting to sanction " + target.getName());
         requireTurn();
         requireAlive(target);
@@ -240,12 +258,12 @@ namespace coup {
         }
 
         if (coins < totalCost) {
-            throw std::runtime_error("Need " + std::to_string(totalCost) + " coins to sanction " + target.getRoleName());
+            throw rejection(RejectReason::NotEnoughCoins, "Need " + std::to_string(totalCost) + " coins to sanction " + target.getRoleName());
         }
 
         // Pay the cost
         BankManager::transferToBank(*this, game, totalCost);
-        target.sanctioned = true;
+        target.setSanctioned(true);
         Logger::log(name + " sanctioned " + target.getName() + " (cost: " + std::to_string(totalCost) + ")");
 
         // Handle Baron compensation AFTER sanction
@@ -257,9 +275,11 @@ namespace coup {
         lastAction = ActionType::Sanction;
         lastActionTarget = &target;
         game.setPendingAction(this, ActionType::Sanction, &target);
+        timer.succeed();
     }
 
     void Player::coup(Player &target) {
+        ActionTimer timer(game.getMetrics(), ActionType::Coup);
         Logger::log(name + " is attempting a coup on " + target.getName());
         requireTurn();
         requireAlive(target);
@@ -267,7 +287,7 @@ namespace coup {
 
         if (coins < 7) {
             Logger::log("Not enough coins to coup");
-            throw std::runtime_error("Need at least 7 coins to perform a coup");
+            throw rejection(RejectReason::NotEnoughCoins, "Need at least 7 coins to perform a coup");
         }
 
         BankManager::transferToBank(*this, game, 7);
@@ -277,6 +297,7 @@ namespace coup {
         lastAction = ActionType::Coup;
         lastActionTarget = &target;
         game.setPendingAction(this, ActionType::Coup, &target);
+        timer.succeed();
     }
 
     bool Player::tryBlockAction(ActionType action, Player *actor, Player *target) {
@@ -291,12 +312,44 @@ namespace coup {
 
     bool Player::askForBribe() {
         Logger::log("Asking " + name + " for bribe decision");
-        return bribeDecisionCallback && bribeDecisionCallback(*this);
+        return decisionPolicy && decisionPolicy->shouldBribe(*this);
     }
 
     bool Player::askForBlock(ActionType action, Player *actor, Player *target) {
         Logger::log("Asking " + name + " for block decision on action");
-        return blockDecisionCallback && blockDecisionCallback(*this, action, target);
+        return decisionPolicy && decisionPolicy->shouldBlock(*this, action, actor, target);
+    }
+
+    void Player::saveState(PlayerSnapshot &out) const {
+        if (name.size() > SNAPSHOT_NAME_CAPACITY) {
+            throw std::runtime_error("Player name too long for a snapshot: " + name);
+        }
+        if (coins < INT16_MIN || coins > INT16_MAX) {
+            throw std::runtime_error("Coins of " + name + " do not fit in a snapshot");
+        }
+        std::memset(&out, 0, sizeof(out));
+        std::memcpy(out.name, name.data(), name.size());
+        out.nameLength = static_cast<std::uint8_t>(name.size());
+        out.coins = static_cast<std::int16_t>(coins);
+        out.role = static_cast<std::uint8_t>(roleOf(*this));
+        out.flags = static_cast<std::uint8_t>((sanctioned ? SNAPSHOT_SANCTIONED : 0) |
+                                              (actionBlocked ? SNAPSHOT_ACTION_BLOCKED : 0) |
+                                              (arrestBlocked ? SNAPSHOT_ARREST_BLOCKED : 0) |
+                                              (bribeUsedThisTurn ? SNAPSHOT_BRIBE_USED : 0));
+        out.arrestStatus = static_cast<std::uint8_t>(arrestStatus);
+        out.lastAction = static_cast<std::uint8_t>(lastAction);
+        out.lastActionTarget = SNAPSHOT_NO_SEAT;
+    }
+
+    void Player::restoreState(const PlayerSnapshot &state, Player *target) {
+        setCoins(state.coins);
+        setSanctioned(state.has(SNAPSHOT_SANCTIONED));
+        setArrestStatus(static_cast<ArrestStatus>(state.arrestStatus));
+        setArrestBlocked(state.has(SNAPSHOT_ARREST_BLOCKED));
+        actionBlocked = state.has(SNAPSHOT_ACTION_BLOCKED);
+        bribeUsedThisTurn = state.has(SNAPSHOT_BRIBE_USED);
+        lastAction = static_cast<ActionType>(state.lastAction);
+        lastActionTarget = target;
     }
 
-}
\ No newline at end of file
+}
@@ -7,17 +7,20 @@
 #include "../GameLogic/ActionType.hpp"
 #include "../GameLogic/BankManager.hpp"
 #include "../GameLogic/Logger.hpp"
+#include "DecisionPolicy.hpp"
+#include <cstdint>
 #include <string>
-#include <functional>
 #include <stdexcept>
 
 namespace coup {
 
+    struct PlayerSnapshot;  // forward declaration
+
     /**
      * @enum ArrestStatus
      * @brief Tracks the arrest status of a player
      */
-    enum class ArrestStatus { 
+    enum class ArrestStatus : std::uint8_t {
         Available,    ///< Player can be arrested
         ArrestedNow,  ///< Player was just arrested this turn
         Cooldown      ///< Player is in cooldown period after arrest
@@ -34,17 +37,38 @@ namespace coup {
     protected:
         Game &game;                    ///< Reference to the game instance
         std::string name;              ///< Player's name
+        Player *lastActionTarget;      ///< Target of last action
+        DecisionPolicy *decisionPolicy; ///< Automated decisions (not owned, may be nullptr)
         int coins;                     ///< Current coin count
-        bool sanctioned;               ///< Whether player is sanctioned
         ArrestStatus arrestStatus;     ///< Current arrest status
         ActionType lastAction;         ///< Last action performed
-        Player *lastActionTarget;      ///< Target of last action
+        bool sanctioned;               ///< Whether player is sanctioned
         bool actionBlocked;            ///< Whether last action was blocked
         bool arrestBlocked;            ///< Whether arrest ability is blocked
         bool bribeUsedThisTurn;        ///< Whether bribe was used this turn
 
-        std::function<bool(Player &)> bribeDecisionCallback;
-        std::function<bool(Player &, ActionType, Player *)> blockDecisionCallback;
+        /**
+         * @brief Set sanction flag and publish the change
+         * @param status New sanction flag
+         */
+        void setSanctioned(bool status) {
+            if (sanctioned != status) {
+                sanctioned = status;
+                game.notify(GameEventType::SanctionChanged, this, !status, status);
+            }
+        }
+
+        /**
+         * @brief Set arrest status and publish the change
+         * @param status New arrest status
+         */
+        void setArrestStatus(ArrestStatus status) {
+            if (arrestStatus != status) {
+                ArrestStatus old = arrestStatus;
+                arrestStatus = status;
+                game.notify(GameEventType::ArrestStatusChanged, this, static_cast<int>(old), static_cast<int>(status));
+            }
+        }
 
     public:
         /**
@@ -81,7 +105,13 @@ namespace coup {
          * @brief Set coin count
          * @param amount New coin amount
          */
-        void setCoins(int amount) { coins = amount; }
+        void setCoins(int amount) {
+            int old = coins;
+            coins = amount;
+            if (old != amount) {
+                game.notify(GameEventType::CoinsChanged, this, old, amount);
+            }
+        }
         
         /**
          * @brief Check if player is sanctioned
@@ -105,7 +135,12 @@ namespace coup {
          * @brief Set arrest blocked status
          * @param status New blocked status
          */
-        void setArrestBlocked(bool status) { arrestBlocked = status; }
+        void setArrestBlocked(bool status) {
+            if (arrestBlocked != status) {
+                arrestBlocked = status;
+                game.notify(GameEventType::ArrestBlockedChanged, this, !status, status);
+            }
+        }
         
         /**
          * @brief Get last action performed
@@ -161,6 +196,14 @@ namespace coup {
             throw std::runtime_error("Undo not supported by this role"); 
         }
 
+        /**
+         * @brief Count a rejection of the action in progress
+         * @param reason Reason recorded in the game's action metrics
+         * @param message Exception message
+         * @return Exception to throw (throw rejection(...))
+         */
+        std::runtime_error rejection(RejectReason reason, const std::string &message) const;
+
         /**
          * @brief Verify it's this player's turn
          * @throws std::runtime_error if not their turn
@@ -262,20 +305,16 @@ namespace coup {
         bool askForBlock(ActionType action, Player *actor, Player *target);
 
         /**
-         * @brief Set bribe decision callback
-         * @param callback Function to call for bribe decisions
+         * @brief Set the policy used for bribe and block decisions
+         * @param policy Policy to consult (not owned), or nullptr to always decline
          */
-        void setBribeDecisionCallback(std::function<bool(Player &)> callback) {
-            bribeDecisionCallback = callback;
-        }
-        
+        void setDecisionPolicy(DecisionPolicy *policy) { decisionPolicy = policy; }
+
         /**
-         * @brief Set block decision callback
-         * @param callback Function to call for block decisions
+         * @brief Get the current decision policy
+         * @return Pointer to policy or nullptr
          */
-        void setBlockDecisionCallback(std::function<bool(Player &, ActionType, Player *)> callback) {
-            blockDecisionCallback = callback;
-        }
+        DecisionPolicy* getDecisionPolicy() const { return decisionPolicy; }
         
         /**
          * @brief Check if can use bribe
@@ -292,13 +331,27 @@ namespace coup {
         bool hasBribedThisTurn() const {
             return bribeUsedThisTurn;
         }
+
+        /**
+         * @brief Copy this player's state into a snapshot seat
+         * @param out Seat to fill (lastActionTarget and the alive flag are left to the game)
+         * @throws std::runtime_error if the player has no role or the name or coins do not fit
+         */
+        void saveState(PlayerSnapshot &out) const;
+
+        /**
+         * @brief Restore this player's state from a snapshot seat
+         * @param state Seat to restore from
+         * @param target Player the seat's lastActionTarget refers to (or nullptr)
+         */
+        void restoreState(const PlayerSnapshot &state, Player *target);
     
         /**
          * @brief Clear turn-specific flags
          */
         void clearTurnFlags() {
-            sanctioned = false;
-            arrestBlocked = false;
+            setSanctioned(false);
+            setArrestBlocked(false);
         }
     };
 
@@ -9,15 +9,16 @@ namespace coup {
         : Player(game, name) {}
 
     void Baron::invest() {
+        ActionTimer timer(game.getMetrics(), ActionType::Invest);
         Logger::log(name + " is attempting to invest");
 
         if (game.turn() != name) {
             Logger::log("Invest failed: not " + name + "'s turn");
-            throw std::runtime_error("Not your turn");
+            throw rejection(RejectReason::NotYourTurn, "Not your turn");
         }
         if (coins < 3) {
             Logger::log("Invest failed: not enough coins");
-            throw std::runtime_error("Not enough coins to invest");
+            throw rejection(RejectReason::NotEnoughCoins, "Not enough coins to invest");
         }
 
         BankManager::transferToBank(*this, game, 3);
@@ -26,6 +27,7 @@ namespace coup {
         Logger::log(name + " invested 3 coins and received 6 coins");
 
         lastAction = ActionType::Invest;
+        timer.succeed();
 
         if (!bribeUsedThisTurn && askForBribe()) {
             return;
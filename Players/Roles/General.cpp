@@ -51,6 +51,7 @@ namespace coup {
         }
 
         lastActor->blockLastAction();
+        game.getMetrics().recordBlock(ActionType::Coup, Role::General);
         Logger::log(name + " successfully blocked coup against " + targetPlayer.getName() + " (cost 5 coins)");
     }
 
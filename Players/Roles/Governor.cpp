@@ -15,12 +15,14 @@ namespace coup {
     }
 
     void Governor::tax() {
+        ActionTimer timer(game.getMetrics(), ActionType::Tax);
         Logger::log(name + " (Governor) is collecting enhanced tax (3 coins)");
         requireTurn();
         BankManager::transferFromBank(*this, game, 3);
         Logger::log(name + " collected 3 coins (Governor tax)");
         lastAction = ActionType::Tax;
         game.setPendingAction(this, ActionType::Tax);
+        timer.succeed();
     }
 
     void Governor::blockTax(Player &actor) {
@@ -44,6 +46,7 @@ namespace coup {
 
         BankManager::transferToBank(actor, game, actor.taxAmount());
         actor.blockLastAction();
+        game.getMetrics().recordBlock(ActionType::Tax, Role::Governor);
 
         Logger::log(name + " blocked tax of " + actor.getName() +
                     ", returned " + std::to_string(actor.taxAmount()) + " coins to bank");
@@ -35,6 +35,7 @@ namespace coup {
 
         // Important: money was already paid to bank during bribe
         actor.blockLastAction();
+        game.getMetrics().recordBlock(ActionType::Bribe, Role::Judge);
         Logger::log(name + " blocked bribe of " + actor.getName() + ", they lose their 4 coins permanently");
     }
 
@@ -0,0 +1,355 @@
+// Email: nitzanwa@gmail.com
+
+#include "Simulator.hpp"
+#include "../GameLogic/ActionJournal.hpp"
+#include "../GameLogic/PlayerFactory.hpp"
+#include "../GameLogic/PositionStore.hpp"
+#include "../Players/Player.hpp"
+#include "../Players/Roles/Baron.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    namespace {
+
+        enum Choice { ChooseGather, ChooseTax, ChooseArrest, ChooseSanction, ChooseInvest, CHOICE_COUNT };
+
+        // Relative weights per style, indexed by Choice
+        const int STYLE_WEIGHTS[3][CHOICE_COUNT] = {
+            {2, 2, 2, 2, 2},  // Random
+            {1, 1, 4, 3, 1},  // Aggressive
+            {3, 4, 1, 1, 4}   // Economic
+        };
+
+        std::uint8_t journalSeat(const Game &game, const Player *player) {
+            int seat = game.seatOf(player);
+            return seat < 0 ? JOURNAL_NO_SEAT : static_cast<std::uint8_t>(seat);
+        }
+
+        // Seats are looked up before the call: a coup unseats its target
+        void journalOp(ActionJournal *journal, JournalOp op, std::uint8_t actor, std::uint8_t target = JOURNAL_NO_SEAT) {
+            if (journal) {
+                journal->record(JournalEntry{op, actor, target});
+            }
+        }
+
+        Player *pickTarget(Game &game, const Player &self, Rng &rng) {
+            Game::PlayerList others;
+            for (Player *p : game.alivePlayers()) {
+                if (p != &self) {
+                    others.push_back(p);
+                }
+            }
+            if (others.empty()) {
+                return nullptr;
+            }
+            return others[rng.uniform(others.size())];
+        }
+
+        Choice pickChoice(BotStyle style, Rng &rng) {
+            const int *weights = STYLE_WEIGHTS[static_cast<int>(style)];
+            int total = 0;
+            for (int i = 0; i < CHOICE_COUNT; ++i) {
+                total += weights[i];
+            }
+            int roll = static_cast<int>(rng.uniform(static_cast<std::uint64_t>(total)));
+            for (int i = 0; i < CHOICE_COUNT; ++i) {
+                roll -= weights[i];
+                if (roll < 0) {
+                    return static_cast<Choice>(i);
+                }
+            }
+            return ChooseGather;
+        }
+
+        // Attempts one regular action; the engine throws on illegal moves
+        void performChoice(Game &game, Player &player, Choice choice, Rng &rng, ActionJournal *journal) {
+            std::uint8_t seat = journal ? journalSeat(game, &player) : 0;
+            switch (choice) {
+                case ChooseGather:
+                    player.gather();
+                    journalOp(journal, JournalOp::Gather, seat);
+                    break;
+                case ChooseTax:
+                    player.tax();
+                    journalOp(journal, JournalOp::Tax, seat);
+                    break;
+                case ChooseArrest: {
+                    Player *target = pickTarget(game, player, rng);
+                    if (!target) throw std::runtime_error("No arrest target");
+                    player.arrest(*target);
+                    journalOp(journal, JournalOp::Arrest, seat, journal ? journalSeat(game, target) : 0);
+                    break;
+                }
+                case ChooseSanction: {
+                    Player *target = pickTarget(game, player, rng);
+                    if (!target) throw std::runtime_error("No sanction target");
+                    player.sanction(*target);
+                    journalOp(journal, JournalOp::Sanction, seat, journal ? journalSeat(game, target) : 0);
+                    break;
+                }
+                case ChooseInvest: {
+                    Baron *baron = dynamic_cast<Baron *>(&player);
+                    if (!baron) throw std::runtime_error("Only a Baron can invest");
+                    baron->invest();
+                    journalOp(journal, JournalOp::Invest, seat);
+                    break;
+                }
+                default:
+                    player.gather();
+                    journalOp(journal, JournalOp::Gather, seat);
+                    break;
+            }
+        }
+
+        // Tries the chosen action, then gather; a sanctioned player may do neither
+        void performAnyAction(Game &game, Player &player, BotStyle style, Rng &rng, ActionJournal *journal) {
+            try {
+                performChoice(game, player, pickChoice(style, rng), rng, journal);
+            } catch (const std::runtime_error &) {
+                try {
+                    player.gather();
+                    journalOp(journal, JournalOp::Gather, journal ? journalSeat(game, &player) : 0);
+                } catch (const std::runtime_error &) {
+                    // No legal economic action this turn
+                }
+            }
+        }
+
+    }
+
+    bool BotDecisions::shouldBribe(Player &) {
+        if (journal) {
+            journal->record(JournalEntry{JournalOp::Decision, seat, 0});
+        }
+        return false;
+    }
+
+    bool BotDecisions::shouldBlock(Player &, ActionType, Player *, Player *) {
+        bool block;
+        switch (style) {
+            case BotStyle::Aggressive: block = rng->uniform(4) == 0; break;
+            case BotStyle::Economic: block = rng->uniform(4) != 0; break;
+            default: block = rng->uniform(2) == 0; break;
+        }
+        if (journal) {
+            journal->record(JournalEntry{JournalOp::Decision, seat, static_cast<std::uint8_t>(block)});
+        }
+        return block;
+    }
+
+    BotStyle Simulator::styleForSeat(std::size_t seat) {
+        static const BotStyle MIX[] = {BotStyle::Random, BotStyle::Aggressive, BotStyle::Economic};
+        return MIX[seat % 3];
+    }
+
+    bool Simulator::playTurn(Game &game, BotStyle style, ActionJournal *journal) {
+        if (game.isGameOver()) {
+            return false;
+        }
+        Player *player = game.getCurrentPlayer();
+        if (!player) {
+            return false;
+        }
+        Rng &rng = game.getRng();
+        std::uint8_t seat = journal ? journalSeat(game, player) : 0;
+
+        try {
+            player->startTurn();
+            journalOp(journal, JournalOp::StartTurn, seat);
+        } catch (const std::runtime_error &) {
+            // 10+ coins (handled below) or an empty bank for the Merchant bonus
+        }
+
+        int coupChance = style == BotStyle::Aggressive ? 1 : 3;
+        if (player->getCoins() >= 10 || (player->getCoins() >= 7 && rng.uniform(coupChance) == 0)) {
+            Player *target = pickTarget(game, *player, rng);
+            if (target) {
+                std::uint8_t targetSeat = journal ? journalSeat(game, target) : 0;
+                player->coup(*target);
+                journalOp(journal, JournalOp::Coup, seat, targetSeat);
+            }
+        } else {
+            performAnyAction(game, *player, style, rng, journal);
+
+            // Occasionally pay for a second action
+            if (!game.isGameOver() && player->canUseBribe() && rng.uniform(4) == 0) {
+                try {
+                    player->bribe();
+                    journalOp(journal, JournalOp::Bribe, seat);
+                    if (game.getCurrentPlayer() == player) {
+                        performAnyAction(game, *player, style, rng, journal);
+                    }
+                } catch (const std::runtime_error &) {
+                    // Bribe not possible after all
+                }
+            }
+        }
+
+        // A blocked bribe already ended the turn inside the engine
+        if (!game.isGameOver() && game.getCurrentPlayer() == player) {
+            player->endTurn();
+            journalOp(journal, JournalOp::EndTurn, seat);
+        }
+        return true;
+    }
+
+    GameResult Simulator::runGame(std::uint64_t seed, std::size_t playerCount, int maxTurns, GameObserver *observer,
+                                  ActionJournal *journal, PositionStore *positions, GameOutcome *outcome) {
+        SimulatedGame simulated(seed, playerCount, maxTurns, observer, journal, positions, outcome);
+        while (simulated.step()) {
+        }
+        return simulated.finish();
+    }
+
+    void OutcomeTally::gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                                   const std::vector<Role> &roles) {
+        if (next) {
+            next->gameStarted(seed, names, roles);
+        }
+    }
+
+    // record() casts Gather..Invest straight to ActionType; keep the numbering pinned
+    static_assert(static_cast<int>(JournalOp::Gather) == static_cast<int>(ActionType::Gather), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Tax) == static_cast<int>(ActionType::Tax), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Bribe) == static_cast<int>(ActionType::Bribe), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Arrest) == static_cast<int>(ActionType::Arrest), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Sanction) == static_cast<int>(ActionType::Sanction), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Coup) == static_cast<int>(ActionType::Coup), "JournalOp/ActionType mismatch");
+    static_assert(static_cast<int>(JournalOp::Invest) == static_cast<int>(ActionType::Invest), "JournalOp/ActionType mismatch");
+
+    void OutcomeTally::record(const JournalEntry &entry) {
+        if (entry.op >= JournalOp::Gather && entry.op <= JournalOp::Invest && entry.actor < Game::MAX_PLAYERS) {
+            outcome->countAction(entry.actor, static_cast<ActionType>(entry.op));
+        }
+        if (next) {
+            next->record(entry);
+        }
+    }
+
+    void OutcomeTally::gameEnded(int winnerSeat) {
+        if (next) {
+            next->gameEnded(winnerSeat);
+        }
+    }
+
+    namespace {
+        std::size_t requirePlayerCount(std::size_t playerCount) {
+            if (playerCount < 2 || playerCount > Game::MAX_PLAYERS) {
+                throw std::runtime_error("Simulation needs 2-" + std::to_string(Game::MAX_PLAYERS) + " players");
+            }
+            return playerCount;
+        }
+    }
+
+    SimulatedGame::SimulatedGame(std::uint64_t seed, std::size_t playerCount, int maxTurns, GameObserver *observer,
+                                 ActionJournal *journal, PositionStore *positions, GameOutcome *outcome)
+        : playerCount(requirePlayerCount(playerCount)), game(seed), styles{}, observer(observer),
+          journal(outcome ? &tally : journal), positions(positions), outcome(outcome), maxTurns(maxTurns),
+          result{seed, playerCount, false, 0, "", ""}, ended(false) {
+        static const char *NAMES[] = {"P1", "P2", "P3", "P4", "P5", "P6"};
+        game.setConsoleMode(false);
+        if (observer) {
+            game.subscribe(observer);
+        }
+        if (outcome) {
+            tally.outcome = outcome;
+            tally.next = journal;
+            // Reset field by field so a reused outcome keeps its coins buffer
+            outcome->seed = seed;
+            outcome->playerCount = static_cast<std::uint8_t>(playerCount);
+            outcome->roles = {};
+            outcome->winnerSeat = -1;
+            outcome->turns = 0;
+            outcome->coins.clear();
+            outcome->actions = {};
+        }
+
+        // Same draw as Game::setup(names), made here so the journal sees the roles
+        InlineVector<Role, Game::MAX_PLAYERS> drawn = drawBalancedRoles(game.getRng(), playerCount);
+        std::vector<std::string> names(NAMES, NAMES + playerCount);
+        std::vector<Role> roles(drawn.begin(), drawn.end());
+        table = game.setup(names, roles);
+        if (this->journal) {
+            this->journal->gameStarted(seed, names, roles);
+        }
+        if (outcome) {
+            std::copy(roles.begin(), roles.end(), outcome->roles.begin());
+        }
+
+        for (std::size_t seat = 0; seat < table.size(); ++seat) {
+            styles[seat] = Simulator::styleForSeat(seat);
+            policies[seat] = StaticPolicy<BotDecisions>(
+                BotDecisions{&game.getRng(), styles[seat], this->journal, static_cast<std::uint8_t>(seat)});
+            table[seat]->setDecisionPolicy(&policies[seat]);
+        }
+        if (positions) {
+            played.emplace_back();
+            game.saveSnapshot(played.back());
+        }
+    }
+
+    bool SimulatedGame::step() {
+        if (ended || result.turns >= maxTurns || game.isGameOver()) {
+            return false;
+        }
+        Player *current = game.getCurrentPlayer();
+        std::size_t seat = 0;
+        while (seat < table.size() && table[seat] != current) {
+            ++seat;
+        }
+        if (seat == table.size() || !Simulator::playTurn(game, styles[seat], journal)) {
+            return false;
+        }
+        ++result.turns;
+        if (outcome) {
+            for (const Player *player : table) {
+                outcome->coins.push_back(static_cast<std::int16_t>(game.isAlive(*player) ? player->getCoins() : 0));
+            }
+        }
+        if (positions) {
+            played.emplace_back();
+            game.saveSnapshot(played.back());
+        }
+        return true;
+    }
+
+    const GameResult &SimulatedGame::finish() {
+        if (ended) {
+            return result;
+        }
+        ended = true;
+        int winnerSeat = -1;
+        if (game.isGameOver()) {
+            Player *winner = game.getCurrentPlayer();
+            result.finished = winner != nullptr;
+            if (winner) {
+                result.winner = winner->getName();
+                result.winnerRole = winner->getRoleName();
+                winnerSeat = game.seatOf(winner);
+            }
+        }
+        if (journal) {
+            journal->gameEnded(winnerSeat);
+        }
+        if (outcome) {
+            outcome->winnerSeat = winnerSeat;
+            outcome->turns = static_cast<std::uint32_t>(result.turns);
+        }
+        if (observer) {
+            game.unsubscribe(observer);
+        }
+        if (positions) {
+            std::uint8_t winner = winnerSeat < 0 ? SNAPSHOT_NO_SEAT : static_cast<std::uint8_t>(winnerSeat);
+            positions->append(positions->newGameId(), played.data(), played.size(), winner);
+            played.clear();
+        }
+        return result;
+    }
+
+}
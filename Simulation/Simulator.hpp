@@ -0,0 +1,180 @@
+// Email: nitzanwa@gmail.com
+
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include "../GameLogic/ActionJournal.hpp"
+#include "../GameLogic/Game.hpp"
+#include "../GameLogic/OutcomeFile.hpp"
+#include "../GameLogic/Snapshot.hpp"
+#include "../Players/DecisionPolicy.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace coup {
+
+    class PositionStore;  // forward declaration
+
+    /**
+     * @enum BotStyle
+     * @brief Playing styles for headless bots
+     */
+    enum class BotStyle : std::uint8_t {
+        Random,      ///< Uniform choice among legal-looking actions
+        Aggressive,  ///< Prefers arrest, sanction and early coups
+        Economic     ///< Prefers income actions and blocks often
+    };
+
+    /**
+     * @struct GameResult
+     * @brief Outcome of one simulated game
+     */
+    struct GameResult {
+        std::uint64_t seed;        ///< Seed the game was played with
+        std::size_t playerCount;   ///< Number of players at the table
+        bool finished;             ///< Whether a winner emerged before the turn cap
+        int turns;                 ///< Number of turns played
+        std::string winner;        ///< Winner's name (empty if unfinished)
+        std::string winnerRole;    ///< Winner's role (empty if unfinished)
+    };
+
+    /**
+     * @class Simulator
+     * @brief Plays complete games between bots without any console interaction
+     * 
+     * Every decision is drawn from the game's seeded Rng, so a (seed,
+     * playerCount) pair always replays the same game. Seats use a fixed mix
+     * of bot styles (see styleForSeat).
+     */
+    class Simulator {
+    public:
+        static constexpr int DEFAULT_MAX_TURNS = 500;  ///< Turn cap for stalled games
+
+        /**
+         * @brief Play one full game
+         * @param seed Game seed (roles and all bot decisions derive from it)
+         * @param playerCount Number of players (2-6)
+         * @param maxTurns Turn cap after which the game is abandoned
+         * @param observer Optional subscriber for the whole game, from the first player joining
+         * @param journal Optional journal of the setup and every accepted operation
+         * @param positions Optional store that receives every position of the game with its outcome
+         * @param outcome Optional record of the game for the columnar export (see OutcomeWriter)
+         * @return Outcome of the game
+         * @throws std::runtime_error if playerCount is out of range, or the store is full
+         */
+        static GameResult runGame(std::uint64_t seed, std::size_t playerCount, int maxTurns = DEFAULT_MAX_TURNS,
+                                  GameObserver *observer = nullptr, ActionJournal *journal = nullptr,
+                                  PositionStore *positions = nullptr, GameOutcome *outcome = nullptr);
+
+        /**
+         * @brief Play the next turn of a game that was set up by the caller
+         * @param game Game in progress
+         * @param style Style of the bot whose turn it is
+         * @param journal Optional journal of the operations that succeed
+         * @return false if no turn could be played (game over)
+         */
+        static bool playTurn(Game &game, BotStyle style, ActionJournal *journal = nullptr);
+
+        /**
+         * @brief Bot style used for a seat in the fixed mix
+         * @param seat Seat index in turn order
+         * @return Style for that seat
+         */
+        static BotStyle styleForSeat(std::size_t seat);
+    };
+
+    /**
+     * @struct BotDecisions
+     * @brief Block and bribe decisions of a simulated seat
+     *
+     * Draws from the game's Rng; with a journal, every answer is recorded
+     * as a Decision entry so the game can be replayed without the Rng.
+     */
+    struct BotDecisions {
+        Rng *rng = nullptr;
+        BotStyle style = BotStyle::Random;
+        ActionJournal *journal = nullptr;
+        std::uint8_t seat = 0;
+
+        bool shouldBribe(Player &player);
+        bool shouldBlock(Player &blocker, ActionType action, Player *actor, Player *target);
+    };
+
+    /**
+     * @class OutcomeTally
+     * @brief Journal that counts each seat's accepted actions into a GameOutcome
+     *
+     * Everything it hears is passed on to the next journal, if any.
+     */
+    class OutcomeTally : public ActionJournal {
+    public:
+        GameOutcome *outcome = nullptr;
+        ActionJournal *next = nullptr;
+
+        void gameStarted(std::uint64_t seed, const std::vector<std::string> &names,
+                         const std::vector<Role> &roles) override;
+        void record(const JournalEntry &entry) override;
+        void gameEnded(int winnerSeat) override;
+    };
+
+    /**
+     * @class SimulatedGame
+     * @brief One bot game played a turn at a time
+     *
+     * Lets a host interleave many live games (Simulator::runGame plays one
+     * to the end). The game is set up in the constructor; step() plays
+     * turns until the game is over or the turn cap is reached, and finish()
+     * reports the outcome. A game dropped before finish() is "in flight":
+     * its journal never hears gameEnded().
+     */
+    class SimulatedGame {
+    private:
+        std::size_t playerCount;
+        Game game;
+        Game::PlayerList table;
+        std::array<StaticPolicy<BotDecisions>, Game::MAX_PLAYERS> policies;
+        std::array<BotStyle, Game::MAX_PLAYERS> styles;
+        GameObserver *observer;
+        OutcomeTally tally;
+        ActionJournal *journal;     ///< The caller's journal, or the tally in front of it
+        PositionStore *positions;
+        GameOutcome *outcome;
+        std::vector<GameSnapshot> played;  ///< Positions so far, stored when the game ends
+        int maxTurns;
+        GameResult result;
+        bool ended;
+
+    public:
+        /**
+         * @brief Set up a game (see Simulator::runGame for the parameters)
+         * @throws std::runtime_error if playerCount is out of range
+         */
+        SimulatedGame(std::uint64_t seed, std::size_t playerCount, int maxTurns = Simulator::DEFAULT_MAX_TURNS,
+                      GameObserver *observer = nullptr, ActionJournal *journal = nullptr,
+                      PositionStore *positions = nullptr, GameOutcome *outcome = nullptr);
+        SimulatedGame(const SimulatedGame &other) = delete;
+        SimulatedGame &operator=(const SimulatedGame &other) = delete;
+
+        /**
+         * @brief Play the current player's turn
+         * @return false once the game is over, capped or finished
+         */
+        bool step();
+
+        /**
+         * @brief End the game and report its outcome (to the journal, position store and outcome too)
+         * @throws std::runtime_error if the position store is full
+         */
+        const GameResult &finish();
+
+        Game &getGame() { return game; }
+        const Game::PlayerList &getTable() const { return table; }
+        int getTurns() const { return result.turns; }
+    };
+
+}
+
+#endif // SIMULATOR_HPP
@@ -0,0 +1,147 @@
+// Email: nitzanwa@gmail.com
+
+#include "Simulator.hpp"
+#include "../GameLogic/Logger.hpp"
+#include "../GameLogic/MetricsExporter.hpp"
+#include "../GameLogic/OutcomeFile.hpp"
+#include "../GameLogic/PositionStore.hpp"
+#include "../GameLogic/Replay.hpp"
+#include "../GameLogic/Tracer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace coup;
+
+// Usage: coup_sim [games] [seed] [players]
+// players = 0 cycles through 2-6 player tables
+// COUP_TRACE=<file> writes a Chrome trace of every action and block check
+// COUP_METRICS_PORT=<port> serves Prometheus metrics on 127.0.0.1:<port>/metrics
+// COUP_METRICS_FILE=<file> rewrites a metrics snapshot every COUP_METRICS_INTERVAL s (default 5)
+// COUP_POSITIONS=<file> stores every position with its game's outcome in a position store
+// of COUP_POSITIONS_CAPACITY records (default 128 per game)
+// COUP_OUTCOMES=<file> writes every game's outcome (roles, winner, coins per turn, action counts)
+// as a columnar outcome file
+// COUP_RECORD=<file> saves game number COUP_RECORD_GAME (default 0) as a recording for gui_app
+int main(int argc, char *argv[]) {
+    long games = argc > 1 ? std::atol(argv[1]) : 1000;
+    std::uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    long players = argc > 3 ? std::atol(argv[3]) : 0;
+
+    if (games <= 0 || players < 0 || players == 1 || players > static_cast<long>(Game::MAX_PLAYERS)) {
+        std::cerr << "Usage: " << argv[0] << " [games > 0] [seed] [players 2-6, or 0 for mixed]" << std::endl;
+        return 1;
+    }
+
+    Logger::setEnabled(false);
+    std::string tracePath = Tracer::environmentPath();
+    Tracer::setEnabled(!tracePath.empty());
+
+    MetricsExporter exporter;
+    try {
+        if (exporter.startFromEnvironment() && exporter.getPort()) {
+            std::cout << "Metrics: http://127.0.0.1:" << exporter.getPort() << "/metrics" << std::endl;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<PositionStore> positions;
+    const char *positionsPath = std::getenv("COUP_POSITIONS");
+    if (positionsPath && *positionsPath) {
+        const char *capacity = std::getenv("COUP_POSITIONS_CAPACITY");
+        std::uint64_t records = capacity ? std::strtoull(capacity, nullptr, 10) : static_cast<std::uint64_t>(games) * 128;
+        try {
+            positions.reset(new PositionStore(PositionStore::create(positionsPath, records)));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<OutcomeWriter> outcomes;
+    GameOutcome outcome;
+    const char *outcomesPath = std::getenv("COUP_OUTCOMES");
+    if (outcomesPath && *outcomesPath) {
+        try {
+            outcomes.reset(new OutcomeWriter(outcomesPath));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    const char *recordPath = std::getenv("COUP_RECORD");
+    const char *recordGame = std::getenv("COUP_RECORD_GAME");
+    long recorded = recordPath && *recordPath ? (recordGame ? std::atol(recordGame) : 0) : -1;
+    GameRecording recording;
+
+    std::map<std::string, long> winsByRole;
+    long finished = 0;
+    long turns = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < games; ++i) {
+        std::size_t tableSize = players ? static_cast<std::size_t>(players) : 2 + static_cast<std::size_t>(i % 5);
+        Rng stream = Rng::forStream(seed, static_cast<std::uint64_t>(i));
+        if (positions && positions->capacity() - positions->size() <= Simulator::DEFAULT_MAX_TURNS) {
+            std::cerr << "Position store is full after " << i << " games; not storing further positions" << std::endl;
+            positions->sync();
+            positions.reset();
+        }
+        GameResult result = Simulator::runGame(stream.getSeed(), tableSize, Simulator::DEFAULT_MAX_TURNS, nullptr,
+                                               i == recorded ? &recording : nullptr, positions.get(),
+                                               outcomes ? &outcome : nullptr);
+        if (outcomes) {
+            outcomes->append(outcome);
+        }
+        turns += result.turns;
+        if (result.finished) {
+            ++finished;
+            ++winsByRole[result.winnerRole];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Games: " << games << " (finished " << finished << ")" << std::endl;
+    std::cout << "Turns: " << turns << " (avg " << static_cast<double>(turns) / games << ")" << std::endl;
+    std::cout << "Time: " << seconds << " s, " << games / seconds << " games/s" << std::endl;
+    for (const auto &entry : winsByRole) {
+        std::cout << "  " << entry.first << " wins: " << entry.second << std::endl;
+    }
+    if (positions) {
+        positions->sync();
+        std::cout << "Positions: " << positions->size() << " stored in " << positionsPath << std::endl;
+    }
+    if (outcomes) {
+        try {
+            outcomes->close();
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Outcomes: " << outcomes->size() << " games (" << outcomes->bytesWritten() << " bytes) written to "
+                  << outcomesPath << std::endl;
+    }
+    if (recorded >= 0 && recording.ended) {
+        try {
+            recording.save(recordPath);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Recording: game " << recorded << " (seed " << recording.seed << ", "
+                  << recording.entries.size() << " entries) saved to " << recordPath << std::endl;
+    }
+    if (!tracePath.empty()) {
+        Tracer::writeChromeTrace(tracePath);
+        std::cout << "Trace: " << Tracer::eventCount() << " spans written to " << tracePath
+                  << " (" << Tracer::droppedCount() << " dropped)" << std::endl;
+    }
+    return 0;
+}
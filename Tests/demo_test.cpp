@@ -11,8 +11,20 @@
 #include "doctest.h"
 
 #include "../GameLogic/Game.hpp"
+#include "../GameLogic/AllocationTracker.hpp"
 #include "../GameLogic/BankManager.hpp"
 #include "../GameLogic/Logger.hpp"
+#include "../GameLogic/EngineMetrics.hpp"
+#include "../GameLogic/MetricsExporter.hpp"
+#include "../GameLogic/OutcomeFile.hpp"
+#include "../GameLogic/Spectator.hpp"
+#include "../GameLogic/SpectatorServer.hpp"
+#include "../GameLogic/Tracer.hpp"
+#include "../GameLogic/WriteAheadLog.hpp"
+#include "../GameLogic/PlayerFactory.hpp"
+#include "../GameLogic/PositionStore.hpp"
+#include "../GameLogic/Replay.hpp"
+#include "../GameLogic/Snapshot.hpp"
 #include "../Players/Player.hpp"
 #include "../Players/Roles/Governor.hpp"
 #include "../Players/Roles/Judge.hpp"
@@ -20,6 +32,22 @@
 #include "../Players/Roles/Baron.hpp"
 #include "../Players/Roles/Merchant.hpp"
 #include "../Players/Roles/Spy.hpp"
+#include "../Simulation/Simulator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 using namespace coup;
 
@@ -834,6 +862,1498 @@ TEST_CASE("Role Interaction Edge Cases") {
     }
 }
 
+// ==========================================
+// ALLOCATION-FREE QUERY VERIFICATION
+// ==========================================
+
+TEST_CASE("Alive Player Queries Without Allocation") {
+    Game game;
+    game.setConsoleMode(false);
+    Governor alice(game, "Alice");
+    Judge bob(game, "Bob");
+    General charlie(game, "Charlie");
+
+    SUBCASE("Range skips eliminated players") {
+        alice.setCoins(7);
+        alice.coup(bob);
+
+        std::vector<Player*> seen;
+        for (Player* p : game.alivePlayers()) {
+            seen.push_back(p);
+        }
+        CHECK(seen == std::vector<Player*>{&alice, &charlie});
+        CHECK(game.aliveCount() == 2);
+        CHECK(seen == game.getAllAlivePlayers());
+    }
+
+    SUBCASE("Inline list matches alive players") {
+        Game::PlayerList list = game.getAlivePlayerList();
+        CHECK(list.size() == 3);
+        CHECK(list[0] == &alice);
+        CHECK(list.back() == &charlie);
+        CHECK(Game::PlayerList::capacity() == Game::MAX_PLAYERS);
+    }
+
+    SUBCASE("Fill variant respects buffer capacity") {
+        Player* buffer[2] = {nullptr, nullptr};
+        CHECK(game.fillAlivePlayers(buffer, 2) == 2);
+        CHECK(buffer[0] == &alice);
+        CHECK(buffer[1] == &bob);
+    }
+
+    SUBCASE("Empty game has empty range") {
+        Game empty;
+        CHECK(empty.alivePlayers().empty());
+        CHECK(empty.aliveCount() == 0);
+    }
+}
+
+// ==========================================
+// SEEDED RANDOMNESS VERIFICATION
+// ==========================================
+
+static std::vector<std::string> drawRoles(std::uint64_t seed) {
+    Game game(seed);
+    std::vector<std::string> roles;
+    std::vector<Player*> created;
+    for (int i = 0; i < 6; ++i) {
+        created.push_back(randomPlayer(game, "P" + std::to_string(i)));
+        roles.push_back(created.back()->getRoleName());
+    }
+    for (Player* p : created) {
+        delete p;
+    }
+    return roles;
+}
+
+TEST_CASE("Seeded Random Role Assignment") {
+    SUBCASE("Same seed gives the same roles") {
+        CHECK(drawRoles(42) == drawRoles(42));
+    }
+
+    SUBCASE("Game remembers its seed") {
+        Game game(1234);
+        CHECK(game.getSeed() == 1234);
+        game.getRng()();
+        game.resetGame();
+        CHECK(game.getRng().getPosition() == 0);
+    }
+
+    SUBCASE("Streams are reproducible and independent") {
+        Rng a = Rng::forStream(7, 0);
+        Rng b = Rng::forStream(7, 0);
+        Rng c = Rng::forStream(7, 1);
+        std::uint64_t first = a();
+        CHECK(first == b());
+        CHECK(first != c());
+    }
+
+    SUBCASE("Uniform draws stay in range and skip ahead") {
+        Rng rng(99);
+        for (int i = 0; i < 1000; ++i) {
+            CHECK(rng.uniform(6) < 6);
+        }
+        Rng x(5), y(5);
+        x();
+        x();
+        y.discard(2);
+        CHECK(x() == y());
+        CHECK_THROWS_AS(rng.uniform(0), std::runtime_error);
+    }
+}
+
+// ==========================================
+// BULK SETUP VERIFICATION
+// ==========================================
+
+TEST_CASE("Bulk Game Setup") {
+    SUBCASE("Explicit roles are created in order") {
+        Game game;
+        Game::PlayerList table = game.setup({"Alice", "Bob", "Charlie"},
+                                            {Role::Governor, Role::Judge, Role::Spy});
+        CHECK(table.size() == 3);
+        CHECK(table[0]->getRoleName() == "Governor");
+        CHECK(table[1]->getRoleName() == "Judge");
+        CHECK(table[2]->getRoleName() == "Spy");
+        CHECK(game.turn() == "Alice");
+        CHECK(game.players().size() == 3);
+    }
+
+    SUBCASE("Setup logs one line for the whole table") {
+        bool wasEnabled = Logger::isEnabled();
+        Logger::setEnabled(true);
+        std::ostringstream captured;
+        std::streambuf *original = std::cout.rdbuf(captured.rdbuf());
+        Game game;
+        std::string before = captured.str();
+        game.setup({"Alice", "Bob", "Charlie"}, {Role::Governor, Role::Judge, Role::Spy});
+        std::string logged = captured.str().substr(before.size());
+        std::cout.rdbuf(original);
+        Logger::setEnabled(wasEnabled);
+
+        CHECK(std::count(logged.begin(), logged.end(), '\n') == 1);
+        CHECK(logged.find("Alice (Governor) Bob (Judge) Charlie (Spy)") != std::string::npos);
+    }
+
+    SUBCASE("Balanced draw deals distinct roles reproducibly") {
+        Game first(2024);
+        Game second(2024);
+        std::vector<std::string> names = {"A", "B", "C", "D", "E", "F"};
+        Game::PlayerList a = first.setup(names);
+        Game::PlayerList b = second.setup(names);
+
+        std::vector<std::string> roles;
+        for (size_t i = 0; i < a.size(); ++i) {
+            CHECK(a[i]->getRoleName() == b[i]->getRoleName());
+            roles.push_back(a[i]->getRoleName());
+        }
+        std::sort(roles.begin(), roles.end());
+        CHECK(std::unique(roles.begin(), roles.end()) == roles.end());
+    }
+
+    SUBCASE("Invalid tables are rejected without side effects") {
+        Game game;
+        CHECK_THROWS_AS(game.setup({"Solo"}), std::runtime_error);
+        CHECK_THROWS_AS(game.setup({"A", "B", "C", "D", "E", "F", "G"}), std::runtime_error);
+        CHECK_THROWS_AS(game.setup({"Alice", "Alice"}), std::runtime_error);
+        CHECK_THROWS_AS(game.setup({"Alice", ""}), std::runtime_error);
+        CHECK_THROWS_AS(game.setup({"Alice", "Bob"}, {Role::Judge}), std::runtime_error);
+        CHECK(game.players().empty());
+    }
+
+    SUBCASE("Setup requires an empty game") {
+        Game game;
+        game.setup({"Alice", "Bob"});
+        CHECK_THROWS_AS(game.setup({"Carol", "Dave"}), std::runtime_error);
+        game.resetGame();
+        CHECK_NOTHROW(game.setup({"Carol", "Dave"}));
+    }
+}
+
+// ==========================================
+// HEADLESS SIMULATION VERIFICATION
+// ==========================================
+
+TEST_CASE("Headless Simulation Is Reproducible") {
+    SUBCASE("Same seed replays the same game") {
+        GameResult first = Simulator::runGame(77, 4);
+        GameResult second = Simulator::runGame(77, 4);
+        CHECK(first.turns == second.turns);
+        CHECK(first.winner == second.winner);
+        CHECK(first.winnerRole == second.winnerRole);
+    }
+
+    SUBCASE("Games finish within the turn cap") {
+        for (std::size_t players = 2; players <= Game::MAX_PLAYERS; ++players) {
+            GameResult result = Simulator::runGame(players, players);
+            CHECK(result.finished);
+            CHECK(result.turns <= Simulator::DEFAULT_MAX_TURNS);
+            CHECK_FALSE(result.winner.empty());
+        }
+    }
+
+    SUBCASE("Invalid table sizes are rejected") {
+        CHECK_THROWS_AS(Simulator::runGame(1, 1), std::runtime_error);
+        CHECK_THROWS_AS(Simulator::runGame(1, 7), std::runtime_error);
+    }
+}
+
+// ==========================================
+// TRACE SPAN VERIFICATION
+// ==========================================
+
+TEST_CASE("Trace Spans Export Chrome JSON") {
+    Tracer::clear();
+    Game game;
+    game.setConsoleMode(false);
+    Judge judge(game, "Judge");
+    Governor governor(game, "Governor");
+
+    SUBCASE("Nothing is recorded while disabled") {
+        judge.gather();
+        game.checkForBlocking(&judge, ActionType::Tax);
+        CHECK(Tracer::eventCount() == 0);
+    }
+
+    SUBCASE("Actions and block checks become spans") {
+        Tracer::setEnabled(true);
+        judge.tax();
+        CHECK_THROWS(governor.gather());
+        Tracer::setEnabled(false);
+
+        std::ostringstream out;
+        Tracer::writeChromeTrace(out);
+        std::string json = out.str();
+        CHECK(Tracer::eventCount() == 3);
+        CHECK(json.find("\"traceEvents\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"Player::tax\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"Game::checkForBlocking\"") != std::string::npos);
+        CHECK(json.find("\"outcome\":\"not_your_turn\"") != std::string::npos);
+        CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    }
+
+    Tracer::setEnabled(false);
+    Tracer::clear();
+}
+
+// ==========================================
+// METRICS REGISTRY AND EXPORTER VERIFICATION
+// ==========================================
+
+namespace {
+    std::string httpGet(int port, const std::string &path) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        std::string response;
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+            std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+            ::send(fd, request.data(), request.size(), 0);
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                response.append(buffer, static_cast<std::size_t>(n));
+            }
+        }
+        ::close(fd);
+        return response;
+    }
+}
+
+TEST_CASE("Metrics Registry Exports Prometheus Text") {
+    SUBCASE("Counters, gauges and histograms use the exposition format") {
+        MetricsRegistry registry;
+        registry.counter("test_events_total", "Events seen", "kind=\"a\"").inc(3);
+        registry.counter("test_events_total", "Events seen", "kind=\"b\"").inc();
+        registry.gauge("test_level", "Current level").set(2.5);
+        Histogram &h = registry.histogram("test_seconds", "Durations", {0.1, 1});
+        h.observe(0.05);
+        h.observe(0.5);
+        h.observe(5);
+
+        CHECK(&registry.counter("test_events_total", "Events seen", "kind=\"a\"") ==
+              &registry.counter("test_events_total", "Events seen", "kind=\"a\""));
+        CHECK_THROWS(registry.gauge("test_events_total", "Wrong type"));
+
+        std::string text = registry.renderPrometheus();
+        CHECK(text.find("# TYPE test_events_total counter\n") != std::string::npos);
+        CHECK(text.find("test_events_total{kind=\"a\"} 3\n") != std::string::npos);
+        CHECK(text.find("test_events_total{kind=\"b\"} 1\n") != std::string::npos);
+        CHECK(text.find("test_level 2.5\n") != std::string::npos);
+        CHECK(text.find("test_seconds_bucket{le=\"0.1\"} 1\n") != std::string::npos);
+        CHECK(text.find("test_seconds_bucket{le=\"1\"} 2\n") != std::string::npos);
+        CHECK(text.find("test_seconds_bucket{le=\"+Inf\"} 3\n") != std::string::npos);
+        CHECK(text.find("test_seconds_count 3\n") != std::string::npos);
+        // One HELP/TYPE header per family
+        CHECK(text.find("# TYPE test_events_total") == text.rfind("# TYPE test_events_total"));
+    }
+
+    SUBCASE("Engine reports games, bank coins and actions") {
+        EngineMetrics &engine = EngineMetrics::get();
+        engine.collect();
+        double activeBefore = engine.gamesActive.get();
+        double bankBefore = engine.bankCoins.get();
+        std::uint64_t gathersBefore = engine.actionsAttempted[static_cast<int>(ActionType::Gather)]->get();
+        std::uint64_t rejectedBefore = engine.actionsRejected[static_cast<int>(RejectReason::NotYourTurn)]->get();
+        {
+            Game game;
+            game.setConsoleMode(false);
+            Governor governor(game, "Governor");
+            Spy spy(game, "Spy");
+            engine.collect();
+            CHECK(engine.gamesActive.get() == doctest::Approx(activeBefore + 1));
+            CHECK(engine.bankCoins.get() == doctest::Approx(bankBefore + 200));
+
+            governor.gather();
+            CHECK_THROWS(spy.gather());
+            engine.collect();
+            CHECK(engine.bankCoins.get() == doctest::Approx(bankBefore + 199));
+            CHECK(engine.coinsInCirculation.get() >= 1);
+        }
+        // A game on another thread counts into that thread's shard
+        std::thread other([] {
+            Game game;
+            game.setConsoleMode(false);
+            Governor governor(game, "Governor");
+            Spy spy(game, "Spy");
+            governor.gather();
+        });
+        other.join();
+        engine.collect();
+        CHECK(engine.gamesActive.get() == doctest::Approx(activeBefore));
+        CHECK(engine.bankCoins.get() == doctest::Approx(bankBefore));
+        CHECK(engine.actionsAttempted[static_cast<int>(ActionType::Gather)]->get() == gathersBefore + 3);
+        CHECK(engine.totalActions() >= gathersBefore + 3);
+        CHECK(engine.actionsRejected[static_cast<int>(RejectReason::NotYourTurn)]->get() == rejectedBefore + 1);
+    }
+
+    SUBCASE("Exporter serves HTTP and writes snapshot files") {
+        MetricsExporter exporter;
+        exporter.serveHttp(0);
+        REQUIRE(exporter.getPort() > 0);
+
+        std::string response = httpGet(exporter.getPort(), "/metrics");
+        CHECK(response.find("HTTP/1.1 200 OK") == 0);
+        CHECK(response.find("# TYPE coup_games_active gauge") != std::string::npos);
+        CHECK(response.find("coup_actions_per_second") != std::string::npos);
+        CHECK(httpGet(exporter.getPort(), "/other").find("404") != std::string::npos);
+
+        std::string path = "metrics_snapshot_test.prom";
+        exporter.writeFile(path, 60);
+        exporter.stop();
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        CHECK(content.str().find("coup_bank_coins") != std::string::npos);
+        std::remove(path.c_str());
+    }
+}
+
+// ==========================================
+// CHANGE EVENT VERIFICATION
+// ==========================================
+
+namespace {
+    struct EventRecorder : GameObserver {
+        std::vector<GameEvent> events;
+
+        void onGameEvent(Game &, const GameEvent &event) override {
+            events.push_back(event);
+        }
+
+        int count(GameEventType type) const {
+            return static_cast<int>(std::count_if(events.begin(), events.end(),
+                [type](const GameEvent &e) { return e.type == type; }));
+        }
+    };
+}
+
+TEST_CASE("Game Publishes Change Events") {
+    Game game;
+    game.setConsoleMode(false);
+    EventRecorder recorder;
+    game.subscribe(&recorder);
+    game.subscribe(&recorder);  // duplicate subscriptions are ignored
+
+    Spy spy(game, "Spy");
+    Baron baron(game, "Baron");
+    CHECK(recorder.count(GameEventType::PlayerJoined) == 2);
+
+    SUBCASE("Coins, turns and pending actions") {
+        recorder.events.clear();
+        spy.gather();
+        REQUIRE(recorder.events.size() == 2);
+        CHECK(recorder.events[0].type == GameEventType::CoinsChanged);
+        CHECK(recorder.events[0].player == &spy);
+        CHECK(recorder.events[0].oldValue == 0);
+        CHECK(recorder.events[0].newValue == 1);
+        CHECK(recorder.events[1].type == GameEventType::PendingActionSet);
+        CHECK(recorder.events[1].action == ActionType::Gather);
+
+        spy.endTurn();
+        CHECK(recorder.count(GameEventType::PendingActionResolved) == 1);
+        CHECK(recorder.events.back().type == GameEventType::TurnAdvanced);
+        CHECK(recorder.events.back().player == &baron);
+    }
+
+    SUBCASE("Sanction and arrest status") {
+        spy.setCoins(5);
+        baron.setCoins(3);
+        recorder.events.clear();
+        spy.sanction(baron);
+        CHECK(recorder.count(GameEventType::SanctionChanged) == 1);
+        spy.endTurn();
+
+        baron.endTurn();
+        CHECK(recorder.count(GameEventType::SanctionChanged) == 2);  // cleared at end of turn
+
+        recorder.events.clear();
+        spy.arrest(baron);
+        CHECK(recorder.count(GameEventType::ArrestStatusChanged) == 1);
+        CHECK(recorder.count(GameEventType::CoinsChanged) == 2);
+    }
+
+    SUBCASE("Elimination ends the game") {
+        spy.setCoins(7);
+        recorder.events.clear();
+        spy.coup(baron);
+        CHECK(recorder.count(GameEventType::PlayerEliminated) == 1);
+        REQUIRE(recorder.count(GameEventType::GameOver) == 1);
+        auto over = std::find_if(recorder.events.begin(), recorder.events.end(),
+            [](const GameEvent &e) { return e.type == GameEventType::GameOver; });
+        CHECK(over->player == &spy);
+    }
+
+    SUBCASE("Unsubscribed observers hear nothing") {
+        game.unsubscribe(&recorder);
+        CHECK_FALSE(game.hasObservers());
+        recorder.events.clear();
+        spy.gather();
+        CHECK(recorder.events.empty());
+    }
+
+    CHECK(std::string(gameEventName(GameEventType::CoinsChanged)) == "coins_changed");
+}
+
+// ==========================================
+// SPECTATOR STREAM VERIFICATION
+// ==========================================
+
+namespace {
+    struct FrameRecorder : SpectatorSink {
+        std::vector<SpectatorFrame> frames;
+        SpectatorState state;
+        int rejected = 0;
+
+        void deliver(const SpectatorFrame &frame) override {
+            frames.push_back(frame);
+            if (!state.apply(frame->data(), frame->size())) {
+                ++rejected;
+            }
+        }
+    };
+
+    std::vector<std::uint8_t> keyframeOf(const SpectatorState &state) {
+        std::vector<std::uint8_t> frame;
+        state.writeKeyframe(frame, state.sequence);
+        return frame;
+    }
+
+    void playGatherTurns(Game &game, int turns) {
+        for (int i = 0; i < turns; ++i) {
+            Player *current = game.getCurrentPlayer();
+            current->gather();
+            current->endTurn();
+        }
+    }
+
+    int connectSpectator(const std::string &path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        REQUIRE(::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+        timeval timeout{2, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return fd;
+    }
+
+    // Applies frames from a spectator socket until the state reaches a sequence
+    void receiveUntil(int fd, SpectatorState &state, std::uint64_t sequence) {
+        std::vector<std::uint8_t> buffer;
+        std::uint8_t chunk[512];
+        while (state.sequence != sequence) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            REQUIRE(n > 0);
+            buffer.insert(buffer.end(), chunk, chunk + n);
+            std::size_t size;
+            while ((size = SpectatorState::frameSize(buffer.data(), buffer.size())) > 0) {
+                state.apply(buffer.data(), size);
+                buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size));
+            }
+        }
+    }
+}
+
+TEST_CASE("Spectator Stream Mirrors The Game") {
+    Game game;
+    game.setConsoleMode(false);
+    FrameRecorder early;
+    FrameRecorder second;
+    FrameRecorder late;
+    SpectatorBroadcaster broadcaster(4);
+    broadcaster.addSink(&early);
+    broadcaster.attach(game);
+
+    Spy spy(game, "Spy");
+    Baron baron(game, "Baron");
+
+    SUBCASE("Deltas reproduce the table") {
+        spy.gather();
+        spy.endTurn();
+        baron.tax();
+        baron.endTurn();
+        spy.setCoins(7);
+        spy.coup(baron);
+        broadcaster.flush();  // changes recorded after the game-over frame
+
+        CHECK(early.rejected == 0);
+        REQUIRE(early.state.seats.size() == 2);
+        CHECK(early.state.seats[0].name == "Spy");
+        CHECK(early.state.seats[0].role == "Spy");
+        CHECK(early.state.seats[1].role == "Baron");
+        CHECK(early.state.seats[0].coins == spy.getCoins());
+        CHECK(early.state.seats[1].coins == baron.getCoins());
+        CHECK_FALSE(early.state.seats[1].alive);
+        CHECK(early.state.winnerSeat == 0);
+        CHECK(keyframeOf(early.state) == keyframeOf(broadcaster.state()));
+    }
+
+    SUBCASE("Frames are encoded once and keyframes recur") {
+        playGatherTurns(game, 1);
+        broadcaster.addSink(&second);
+        REQUIRE(second.frames.size() == 1);
+        CHECK(isKeyframe(*second.frames[0]));
+
+        playGatherTurns(game, 8);
+        CHECK(second.rejected == 0);
+        CHECK(early.frames.back().get() == second.frames.back().get());  // same buffer
+        CHECK(keyframeOf(second.state) == keyframeOf(early.state));
+
+        std::size_t keyframes = 0;
+        std::size_t largestDelta = 0;
+        for (const SpectatorFrame &frame : early.frames) {
+            if (isKeyframe(*frame)) {
+                ++keyframes;
+            } else {
+                largestDelta = std::max(largestDelta, frame->size());
+            }
+        }
+        CHECK(keyframes >= 3);  // the opening one and one every 4 frames
+        CHECK(largestDelta < keyframeOf(early.state).size());
+        broadcaster.removeSink(&second);
+    }
+
+    SUBCASE("Late joiners sync from a keyframe, missed deltas are refused") {
+        playGatherTurns(game, 3);
+        broadcaster.addSink(&late);
+        REQUIRE(late.frames.size() == 1);
+        CHECK(late.state.synced);
+        CHECK(late.state.seats.size() == 2);
+        CHECK(late.state.seats[0].coins == spy.getCoins());
+
+        auto delta = std::find_if(early.frames.begin(), early.frames.end(),
+            [](const SpectatorFrame &frame) { return !isKeyframe(*frame); });
+        REQUIRE(delta != early.frames.end());
+        SpectatorState fresh;
+        CHECK_FALSE(fresh.apply((*delta)->data(), (*delta)->size()));
+
+        std::vector<std::uint8_t> truncated = **delta;
+        truncated.resize(6);
+        truncated[0] = 2;
+        CHECK_THROWS(fresh.apply(truncated.data(), truncated.size()));
+        broadcaster.removeSink(&late);
+    }
+
+    SUBCASE("Socket spectators receive the shared stream") {
+        std::string path = "/tmp/coup_spectator_test_" + std::to_string(::getpid()) + ".sock";
+        SpectatorServer server;
+        server.listen(path);
+
+        std::vector<int> fds;
+        for (int i = 0; i < 3; ++i) {
+            fds.push_back(connectSpectator(path));
+        }
+        for (int wait = 0; wait < 200 && server.spectatorCount() < 3; ++wait) {
+            ::usleep(10000);
+        }
+        REQUIRE(server.spectatorCount() == 3);
+
+        broadcaster.addSink(&server);
+        playGatherTurns(game, 6);
+
+        for (int fd : fds) {
+            SpectatorState state;
+            receiveUntil(fd, state, broadcaster.getSequence());
+            CHECK(keyframeOf(state) == keyframeOf(broadcaster.state()));
+            ::close(fd);
+        }
+        CHECK(server.getBytesSent() > 0);
+        broadcaster.removeSink(&server);
+        server.stop();
+    }
+
+    SUBCASE("Frames delivered while not listening reach later spectators") {
+        std::string path = "/tmp/coup_spectator_early_" + std::to_string(::getpid()) + ".sock";
+        SpectatorServer server;
+        broadcaster.addSink(&server);
+        playGatherTurns(game, 3);  // queued before listen()
+
+        for (int round = 0; round < 2; ++round) {
+            server.listen(path);
+            int fd = connectSpectator(path);
+            SpectatorState state;
+            receiveUntil(fd, state, broadcaster.getSequence());
+            CHECK(keyframeOf(state) == keyframeOf(broadcaster.state()));
+            ::close(fd);
+            // Frames left in the inbox by stop() must not keep the next listen() asleep
+            playGatherTurns(game, 2);
+            server.stop();
+            playGatherTurns(game, 2);
+            broadcaster.sendKeyframe();  // stop() forgets the stream, so the next one starts from a keyframe
+        }
+        broadcaster.removeSink(&server);
+    }
+
+    SUBCASE("A failed listen leaves no socket or pipe behind") {
+        std::string path = "/tmp/coup_spectator_fail_" + std::to_string(::getpid()) + ".sock";
+        SpectatorServer server;
+        CHECK_THROWS(server.listen("/tmp/coup_no_such_dir_" + std::to_string(::getpid()) + "/s.sock"));
+        server.listen(path);
+        CHECK(::access(path.c_str(), F_OK) == 0);
+        server.stop();
+        CHECK(::access(path.c_str(), F_OK) != 0);
+    }
+
+    broadcaster.detach();
+}
+
+// ==========================================
+// WRITE-AHEAD LOG RECOVERY
+// ==========================================
+
+namespace {
+    std::string walPath(const char *name) {
+        return "/tmp/coup_test_" + std::string(name) + "_" + std::to_string(::getpid()) + ".wal";
+    }
+
+    void checkRecoveredTable(SimulatedGame &original, const RecoveredGame &recovered) {
+        const Game::PlayerList &table = original.getTable();
+        REQUIRE(recovered.table.size() == table.size());
+        for (std::size_t seat = 0; seat < table.size(); ++seat) {
+            CHECK(recovered.table[seat]->getName() == table[seat]->getName());
+            CHECK(recovered.table[seat]->getRoleName() == table[seat]->getRoleName());
+            CHECK(recovered.table[seat]->getCoins() == table[seat]->getCoins());
+            CHECK(recovered.table[seat]->isSanctioned() == table[seat]->isSanctioned());
+            CHECK(recovered.game->isAlive(*recovered.table[seat]) == original.getGame().isAlive(*table[seat]));
+        }
+        CHECK(recovered.game->turn() == original.getGame().turn());
+        CHECK(recovered.game->getBankCoins() == original.getGame().getBankCoins());
+    }
+}
+
+TEST_CASE("Write-Ahead Log Recovers In-Flight Games") {
+    std::string path = walPath("recover");
+    std::remove(path.c_str());
+
+    WriteAheadLog log(path);
+    WalGameWriter firstWriter(log);
+    WalGameWriter secondWriter(log);
+    WalGameWriter endedWriter(log);
+    SimulatedGame first(11, 4, Simulator::DEFAULT_MAX_TURNS, nullptr, &firstWriter);
+    SimulatedGame second(12, 6, Simulator::DEFAULT_MAX_TURNS, nullptr, &secondWriter);
+    SimulatedGame ended(13, 2, Simulator::DEFAULT_MAX_TURNS, nullptr, &endedWriter);
+    for (int turn = 0; turn < 12; ++turn) {
+        first.step();
+        second.step();
+        ended.step();
+    }
+    ended.finish();
+    REQUIRE_FALSE(first.getGame().isGameOver());
+    REQUIRE_FALSE(second.getGame().isGameOver());
+    log.sync();
+
+    SUBCASE("In-flight games are rebuilt by replaying the log") {
+        WalRecovery recovery = WriteAheadLog::recover(path);
+        REQUIRE(recovery.games.size() == 2);
+        CHECK(recovery.endedGames == 1);
+        CHECK(recovery.failedGames == 0);
+        CHECK(recovery.tornBytes == 0);
+        CHECK(recovery.nextGameId == 4);
+        CHECK(recovery.games[0].gameId == firstWriter.getGameId());
+        CHECK(recovery.games[1].gameId == secondWriter.getGameId());
+        CHECK(recovery.games[0].replayed > 24);
+        checkRecoveredTable(first, recovery.games[0]);
+        checkRecoveredTable(second, recovery.games[1]);
+
+        // Policies are detached and the recovered game plays on
+        for (Player *player : recovery.games[0].table) {
+            CHECK(player->getDecisionPolicy() == nullptr);
+        }
+        CHECK(Simulator::playTurn(*recovery.games[0].game, BotStyle::Random));
+
+        WalStats stats = log.getStats();
+        CHECK(stats.records == recovery.records);
+        CHECK(stats.durableBytes == recovery.validBytes);
+        CHECK(stats.logBytes > stats.logicalBytes);
+        CHECK(stats.commits >= 1);
+    }
+
+    SUBCASE("A torn tail is cut off and appends continue after the intact prefix") {
+        {
+            std::ofstream torn(path, std::ios::binary | std::ios::app);
+            torn.write("\x40\x00\x00\x00\x12\x34", 6);  // header of a record the crash cut short
+        }
+        WalRecovery recovery = WriteAheadLog::recover(path);
+        CHECK(recovery.tornBytes == 6);
+        CHECK(recovery.games.size() == 2);
+
+        WalRecovery again = WriteAheadLog::recover(path);
+        CHECK(again.tornBytes == 0);
+        CHECK(again.validBytes == recovery.validBytes);
+
+        {
+            WriteAheadLog reopened(path, again.nextGameId);
+            WalGameWriter writer(reopened);
+            SimulatedGame third(14, 3, Simulator::DEFAULT_MAX_TURNS, nullptr, &writer);
+            third.step();
+            reopened.sync();
+            CHECK(writer.getGameId() == 4);
+        }
+        WalRecovery after = WriteAheadLog::recover(path);
+        CHECK(after.tornBytes == 0);
+        CHECK(after.games.size() == 3);
+        CHECK(after.failedGames == 0);
+    }
+
+    SUBCASE("A corrupted record ends the log") {
+        std::size_t size;
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            size = static_cast<std::size_t>(in.tellg());
+        }
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(static_cast<std::streamoff>(size - 1));
+            file.put('\x7f');  // last byte of the ended game's End record
+        }
+        WalRecovery recovery = WriteAheadLog::recover(path, false);
+        CHECK(recovery.tornBytes > 0);
+        CHECK(recovery.validBytes + recovery.tornBytes == size);
+        CHECK(recovery.endedGames == 0);
+        CHECK(recovery.games.size() == 3);  // the game whose End was lost is in flight again
+    }
+
+    SUBCASE("A missing log recovers nothing") {
+        WalRecovery recovery = WriteAheadLog::recover(walPath("missing"));
+        CHECK(recovery.games.empty());
+        CHECK(recovery.nextGameId == 1);
+    }
+
+    std::remove(path.c_str());
+}
+
+// ==========================================
+// GAME SNAPSHOTS
+// ==========================================
+
+namespace {
+    void playBotTurns(Game &game, int turns) {
+        for (int i = 0; i < turns && !game.isGameOver(); ++i) {
+            Simulator::playTurn(game, Simulator::styleForSeat(static_cast<std::size_t>(i)));
+        }
+    }
+
+    bool sameSnapshot(const GameSnapshot &a, const GameSnapshot &b) {
+        return std::memcmp(&a, &b, sizeof(GameSnapshot)) == 0;
+    }
+
+    std::string tempDataPath(const char *name, const char *extension) {
+        return "/tmp/coup_test_" + std::string(name) + "_" + std::to_string(::getpid()) + extension;
+    }
+
+    // Shared by the binary file formats: a foreign header and a missing file are both refused
+    template <typename Open>
+    void checkRejectsForeignAndMissingFiles(const std::string &path, Open open) {
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << "definitely not a coup data file header";
+        }
+        CHECK_THROWS_AS(open(path), std::runtime_error);
+        std::remove(path.c_str());
+        CHECK_THROWS_AS(open(path), std::runtime_error);
+    }
+
+    void patchFile(const std::string &path, std::streamoff offset, const void *bytes, std::size_t size) {
+        std::fstream patch(path, std::ios::in | std::ios::out | std::ios::binary);
+        patch.seekp(offset);
+        patch.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+    }
+}
+
+TEST_CASE("Game Snapshots Save And Load") {
+    Game original(21);
+    original.setConsoleMode(false);
+    Game::PlayerList table = original.setup({"Ana", "Ben", "Cy", "Dee", "Eve"});
+    playBotTurns(original, 40);
+    REQUIRE_FALSE(original.isGameOver());
+    REQUIRE(original.aliveCount() < table.size());  // eliminated seats are saved too
+
+    GameSnapshot saved;
+    original.saveSnapshot(saved);
+    CHECK(saved.playerCount == 5);
+    CHECK(saved.rngPosition == original.getRng().getPosition());
+    CHECK(saved.aliveCount() == original.aliveCount());
+
+    SUBCASE("A loaded game matches and plays on identically") {
+        Game restored(99);
+        restored.setConsoleMode(false);
+        Game::PlayerList seats = restored.loadSnapshot(saved);
+        REQUIRE(seats.size() == table.size());
+        for (std::size_t seat = 0; seat < seats.size(); ++seat) {
+            CHECK(seats[seat]->getName() == table[seat]->getName());
+            CHECK(seats[seat]->getRoleName() == table[seat]->getRoleName());
+            CHECK(seats[seat]->getCoins() == table[seat]->getCoins());
+            CHECK(seats[seat]->isSanctioned() == table[seat]->isSanctioned());
+            CHECK(seats[seat]->getArrestStatus() == table[seat]->getArrestStatus());
+            CHECK(seats[seat]->getLastAction() == table[seat]->getLastAction());
+            CHECK(restored.isAlive(*seats[seat]) == original.isAlive(*table[seat]));
+        }
+        CHECK(restored.turn() == original.turn());
+        CHECK(restored.getBankCoins() == original.getBankCoins());
+        CHECK_FALSE(restored.getConsoleMode());
+
+        GameSnapshot again;
+        restored.saveSnapshot(again);
+        CHECK(sameSnapshot(saved, again));
+
+        // The random stream resumes where it was saved, so bots make the same moves
+        playBotTurns(original, 30);
+        playBotTurns(restored, 30);
+        GameSnapshot left;
+        GameSnapshot right;
+        original.saveSnapshot(left);
+        restored.saveSnapshot(right);
+        CHECK(sameSnapshot(left, right));
+    }
+
+    SUBCASE("A snapshot file is read in place") {
+        std::string path = tempDataPath("snapshots", ".bin");
+        std::vector<GameSnapshot> expected;
+        {
+            SnapshotWriter writer(path);
+            for (int i = 0; i < 20 && !original.isGameOver(); ++i) {
+                playBotTurns(original, 1);
+                expected.emplace_back();
+                original.saveSnapshot(expected.back());
+                writer.append(original);
+            }
+            CHECK(writer.size() == expected.size());
+            writer.close();
+        }
+
+        SnapshotFile file(path);
+        REQUIRE(file.size() == expected.size());
+        CHECK(reinterpret_cast<std::uintptr_t>(&file[0]) % alignof(GameSnapshot) == 0);
+        std::size_t index = 0;
+        for (const GameSnapshot &snapshot : file) {
+            CHECK(sameSnapshot(snapshot, expected[index++]));
+        }
+        CHECK_THROWS_AS(file.at(file.size()), std::runtime_error);
+
+        Game loaded;
+        loaded.setConsoleMode(false);
+        loaded.loadSnapshot(file[file.size() - 1]);
+        CHECK(loaded.turn() == original.turn());
+
+        SnapshotFile moved(std::move(file));
+        CHECK(moved.size() == expected.size());
+        CHECK(file.empty());
+        std::remove(path.c_str());
+    }
+
+    SUBCASE("Malformed snapshots and files are rejected") {
+        Game target;
+        target.setConsoleMode(false);
+
+        GameSnapshot bad = saved;
+        bad.magic = 0;
+        CHECK_THROWS_AS(target.loadSnapshot(bad), std::runtime_error);
+        bad = saved;
+        bad.version = SNAPSHOT_VERSION + 1;
+        CHECK_THROWS_AS(target.loadSnapshot(bad), std::runtime_error);
+        bad = saved;
+        bad.players[1].lastActionTarget = 5;
+        CHECK_THROWS_AS(target.loadSnapshot(bad), std::runtime_error);
+        bad = saved;
+        bad.players[0].role = ROLE_COUNT;
+        CHECK_THROWS_AS(target.loadSnapshot(bad), std::runtime_error);
+
+        Game longNames;
+        longNames.setConsoleMode(false);
+        longNames.setup({"A name that is far too long", "Bo"});
+        GameSnapshot snapshot;
+        CHECK_THROWS_AS(longNames.saveSnapshot(snapshot), std::runtime_error);
+
+        checkRejectsForeignAndMissingFiles(tempDataPath("not_snapshots", ".bin"),
+                                           [](const std::string &path) { return SnapshotFile(path); });
+    }
+
+    SUBCASE("A file of another snapshot version is rejected") {
+        std::string path = tempDataPath("old_snapshots", ".bin");
+        {
+            SnapshotWriter writer(path);
+            writer.append(original);
+            writer.close();
+        }
+        CHECK(SnapshotFile(path).size() == 1);
+        std::uint16_t version = SNAPSHOT_VERSION + 1;
+        patchFile(path, 8, &version, sizeof(version));  // after the 8-byte file magic
+        CHECK_THROWS_AS(SnapshotFile{path}, std::runtime_error);
+        std::remove(path.c_str());
+    }
+}
+
+// ==========================================
+// POSITION STORE
+// ==========================================
+
+TEST_CASE("Position Store Indexes Simulated Positions") {
+    std::string path = tempDataPath("positions", ".db");
+    GameResult result;
+    {
+        PositionStore store = PositionStore::create(path, 4096);
+        result = Simulator::runGame(31, 4, Simulator::DEFAULT_MAX_TURNS, nullptr, nullptr, &store);
+        REQUIRE(result.finished);
+        REQUIRE(store.size() == static_cast<std::uint64_t>(result.turns) + 1);  // the start position too
+        CHECK(store.capacity() == 4096);
+
+        for (std::uint64_t i = 0; i < store.size(); ++i) {
+            REQUIRE(store.published(i));
+            const PositionRecord &record = store[i];
+            CHECK(record.ply == i);
+            CHECK(record.key == positionKey(record.position));
+            CHECK(record.gameId == store[0].gameId);
+            CHECK(record.winnerSeat < 4);
+            CHECK(record.position.players[record.winnerSeat].getName() == result.winner);
+
+            // Every position is found through the index
+            bool found = false;
+            for (std::uint64_t match = store.lookup(record.key); match != POSITION_NONE;
+                 match = store.nextWithKey(match)) {
+                CHECK(store[match].key == record.key);
+                found = found || match == i;
+            }
+            CHECK(found);
+        }
+        store.sync();
+    }
+
+    SUBCASE("Keys ignore names and the random stream but not game state") {
+        PositionStore store = PositionStore::open(path);
+        GameSnapshot renamed = store[5].position;
+        renamed.players[0].name[0] = 'Q';
+        renamed.seed ^= 1;
+        renamed.rngPosition += 7;
+        CHECK(positionKey(renamed) == store[5].key);
+        renamed.players[0].coins += 1;
+        CHECK(positionKey(renamed) != store[5].key);
+        CHECK(store.lookup(positionKey(renamed)) == POSITION_NONE);
+    }
+
+    SUBCASE("A reopened store loads positions and rejects appends") {
+        PositionStore store = PositionStore::open(path);
+        REQUIRE(store.size() == static_cast<std::uint64_t>(result.turns) + 1);
+        Game loaded;
+        loaded.setConsoleMode(false);
+        loaded.loadSnapshot(store[store.size() - 1].position);
+        CHECK(loaded.isGameOver());
+        CHECK(loaded.winner() == result.winner);
+
+        GameSnapshot position = store[0].position;
+        CHECK_THROWS_AS(store.newGameId(), std::runtime_error);
+        CHECK_THROWS_AS(store.append(1, &position, 1, SNAPSHOT_NO_SEAT), std::runtime_error);
+
+        PositionStore moved(std::move(store));
+        CHECK(moved.size() == static_cast<std::uint64_t>(result.turns) + 1);
+    }
+
+    SUBCASE("Concurrent writers fill disjoint runs until the store is full") {
+        PositionStore store = PositionStore::open(path, true);
+        std::uint64_t before = store.size();
+        std::vector<std::thread> writers;
+        for (std::uint64_t w = 0; w < 4; ++w) {
+            writers.emplace_back([&store, w] {
+                for (std::uint64_t g = 0; g < 3; ++g) {
+                    Simulator::runGame(100 + w * 3 + g, 2 + static_cast<std::size_t>(g), Simulator::DEFAULT_MAX_TURNS,
+                                       nullptr, nullptr, &store);
+                }
+            });
+        }
+        for (std::thread &writer : writers) {
+            writer.join();
+        }
+        REQUIRE(store.size() > before);
+        for (std::uint64_t i = before; i < store.size(); ++i) {
+            REQUIRE(store.published(i));
+            CHECK(store[i].key == positionKey(store[i].position));
+            if (i > before && store[i].gameId == store[i - 1].gameId) {
+                CHECK(store[i].ply == store[i - 1].ply + 1);  // a game's positions stay contiguous
+            }
+        }
+
+        std::vector<GameSnapshot> tooMany(static_cast<std::size_t>(store.capacity() - store.size() + 1),
+                                          store[0].position);
+        CHECK_THROWS_AS(store.append(store.newGameId(), tooMany.data(), tooMany.size(), SNAPSHOT_NO_SEAT),
+                        std::runtime_error);
+        std::uint64_t size = store.size();
+        store.append(store.newGameId(), tooMany.data(), tooMany.size() - 1, SNAPSHOT_NO_SEAT);
+        CHECK(store.size() == store.capacity());
+        CHECK(store.size() == size + tooMany.size() - 1);
+    }
+
+    SUBCASE("Other files are rejected") {
+        std::string other = tempDataPath("not_positions", ".db");
+        checkRejectsForeignAndMissingFiles(other, [](const std::string &file) { return PositionStore::open(file); });
+        CHECK_THROWS_AS(PositionStore::create(other, 0), std::runtime_error);
+    }
+
+    SUBCASE("A cut-off record array or an impossible count is rejected") {
+        const off_t headerSize = 4096;
+        REQUIRE(::truncate(path.c_str(), headerSize + 3 * static_cast<off_t>(sizeof(PositionRecord)) + 5) == 0);
+        CHECK_THROWS_AS(PositionStore::open(path), std::runtime_error);
+
+        PositionStore::create(path, 16);
+        std::uint64_t count = 17;
+        patchFile(path, 48, &count, sizeof(count));  // Header::count
+        CHECK_THROWS_AS(PositionStore::open(path), std::runtime_error);
+    }
+
+    std::remove(path.c_str());
+}
+
+// ==========================================
+// REPLAY ENGINE
+// ==========================================
+
+TEST_CASE("Replay Engine Seeks Recorded Games") {
+    GameRecording recording;
+    SimulatedGame simulated(41, 5, Simulator::DEFAULT_MAX_TURNS, nullptr, &recording);
+    while (simulated.step()) {
+    }
+    const GameResult &result = simulated.finish();
+    REQUIRE(result.finished);
+    REQUIRE(recording.ended);
+    CHECK(recording.names.size() == 5);
+    CHECK(recording.seed == 41);
+
+    ReplayEngine engine(recording, 16);
+    REQUIRE(engine.size() > 100);
+    CHECK(engine.position() == engine.size());
+    CHECK(engine.turnCount() == static_cast<std::size_t>(result.turns));
+    CHECK(engine.checkpointCount() == engine.size() / 16 + 1);
+    CHECK(engine.getGame().isGameOver());
+    CHECK(engine.getGame().winner() == result.winner);
+    for (std::size_t seat = 0; seat < 5; ++seat) {
+        CHECK(engine.getTable()[seat]->getCoins() == simulated.getTable()[seat]->getCoins());
+        CHECK(engine.seatName(seat) == simulated.getTable()[seat]->getName());
+    }
+
+    SUBCASE("Every seek matches a sequential replay and costs fewer than K operations") {
+        ReplayEngine sequential(recording, 1);  // a checkpoint at every position
+        Rng rng(7);
+        std::vector<std::size_t> targets = {0, engine.size(), 1, 15, 16, 17, engine.size() - 1, 33, 32, 31};
+        for (int i = 0; i < 200; ++i) {
+            targets.push_back(static_cast<std::size_t>(rng.uniform(engine.size() + 1)));
+        }
+        for (std::size_t target : targets) {
+            engine.seek(target);
+            sequential.seek(target);
+            CHECK(engine.position() == target);
+            CHECK(engine.lastSeekCost() < engine.checkpointInterval());
+            CHECK(sequential.lastSeekCost() == 0);
+            GameSnapshot seeked;
+            GameSnapshot expected;
+            engine.getGame().saveSnapshot(seeked);
+            sequential.getGame().saveSnapshot(expected);
+            CHECK(std::memcmp(&seeked, &expected, sizeof(GameSnapshot)) == 0);
+        }
+
+        // Stepping forward one operation at a time replays just that operation
+        engine.seek(20);
+        engine.seek(21);
+        CHECK(engine.lastSeekCost() == 1);
+    }
+
+    SUBCASE("Turns start where the turn passes") {
+        for (std::size_t turn = 1; turn < engine.turnCount(); turn += 7) {
+            engine.seekTurn(turn);
+            std::size_t start = engine.position();
+            std::string mover = engine.getGame().turn();
+            CHECK(engine.turnStart(turn) == start);
+            CHECK(engine.turnAt(start) == turn);
+            engine.seek(start - 1);
+            CHECK(engine.getGame().turn() != mover);
+            CHECK(engine.turnAt(start - 1) == turn - 1);
+        }
+        engine.seekTurn(engine.turnCount());
+        CHECK(engine.position() == engine.size());
+        CHECK(engine.turnAt(0) == 0);
+        CHECK_THROWS_AS(engine.seekTurn(engine.turnCount() + 1), std::runtime_error);
+        CHECK_THROWS_AS(engine.seek(engine.size() + 1), std::runtime_error);
+        CHECK_THROWS_AS(ReplayEngine(recording, 0), std::runtime_error);
+    }
+
+    SUBCASE("Recordings round-trip through text files") {
+        std::string path = "/tmp/coup_test_recording_" + std::to_string(::getpid()) + ".txt";
+        recording.save(path);
+        GameRecording loaded = GameRecording::load(path);
+        CHECK(loaded.seed == recording.seed);
+        CHECK(loaded.names == recording.names);
+        CHECK(loaded.roles == recording.roles);
+        CHECK(loaded.winnerSeat == recording.winnerSeat);
+        CHECK(loaded.ended);
+        REQUIRE(loaded.entries.size() == recording.entries.size());
+        for (std::size_t i = 0; i < loaded.entries.size(); ++i) {
+            CHECK(loaded.entries[i].op == recording.entries[i].op);
+            CHECK(loaded.entries[i].actor == recording.entries[i].actor);
+            CHECK(loaded.entries[i].target == recording.entries[i].target);
+        }
+
+        {
+            std::ofstream out(path, std::ios::app);
+            out << "gather 0 -\n";  // nothing may follow the end
+        }
+        CHECK_THROWS_AS(GameRecording::load(path), std::runtime_error);
+        {
+            std::ofstream out(path);
+            out << "coup-recording 1\nseed 3\nseat Spy A\nseat Baron B\nfly 0 -\n";
+        }
+        CHECK_THROWS_AS(GameRecording::load(path), std::runtime_error);
+        std::remove(path.c_str());
+        CHECK_THROWS_AS(GameRecording::load(path), std::runtime_error);
+    }
+
+    SUBCASE("A recording the engine rejects is reported") {
+        GameRecording broken = recording;
+        broken.entries.insert(broken.entries.begin() + 1, JournalEntry{JournalOp::Coup, 0, 1});  // no coins yet
+        CHECK_THROWS_AS(ReplayEngine{broken}, std::runtime_error);
+    }
+}
+
+// ==========================================
+// COLUMNAR OUTCOMES
+// ==========================================
+
+TEST_CASE("Columnar Outcomes Round-Trip") {
+    std::vector<GameOutcome> outcomes(10);
+    for (std::size_t i = 0; i < outcomes.size(); ++i) {
+        GameRecording recording;
+        GameResult result = Simulator::runGame(100 + i, 2 + i % 5, Simulator::DEFAULT_MAX_TURNS, nullptr,
+                                               &recording, nullptr, &outcomes[i]);
+        const GameOutcome &outcome = outcomes[i];
+        REQUIRE(outcome.seed == 100 + i);
+        REQUIRE(outcome.playerCount == 2 + i % 5);
+        CHECK(outcome.turns == static_cast<std::uint32_t>(result.turns));
+        CHECK(outcome.coins.size() == outcome.turns * outcome.playerCount);
+        CHECK(outcome.winnerSeat == recording.winnerSeat);
+        if (result.finished) {
+            CHECK(recording.names[static_cast<std::size_t>(outcome.winnerSeat)] == result.winner);
+        }
+        for (std::size_t seat = 0; seat < outcome.playerCount; ++seat) {
+            CHECK(outcome.roles[seat] == recording.roles[seat]);
+        }
+
+        // The tally counts exactly the actions the journal (passed through it) heard
+        std::array<std::uint32_t, Game::MAX_PLAYERS * OUTCOME_ACTION_COUNT> journaled{};
+        for (const JournalEntry &entry : recording.entries) {
+            if (entry.op >= JournalOp::Gather && entry.op <= JournalOp::Invest) {
+                ++journaled[entry.actor * OUTCOME_ACTION_COUNT + static_cast<std::size_t>(entry.op) - 1];
+            }
+        }
+        CHECK(outcome.actions == journaled);
+        CHECK(outcome.actionCount(0, ActionType::None) == 0);
+    }
+
+    std::string path = tempDataPath("outcomes", ".out");
+    {
+        OutcomeWriter writer(path, 4);
+        for (const GameOutcome &outcome : outcomes) {
+            writer.append(outcome);
+        }
+        CHECK(writer.size() == outcomes.size());
+        writer.close();
+        CHECK_THROWS_AS(writer.append(outcomes[0]), std::runtime_error);
+    }
+
+    SUBCASE("Every row reads back from its group") {
+        OutcomeFile file(path);
+        REQUIRE(file.size() == outcomes.size());
+        REQUIRE(file.groupCount() == 3);
+        CHECK(file.groupRows(2) == 2);
+        CHECK(file.columnBytes(OutcomeColumn::Seed) == outcomes.size() * 8);
+        OutcomeBatch batch;
+        std::size_t next = 0;
+        for (std::size_t g = 0; g < file.groupCount(); ++g) {
+            file.readGroup(g, batch);
+            for (std::size_t i = 0; i < batch.rows; ++i, ++next) {
+                GameOutcome row = batch.row(i);
+                const GameOutcome &written = outcomes[next];
+                CHECK(row.seed == written.seed);
+                CHECK(row.playerCount == written.playerCount);
+                CHECK(row.winnerSeat == written.winnerSeat);
+                CHECK(row.turns == written.turns);
+                CHECK(row.coins == written.coins);
+                CHECK(row.actions == written.actions);
+                for (std::size_t seat = 0; seat < written.playerCount; ++seat) {
+                    CHECK(row.roles[seat] == written.roles[seat]);
+                }
+            }
+        }
+        CHECK(next == outcomes.size());
+        CHECK_THROWS_AS(file.readGroup(3, batch), std::runtime_error);
+
+        OutcomeFile moved(std::move(file));
+        CHECK(moved.size() == outcomes.size());
+    }
+
+    SUBCASE("A projection decodes only the columns asked for") {
+        OutcomeFile file(path);
+        OutcomeBatch batch;
+        file.readGroup(0, batch);
+        file.readGroup(1, batch, outcomeColumnBit(OutcomeColumn::Winner) | outcomeColumnBit(OutcomeColumn::Turns));
+        REQUIRE(batch.rows == 4);
+        CHECK(batch.seeds.empty());
+        CHECK(batch.coins.empty());
+        CHECK(batch.actions.empty());
+        REQUIRE(batch.winners.size() == 4);
+        CHECK(batch.winners[1] == outcomes[5].winnerSeat);
+        CHECK(batch.turns[3] == outcomes[7].turns);
+        CHECK_THROWS_AS(batch.row(0), std::runtime_error);
+        CHECK(std::string(outcomeColumnName(OutcomeColumn::PlayerCount)) == "player_count");
+    }
+
+    SUBCASE("A trailing group torn anywhere by a crash is dropped") {
+        // The same first eight rows alone end exactly where the third group starts
+        std::string prefix = tempDataPath("outcomes_prefix", ".out");
+        {
+            OutcomeWriter writer(prefix, 4);
+            for (std::size_t i = 0; i < 8; ++i) {
+                writer.append(outcomes[i]);
+            }
+            writer.close();
+        }
+        struct stat info{};
+        REQUIRE(::stat(prefix.c_str(), &info) == 0);
+        const off_t groupStart = info.st_size;
+        std::remove(prefix.c_str());
+        REQUIRE(::stat(path.c_str(), &info) == 0);
+        REQUIRE(info.st_size > groupStart);
+
+        for (off_t cut = info.st_size - 1; cut >= groupStart; --cut) {
+            REQUIRE(::truncate(path.c_str(), cut) == 0);
+            OutcomeFile file(path);
+            CHECK(file.groupCount() == 2);
+            CHECK(file.size() == 8);
+        }
+    }
+
+    SUBCASE("Damage other than a torn tail is reported") {
+        char magic = 'X';
+        patchFile(path, 32, &magic, 1);  // first group's magic
+        CHECK_THROWS_AS(OutcomeFile{path}, std::runtime_error);
+        checkRejectsForeignAndMissingFiles(path, [](const std::string &file) { return OutcomeFile(file); });
+
+        GameOutcome bad = outcomes[0];
+        bad.coins.push_back(1);  // not a whole turn
+        OutcomeWriter writer(path);
+        CHECK_THROWS_AS(writer.append(bad), std::runtime_error);
+        bad = outcomes[0];
+        bad.winnerSeat = bad.playerCount;
+        CHECK_THROWS_AS(writer.append(bad), std::runtime_error);
+    }
+    std::remove(path.c_str());
+}
+
+// ==========================================
+// ALLOCATION TRACKING VERIFICATION
+// (assertions are enforced by make test-allocs)
+// ==========================================
+
+TEST_CASE("Allocation Tracking Scopes") {
+    if (!AllocationTracker::isEnabled()) {
+        AllocationScope scope;
+        std::vector<int> values(100);
+        CHECK(values.size() == 100);
+        CHECK(scope.allocations() == 0);
+        CHECK(scope.bytes() == 0);
+        return;
+    }
+
+    SUBCASE("Counts allocations, bytes and live memory") {
+        AllocationScope scope;
+        std::vector<int> values(100);
+        CHECK(scope.allocations() == 1);
+        CHECK(scope.bytes() == 100 * sizeof(int));
+        CHECK(scope.liveBytes() == static_cast<std::int64_t>(100 * sizeof(int)));
+
+        std::vector<int>().swap(values);
+        CHECK(scope.deallocations() == 1);
+        CHECK(scope.liveBytes() == 0);
+        CHECK(scope.peakLiveBytes() == static_cast<std::int64_t>(100 * sizeof(int)));
+    }
+
+    SUBCASE("Nested scopes report only their own activity") {
+        AllocationScope outer;
+        std::vector<char> big(1000);
+        {
+            AllocationScope inner;
+            std::vector<char> small(10);
+            CHECK(inner.allocations() == 1);
+            CHECK(inner.peakLiveBytes() == 10);
+        }
+        CHECK(outer.allocations() == 2);
+        CHECK(outer.peakLiveBytes() >= 1000);
+    }
+
+    SUBCASE("Alive player queries do not allocate") {
+        Game game;
+        game.setConsoleMode(false);
+        Governor alice(game, "Alice");
+        Judge bob(game, "Bob");
+        Player* buffer[Game::MAX_PLAYERS];
+
+        AllocationScope scope;
+        std::size_t seen = 0;
+        for (Player* p : game.alivePlayers()) {
+            seen += p != nullptr;
+        }
+        CHECK(seen == 2);
+        CHECK(game.aliveCount() == 2);
+        CHECK(game.fillAlivePlayers(buffer, Game::MAX_PLAYERS) == 2);
+        CHECK(game.getAlivePlayerList().size() == 2);
+        CHECK(scope.allocations() == 0);
+
+        CHECK(game.getAllAlivePlayers().size() == 2);
+        CHECK(scope.allocations() == 1);
+    }
+}
+
+// ==========================================
+// DECISION POLICY VERIFICATION
+// ==========================================
+
+struct AlwaysBlock {
+    bool shouldBribe(Player&) const { return false; }
+    bool shouldBlock(Player&, ActionType, Player*, Player*) const { return true; }
+};
+
+struct NeverBlock {
+    bool shouldBribe(Player&) const { return false; }
+    bool shouldBlock(Player&, ActionType, Player*, Player*) const { return false; }
+};
+
+TEST_CASE("Decision Policies Drive Automated Blocking") {
+    Game game;
+    game.setConsoleMode(false);
+    Judge judge(game, "Judge");
+    Governor governor(game, "Governor");
+
+    SUBCASE("Players without a policy never block") {
+        CHECK(governor.getDecisionPolicy() == nullptr);
+        judge.tax();
+        CHECK(judge.getCoins() == 2);
+    }
+
+    SUBCASE("Blocking policy stops tax") {
+        StaticPolicy<AlwaysBlock> policy;
+        governor.setDecisionPolicy(&policy);
+        judge.tax();
+        CHECK(judge.getCoins() == 0);
+        CHECK(game.getBankCoins() == 200);
+    }
+
+    SUBCASE("Allowing policy lets tax through") {
+        StaticPolicy<NeverBlock> policy;
+        governor.setDecisionPolicy(&policy);
+        judge.tax();
+        CHECK(judge.getCoins() == 2);
+    }
+
+    SUBCASE("Policy can be detached") {
+        StaticPolicy<AlwaysBlock> policy;
+        governor.setDecisionPolicy(&policy);
+        governor.setDecisionPolicy(nullptr);
+        judge.tax();
+        CHECK(judge.getCoins() == 2);
+    }
+}
+
+// ==========================================
+// ACTION METRICS VERIFICATION
+// ==========================================
+
+TEST_CASE("Action Metrics Count Outcomes And Latency") {
+    Game game;
+    game.setConsoleMode(false);
+    Judge judge(game, "Judge");
+    Governor governor(game, "Governor");
+    Baron baron(game, "Baron");
+
+    SUBCASE("Success and rejection reasons are counted") {
+        judge.gather();
+        CHECK_THROWS(governor.gather());
+        judge.setCoins(0);
+        CHECK_THROWS(judge.coup(baron));
+
+        MetricsSnapshot snap = game.metricsSnapshot();
+        const ActionCounters &gather = snap.counters(ActionType::Gather);
+        CHECK(gather.attempted == 2);
+        CHECK(gather.succeeded == 1);
+        CHECK(gather.rejectedBy(RejectReason::NotYourTurn) == 1);
+        CHECK(snap.counters(ActionType::Coup).rejectedBy(RejectReason::NotEnoughCoins) == 1);
+        CHECK(snap.latency(ActionType::Gather).count == 1);
+        CHECK(snap.latency(ActionType::Coup).count == 0);
+    }
+
+    SUBCASE("Other exceptions are counted when the action ends") {
+        game.setBankCoins(0);
+        CHECK_THROWS_WITH(judge.gather(), "Not enough coins in the bank");
+
+        const ActionCounters &gather = game.metricsSnapshot().counters(ActionType::Gather);
+        CHECK(gather.attempted == 1);
+        CHECK(gather.succeeded == 0);
+        CHECK(gather.rejectedBy(RejectReason::Other) == 1);
+    }
+
+    SUBCASE("Blocks are attributed to the blocking role") {
+        StaticPolicy<AlwaysBlock> policy;
+        governor.setDecisionPolicy(&policy);
+        judge.tax();
+
+        MetricsSnapshot snap = game.metricsSnapshot();
+        const ActionCounters &tax = snap.counters(ActionType::Tax);
+        CHECK(tax.attempted == 1);
+        CHECK(tax.succeeded == 0);
+        CHECK(tax.blockedByRole(Role::Governor) == 1);
+        CHECK(tax.totalBlocked() == 1);
+        CHECK(tax.totalRejected() == 0);
+        CHECK(snap.blockResolution(ActionType::Tax).count == 1);
+    }
+
+    SUBCASE("Blocks through the role API are counted") {
+        judge.tax();
+        governor.blockTax(judge);
+        CHECK(judge.getCoins() == 0);
+
+        const ActionCounters &tax = game.metricsSnapshot().counters(ActionType::Tax);
+        CHECK(tax.succeeded == 1);
+        CHECK(tax.blockedByRole(Role::Governor) == 1);
+        CHECK(tax.totalBlocked() == 1);
+    }
+
+    SUBCASE("Reset clears everything") {
+        judge.gather();
+        game.resetMetrics();
+        MetricsSnapshot snap = game.metricsSnapshot();
+        CHECK(snap.counters(ActionType::Gather).attempted == 0);
+        CHECK(snap.latency(ActionType::Gather).count == 0);
+    }
+
+    SUBCASE("Histogram buckets and percentiles") {
+        for (std::uint64_t v = 0; v < 64; ++v) {
+            CHECK(HistogramSnapshot::bucketLowerBound(HistogramSnapshot::bucketFor(v)) <= v);
+        }
+        CHECK(HistogramSnapshot::bucketFor(1000000) > HistogramSnapshot::bucketFor(1000));
+        CHECK(HistogramSnapshot::bucketFor(~0ULL) == HistogramSnapshot::BUCKET_COUNT - 1);
+
+        LatencyHistogram histogram;
+        for (int i = 1; i <= 100; ++i) {
+            histogram.record(static_cast<std::uint64_t>(i) * 1000);
+        }
+        HistogramSnapshot snap = histogram.snapshot();
+        CHECK(snap.count == 100);
+        CHECK(snap.maxNs == 100000);
+        CHECK(snap.meanNs() == doctest::Approx(50500));
+        std::uint64_t median = snap.percentileNs(50);
+        CHECK(median >= 50000);
+        CHECK(median <= 50000 * 9 / 8);
+        CHECK(snap.percentileNs(100) == 100000);
+    }
+}
+
 // ==========================================
 // STRESS AND EDGE CASE TESTING
 // ==========================================
@@ -21,7 +21,7 @@ using namespace std;
 using namespace coup;
 
 // ==========================================
-// AUTOMATED DECISION CALLBACKS
+// AUTOMATED DECISION POLICY
 // ==========================================
 
 bool automatedBribeDecision(const Player& player) {
@@ -61,6 +61,16 @@ bool automatedBlockDecision(const Player& blocker, ActionType action, const Play
     return false;
 }
 
+// Stateless bot logic, compiled in through StaticPolicy
+struct AutomatedDecisions {
+    bool shouldBribe(Player& player) const {
+        return automatedBribeDecision(player);
+    }
+    bool shouldBlock(Player& blocker, ActionType action, Player* actor, Player* /* target */) const {
+        return automatedBlockDecision(blocker, action, actor);
+    }
+};
+
 // ==========================================
 // HELPER FUNCTIONS
 // ==========================================
@@ -122,7 +132,8 @@ void pauseForDemo() {
 }
 
 // Safe turn execution with error handling
-bool executeTurnSafely(Player* player, function<void()> action, const string& actionName) {
+template <typename Action>
+bool executeTurnSafely(Player* player, Action action, const string& actionName) {
     try {
         player->startTurn();
         action();
@@ -165,23 +176,22 @@ int main() {
 
         // Create players with ALL different roles
         cout << "\n📝 Creating players with different roles..." << endl;
-        Governor alice(game, "Alice");
-        Judge bob(game, "Bob");
-        General charlie(game, "Charlie");
-        Baron diana(game, "Diana");
-        Merchant eve(game, "Eve");
-        Spy frank(game, "Frank");
-
-        vector<Player*> allPlayers = {&alice, &bob, &charlie, &diana, &eve, &frank};
-
-        // Set up automated callbacks for all players
+        Game::PlayerList table = game.setup(
+            {"Alice", "Bob", "Charlie", "Diana", "Eve", "Frank"},
+            {Role::Governor, Role::Judge, Role::General, Role::Baron, Role::Merchant, Role::Spy});
+        Player& alice = *table[0];
+        Player& bob = *table[1];
+        Player& charlie = *table[2];
+        Player& diana = *table[3];
+        Player& eve = *table[4];
+        Player& frank = *table[5];
+
+        vector<Player*> allPlayers(table.begin(), table.end());
+
+        // Set up one shared automated policy for all players
+        StaticPolicy<AutomatedDecisions> automatedPolicy;
         for (Player* player : allPlayers) {
-            player->setBribeDecisionCallback([](const Player& p) -> bool {
-                return automatedBribeDecision(p);
-            });
-            player->setBlockDecisionCallback([](const Player& blocker, ActionType action, const Player* actor) -> bool {
-                return automatedBlockDecision(blocker, action, actor);
-            });
+            player->setDecisionPolicy(&automatedPolicy);
         }
 
         // Give starting coins